@@ -0,0 +1,103 @@
+/*******************************************************************************************
+*
+*   binning - Frame time of the triangle rasterizer, immediate or binned
+*
+*   Draws frames of random shaded and textured triangles with depth testing and prints
+*   the mean time of a frame. Built once without PF_SUPPORT_BINNED_RASTER and once per
+*   PF_BIN_WORKER_COUNT to compare the immediate path with the binned one and see how
+*   the latter scales with the worker threads.
+*
+********************************************************************************************/
+
+#include "pixelforge.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SCREEN_WIDTH        640
+#define SCREEN_HEIGHT       480
+
+#define FRAME_COUNT         20
+#define TRIANGLE_COUNT      20000       // Triangles drawn in each frame
+#define TRIANGLE_SIZE       64          // Maximum width and height of a triangle, in pixels
+
+#if defined(PF_SUPPORT_BINNED_RASTER)
+    #define STR(x) #x
+    #define XSTR(x) STR(x)
+    #define MODE "binned, " XSTR(PF_BIN_WORKER_COUNT) " workers"
+#else
+    #define MODE "immediate"
+#endif
+
+static double GetTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static void DrawFrame(PFtexture *texture)
+{
+    pfClear(PF_COLOR_BUFFER_BIT | PF_DEPTH_BUFFER_BIT);
+
+    srand(1);
+
+    for (int i = 0; i < TRIANGLE_COUNT; i++)
+    {
+        // Every other batch of triangles is textured
+        if (i%1000 == 0) pfBindTexture(((i/1000)%2) ? texture : NULL);
+
+        float x = rand()%SCREEN_WIDTH, y = rand()%SCREEN_HEIGHT;
+        float z = -(float)(rand()%1000)/1000.0f;
+
+        pfBegin(PF_TRIANGLES);
+            pfColor4ub(rand()%256, rand()%256, rand()%256, 255);
+            pfTexCoord2f(0, 0); pfVertex3f(x, y, z);
+            pfColor4ub(rand()%256, rand()%256, rand()%256, 255);
+            pfTexCoord2f(1, 0); pfVertex3f(x + rand()%TRIANGLE_SIZE, y + rand()%TRIANGLE_SIZE, z);
+            pfColor4ub(rand()%256, rand()%256, rand()%256, 255);
+            pfTexCoord2f(0, 1); pfVertex3f(x - rand()%TRIANGLE_SIZE, y + rand()%TRIANGLE_SIZE, z);
+        pfEnd();
+    }
+
+    pfFlush();
+}
+
+int main(void)
+{
+    static unsigned char screen[SCREEN_WIDTH*SCREEN_HEIGHT*4];
+
+    PFcontext ctx = pfCreateContext(screen, SCREEN_WIDTH, SCREEN_HEIGHT, PF_PIXELFORMAT_R8G8B8A8);
+    pfMakeCurrent(ctx);
+
+    pfMatrixMode(PF_PROJECTION);
+    pfLoadIdentity();
+    pfOrtho(0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 1);
+    pfMatrixMode(PF_MODELVIEW);
+    pfLoadIdentity();
+
+    pfEnable(PF_DEPTH_TEST);
+    pfEnable(PF_TEXTURE_2D);
+
+    PFtexture texture = pfGenTextureBuffer(64, 64, PF_PIXELFORMAT_R8G8B8A8);
+    for (int y = 0; y < 64; y++)
+    {
+        for (int x = 0; x < 64; x++) pfSetTexturePixel(&texture, x, y, ((x/8 + y/8)%2) ? (PFcolor){ 255, 255, 255, 255 } : (PFcolor){ 64, 64, 64, 255 });
+    }
+
+    DrawFrame(&texture);    // Warm up, the bins and the caches are filled
+
+    double start = GetTime();
+    for (int i = 0; i < FRAME_COUNT; i++) DrawFrame(&texture);
+    double elapsed = GetTime() - start;
+
+    printf("binning (%s): %.2f ms/frame\n", MODE, elapsed*1000.0/FRAME_COUNT);
+
+    pfBindTexture(NULL);
+    pfDeleteTexture(&texture);
+    pfDeleteContext(ctx);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*******************************************************************************************
+*
+*   fillrate - Fill rate of the barycentric rasterizer through raylib
+*
+*   Draws frames of fullscreen smooth shaded and textured rectangles on the headless
+*   platform and prints the mean time of a frame and the number of pixels filled per
+*   second. Built once with PF_NO_SIMD and once per instruction set of the block kernel
+*   (see 'internal/simd.h') to compare the scalar loop with the SIMD one.
+*
+********************************************************************************************/
+
+#include "raylib.h"
+
+#include <stdio.h>
+
+#define SCREEN_WIDTH        640
+#define SCREEN_HEIGHT       480
+
+#define FRAME_COUNT         100
+#define SMOOTH_COUNT        4           // Fullscreen smooth shaded rectangles drawn in each frame
+#define TEXTURED_COUNT      4           // Fullscreen textured rectangles drawn in each frame
+
+#if defined(PF_NO_SIMD)
+    #define MODE "scalar"
+#elif defined(__AVX2__)
+    #define MODE "AVX2"
+#elif defined(__SSE2__)
+    #define MODE "SSE2"
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #define MODE "NEON"
+#else
+    #define MODE "scalar"
+#endif
+
+static void DrawFrame(Texture2D texture)
+{
+    const Rectangle screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+    BeginDrawing();
+        ClearBackground(BLACK);
+
+        for (int i = 0; i < SMOOTH_COUNT; i++)
+        {
+            DrawRectangleGradientEx(screen, RED, GREEN, BLUE, (i%2) ? WHITE : YELLOW);
+        }
+
+        for (int i = 0; i < TEXTURED_COUNT; i++)
+        {
+            DrawTexturePro(texture, (Rectangle){ 0, 0, texture.width, texture.height }, screen, (Vector2){ 0, 0 }, 0.0f, WHITE);
+        }
+    EndDrawing();
+}
+
+int main(void)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "fillrate");
+
+    Image checked = GenImageChecked(64, 64, 8, 8, LIGHTGRAY, DARKGRAY);
+    Texture2D texture = LoadTextureFromImage(checked);
+    UnloadImage(checked);
+
+    DrawFrame(texture);     // Warm up, the caches are filled
+
+    double start = GetTime();
+    for (int i = 0; i < FRAME_COUNT; i++) DrawFrame(texture);
+    double elapsed = GetTime() - start;
+
+    double pixels = (double)SCREEN_WIDTH*SCREEN_HEIGHT*(SMOOTH_COUNT + TEXTURED_COUNT)*FRAME_COUNT;
+
+    printf("fillrate (%s): %.2f ms/frame, %.1f Mpixels/s\n", MODE, elapsed*1000.0/FRAME_COUNT, pixels/elapsed*1e-6);
+
+    UnloadTexture(texture);
+    CloseWindow();
+
+    return 0;
+}
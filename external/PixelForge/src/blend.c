@@ -17,6 +17,7 @@
  *   3. This notice may not be removed or altered from any source distribution.
  */
 
+#include "internal/blend.h"
 #include "pixelforge.h"
 #include <limits.h>
 
@@ -32,17 +33,16 @@ PFcolor pfBlend(PFcolor source, PFcolor destination)
     return result;
 }
 
+// NOTE: The rasterizers use the kernels of 'internal/blend.h' directly when it is the current function
 PFcolor pfBlendAlpha(PFcolor source, PFcolor destination)
 {
-    PFuint alpha = source.a + 1;
-    PFuint invAlpha = 256 - alpha;
+    return Blend_Alpha(source, destination);
+}
 
-    PFcolor result;
-    result.r = (PFubyte)((alpha*source.r + invAlpha*destination.r) >> 8);
-    result.g = (PFubyte)((alpha*source.g + invAlpha*destination.g) >> 8);
-    result.b = (PFubyte)((alpha*source.b + invAlpha*destination.b) >> 8);
-    result.a = (PFubyte)((alpha*255 + invAlpha*destination.a) >> 8);
-    return result;
+// NOTE: Same as 'pfBlendAlpha' for colors whose channels are already multiplied by their alpha
+PFcolor pfBlendPremultiplied(PFcolor source, PFcolor destination)
+{
+    return Blend_Premultiplied(source, destination);
 }
 
 PFcolor pfBlendAdditive(PFcolor source, PFcolor destination)
@@ -24,8 +24,17 @@
 #include "internal/primitives/triangles/triangles.h"
 #include "internal/primitives/points/points.h"
 #include "internal/primitives/lines/lines.h"
+#include "internal/primitives/rects/rects.h"
+#include "internal/primitives/pixels/pixels.h"
+#include "internal/binning/binning.h"
+#include "internal/transform/transform.h"
+#include "internal/lighting/lighting.h"
 
 #include "internal/context.h"
+#include "internal/pixel.h"
+#include "internal/sampler.h"
+#include "internal/depth.h"
+#include "internal/damage.h"
 #include "internal/config.h"
 #include "pixelforge.h"
 #include "pfm.h"
@@ -36,6 +45,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <float.h>
+#include <math.h>
 
 // TODO: Review all enums to give them unique values
 
@@ -52,13 +62,100 @@ typedef void (*RasterizeTriangleLightFunc)(PFface, const PFvertex*, const PFvert
 
 extern void pfInternal_GetPixelGetterSetter(PFpixelgetter* getter, PFpixelsetter* setter, PFpixelformat format);
 extern PFsizei pfInternal_GetPixelBytes(PFpixelformat format);
+extern PFboolean pfInternal_FillPixels(PFtexture* texture, PFsizei size, PFcolor color);
+extern PFsizei pfInternal_GetTextureBytes(const PFtexture* texture);
 
 /* Internal processing and rasterization function declarations */
 
-static void ProcessRasterize(void);
+static void ProcessRasterize(PFboolean transformed);
+static void ProcessRasterize_LineWith(PFlinefunc rasterizeLine);
 
 /* Some helper functions */
 
+// NOTE: Rasterizes the triangles deferred by the binned rasterizer, must be called
+//       before changing any state read by 'Rasterize_Triangle' (including the
+//       textures and framebuffers they use) and before any direct access to the
+//       pixels of the current framebuffer. Also used by 'texture.c' and 'framebuffer.c'.
+void pfInternal_FlushBins(void)
+{
+#ifdef PF_SUPPORT_BINNED_RASTER
+    if (currentCtx && currentCtx->binner) Binning_Flush(currentCtx->binner);
+#endif //PF_SUPPORT_BINNED_RASTER
+}
+
+// NOTE: Adds inclusive screen space bounds to the damage region, only if the current
+//       framebuffer is the main one. The bounds are clipped to the framebuffer here.
+static void pfInternal_Damage(PFint xMin, PFint yMin, PFint xMax, PFint yMax)
+{
+    const PFframebuffer *framebuffer = currentCtx->currentFramebuffer;
+    if (framebuffer != &currentCtx->mainFramebuffer) return;
+
+    xMin = MAX(xMin, 0), yMin = MAX(yMin, 0);
+    xMax = MIN(xMax, (PFint)framebuffer->texture.width - 1);
+    yMax = MIN(yMax, (PFint)framebuffer->texture.height - 1);
+
+    Damage_AddRect(&currentCtx->damage, xMin, yMin, xMax, yMax);
+    Damage_AddRect(&currentCtx->clearHistory.drawn, xMin, yMin, xMax, yMax);
+}
+
+// NOTE: Damages the bounds of projected vertices, extended by 'margin' pixels
+//       (half the point size or the line width) plus one for the rounding
+static void pfInternal_DamageVertices(const PFvertex* vertices, int_fast8_t count, PFfloat margin)
+{
+    const PFframebuffer *framebuffer = currentCtx->currentFramebuffer;
+    if (framebuffer != &currentCtx->mainFramebuffer) return;
+
+    PFfloat xMin = vertices[0].screen[0], xMax = xMin;
+    PFfloat yMin = vertices[0].screen[1], yMax = yMin;
+
+    for (int_fast8_t i = 1; i < count; i++)
+    {
+        xMin = MIN(xMin, vertices[i].screen[0]), xMax = MAX(xMax, vertices[i].screen[0]);
+        yMin = MIN(yMin, vertices[i].screen[1]), yMax = MAX(yMax, vertices[i].screen[1]);
+    }
+
+    // Clamp before the conversion, the clipped vertices can still be slightly off-screen
+    const PFfloat w = (PFfloat)framebuffer->texture.width;
+    const PFfloat h = (PFfloat)framebuffer->texture.height;
+
+    pfInternal_Damage(
+        (PFint)floorf(CLAMP(xMin - margin, -1.0f, w)) - 1,
+        (PFint)floorf(CLAMP(yMin - margin, -1.0f, h)) - 1,
+        (PFint)ceilf(CLAMP(xMax + margin, -1.0f, w)) + 1,
+        (PFint)ceilf(CLAMP(yMax + margin, -1.0f, h)) + 1);
+}
+
+// NOTE: After a color clear the framebuffer only holds 'color', so it differs from the presented
+//       frame only where that one was drawn over a clear of the same color, whatever came before
+static void pfInternal_DamageClear(PFcolor color)
+{
+    if (currentCtx->currentFramebuffer != &currentCtx->mainFramebuffer) return;
+
+    const PFclearhistory *presented = &currentCtx->presentedClearHistory;
+
+    if (presented->valid && presented->color.r == color.r && presented->color.g == color.g
+        && presented->color.b == color.b && presented->color.a == color.a)
+    {
+        currentCtx->damage = presented->drawn;
+    }
+    else
+    {
+        Damage_SetAll(&currentCtx->damage, &currentCtx->mainFramebuffer);
+    }
+
+    Damage_Reset(&currentCtx->clearHistory.drawn);
+
+    currentCtx->clearHistory.color = color;
+    currentCtx->clearHistory.valid = PF_TRUE;
+}
+
+// NOTE: For the operations rewriting the whole main framebuffer with arbitrary content
+static void pfInternal_DamageAll(void)
+{
+    Damage_SetAll(&currentCtx->damage, &currentCtx->mainFramebuffer);
+    currentCtx->clearHistory.valid = PF_FALSE;
+}
+
 static void pfInternal_ResetVertexBufferForNextElement()
 {
     switch (currentCtx->currentDrawMode)
@@ -141,6 +238,23 @@ static void pfInternal_UpdateMatrices(PFboolean matNormal)
     }
 }
 
+// NOTE: Does the per-vertex work of 'Process_ProjectAndClipTriangle' (and of the normal
+//       transformation when lighting) once, so the vertex can be reused by several triangles
+static void pfInternal_TransformVertex(PFvertex* v, PFboolean lighting)
+{
+    memcpy(v->homogeneous, v->position, sizeof(PFMvec4));
+    pfmVec4Transform(v->homogeneous, v->homogeneous, currentCtx->matMVP);
+
+    v->clipCode = Transform_ClassifyVertex(v->homogeneous[0],
+        v->homogeneous[1], v->homogeneous[2], v->homogeneous[3]);
+
+    if (lighting)
+    {
+        pfmVec3Transform(v->normal, v->normal, currentCtx->matNormal);
+        pfmVec3Normalize(v->normal, v->normal); // REVIEW: Only with PF_NORMALIZE state??
+    }
+}
+
 /* Context API functions */
 
 PFcontext pfCreateContext(void* targetBuffer, PFsizei width, PFsizei height, PFpixelformat pixelFormat)
@@ -152,25 +266,34 @@ PFcontext pfCreateContext(void* targetBuffer, PFsizei width, PFsizei height, PFp
 
     /* Initialization of the main framebuffer */
 
-    PFframebuffer fb0 = {0,0};
+    PFframebuffer fb0 = {0,0,0};
     ctx->mainFramebuffer = fb0;
     ctx->mainFramebuffer.texture = pfGenTexture(targetBuffer, width, height, pixelFormat);
 
     const PFsizei bufferSize = width*height;
     ctx->mainFramebuffer.zbuffer = (PFfloat*)PF_MALLOC(bufferSize * sizeof(PFfloat));
+    ctx->mainFramebuffer.zbufferMax = (PFfloat*)PF_MALLOC(Depth_TileCount(width, height) * sizeof(PFfloat));
+    ctx->mainFramebuffer.zbufferPending = (PFubyte*)PF_MALLOC(Depth_TileCount(width, height));
 
-    if (!ctx->mainFramebuffer.zbuffer)
+    if (!ctx->mainFramebuffer.zbuffer || !ctx->mainFramebuffer.zbufferMax || !ctx->mainFramebuffer.zbufferPending)
     {
+        PF_FREE(ctx->mainFramebuffer.zbuffer);
+        PF_FREE(ctx->mainFramebuffer.zbufferMax);
+        PF_FREE(ctx->mainFramebuffer.zbufferPending);
         PF_FREE(ctx);
         return NULL;
     }
 
     /* Initialization of the z-buffer with maximum values */
 
-    for (PFsizei i = 0; i < bufferSize; i++)
-    {
-        ctx->mainFramebuffer.zbuffer[i] = FLT_MAX;
-    }
+    Depth_Clear(&ctx->mainFramebuffer, FLT_MAX);
+
+    /* The whole buffer has to be presented once */
+
+    Damage_SetAll(&ctx->damage, &ctx->mainFramebuffer);
+    Damage_SetAll(&ctx->presentedDamage, &ctx->mainFramebuffer);
+    ctx->clearHistory.valid = PF_FALSE;
+    ctx->presentedClearHistory.valid = PF_FALSE;
 
     /* Definition of the current framebuffer */
 
@@ -221,10 +344,15 @@ PFcontext pfCreateContext(void* targetBuffer, PFsizei width, PFsizei height, PFp
         ctx->lights[i].ambient = (PFcolor) { 51, 51, 51, 255 },
         ctx->lights[i].diffuse = (PFcolor) { 255, 255, 255, 255 },
         ctx->lights[i].specular = (PFcolor) { 255, 255, 255, 255 },
+        ctx->lights[i].directional = PF_FALSE,
         ctx->lights[i].next = NULL;
     }
     ctx->activeLights = NULL;
 
+    // NOTE: The specular tables are built by the first 'Lighting_Setup'
+    ctx->lighting.count = 0;
+    ctx->lighting.shininess[0] = ctx->lighting.shininess[1] = -1.0f;
+
     /* Initialization of fog properties */
 
     ctx->fog.mode = PF_LINEAR,
@@ -280,10 +408,19 @@ PFcontext pfCreateContext(void* targetBuffer, PFsizei width, PFsizei height, PFp
 
     ctx->state = 0x00;
     ctx->state |= PF_CULL_FACE;
+#ifdef PF_GOURAUD_SHADING
+    ctx->state |= PF_VERTEX_LIGHTING;
+#endif //PF_GOURAUD_SHADING
     ctx->shadingMode = PF_SMOOTH;
     ctx->cullFace = PF_BACK;
     ctx->errCode = PF_NO_ERROR;
 
+    /* Initialization of the binned rasterizer (immediate rasterization is used if it fails) */
+
+#ifdef PF_SUPPORT_BINNED_RASTER
+    ctx->binner = Binning_Create(ctx);
+#endif //PF_SUPPORT_BINNED_RASTER
+
     return ctx;
 }
 
@@ -291,10 +428,20 @@ void pfDeleteContext(PFcontext ctx)
 {
     if (ctx)
     {
+#ifdef PF_SUPPORT_BINNED_RASTER
+        if (((PFctx*)ctx)->binner)
+        {
+            Binning_Flush(((PFctx*)ctx)->binner);
+            Binning_Delete(((PFctx*)ctx)->binner);
+        }
+#endif //PF_SUPPORT_BINNED_RASTER
+
         if (((PFctx*)ctx)->mainFramebuffer.zbuffer)
         {
             PF_FREE(((PFctx*)ctx)->mainFramebuffer.zbuffer);
-            PFframebuffer fb0 = {0,0};
+            PF_FREE(((PFctx*)ctx)->mainFramebuffer.zbufferMax);
+            PF_FREE(((PFctx*)ctx)->mainFramebuffer.zbufferPending);
+            PFframebuffer fb0 = {0,0,0};
             ((PFctx*)ctx)->mainFramebuffer = fb0;
         }
 
@@ -312,6 +459,8 @@ void pfSetMainBuffer(void* targetBuffer, PFsizei width, PFsizei height, PFpixelf
         return;
     }
 
+    pfInternal_FlushBins();
+
     /* Store the old width and height of the main framebuffer */
 
     PFsizei oldWidth = currentCtx->mainFramebuffer.texture.width;
@@ -324,8 +473,11 @@ void pfSetMainBuffer(void* targetBuffer, PFsizei width, PFsizei height, PFpixelf
         // Calculate the new buffer size
         const PFsizei bufferSize = width*height;
 
+        // Write the depths of the blocks still pending from the last clear
+        Depth_ResolveAll(&currentCtx->mainFramebuffer);
+
         // Reallocate memory for the z-buffer
-        PFfloat *zbuffer = (PFfloat*)PF_REALLOC(currentCtx->mainFramebuffer.zbuffer, bufferSize);
+        PFfloat *zbuffer = (PFfloat*)PF_REALLOC(currentCtx->mainFramebuffer.zbuffer, bufferSize*sizeof(PFfloat));
 
         // Check if reallocation failed
         if (zbuffer == NULL)
@@ -361,12 +513,36 @@ void pfSetMainBuffer(void* targetBuffer, PFsizei width, PFsizei height, PFpixelf
 
         // Update the z-buffer pointer
         currentCtx->mainFramebuffer.zbuffer = zbuffer;
+
+        // Reallocate the coarse depth buffer (it is only disabled if that fails)
+        PFfloat *zbufferMax = (PFfloat*)PF_REALLOC(currentCtx->mainFramebuffer.zbufferMax,
+            Depth_TileCount(width, height)*sizeof(PFfloat));
+
+        if (zbufferMax == NULL)
+        {
+            PF_FREE(currentCtx->mainFramebuffer.zbufferMax);
+        }
+
+        currentCtx->mainFramebuffer.zbufferMax = zbufferMax;
+
+        // Reallocate the pending flags, none of the new blocks is pending
+        PF_FREE(currentCtx->mainFramebuffer.zbufferPending);
+        currentCtx->mainFramebuffer.zbufferPending = (PFubyte*)PF_CALLOC(Depth_TileCount(width, height), 1);
     }
 
     /* Generate the new texture for the main framebuffer */
 
     currentCtx->mainFramebuffer.texture = pfGenTexture(targetBuffer, width, height, pixelFormat);
 
+    // NOTE: The blocks of the coarse depth buffer no longer match the z-buffer after a resize
+    if (oldWidth != width || oldHeight != height)
+    {
+        Depth_FillTiles(&currentCtx->mainFramebuffer, PF_DEPTH_UNBOUNDED);
+    }
+
+    // NOTE: The rectangles must be bounded by the new dimensions, whatever the content is
+    pfInternal_DamageAll();
+
     /* Reset the auxiliary framebuffer, it needs to be redefined after changing the main buffer */
 
     currentCtx->auxFramebuffer = NULL;
@@ -376,6 +552,9 @@ void pfSetMainBuffer(void* targetBuffer, PFsizei width, PFsizei height, PFpixelf
 PF_API void pfSetAuxBuffer(void *auxFramebuffer)
 {
     currentCtx->auxFramebuffer = auxFramebuffer;
+
+    // NOTE: Nothing is known about the content of the new buffer
+    Damage_SetAll(&currentCtx->presentedDamage, &currentCtx->mainFramebuffer);
 }
 
 PF_API void pfSwapBuffers(void)
@@ -386,9 +565,19 @@ PF_API void pfSwapBuffers(void)
         return;
     }
 
+    pfInternal_FlushBins();
+
     void *tmp = currentCtx->currentFramebuffer->texture.pixels;
     currentCtx->currentFramebuffer->texture.pixels = currentCtx->auxFramebuffer;
     currentCtx->auxFramebuffer = tmp;
+
+    // NOTE: The buffer we now render into holds the frame before the last presented one,
+    //       so it also lacks what was damaged for the last presentation
+    if (currentCtx->currentFramebuffer == &currentCtx->mainFramebuffer)
+    {
+        Damage_AddRegion(&currentCtx->damage, &currentCtx->presentedDamage);
+        currentCtx->clearHistory.valid = PF_FALSE;
+    }
 }
 
 PFcontext pfGetCurrentContext(void)
@@ -398,6 +587,11 @@ PFcontext pfGetCurrentContext(void)
 
 void pfMakeCurrent(PFcontext ctx)
 {
+    if (currentCtx && currentCtx != ctx)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx = ctx;
 }
 
@@ -408,6 +602,11 @@ PFboolean pfIsEnabled(PFstate state)
 
 void pfEnable(PFstate state)
 {
+    if ((currentCtx->state & state) != state)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx->state |= state;
 
     if (state & PF_FRAMEBUFFER)
@@ -419,6 +618,11 @@ void pfEnable(PFstate state)
 
 void pfDisable(PFstate state)
 {
+    if (currentCtx->state & state)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx->state &= ~state;
 
     if (state & PF_FRAMEBUFFER)
@@ -427,6 +631,24 @@ void pfDisable(PFstate state)
     }
 }
 
+void pfFlush(void)
+{
+    pfInternal_FlushBins();
+}
+
+PFsizei pfGetDamage(const PFrect** rects)
+{
+    *rects = currentCtx->damage.rects;
+    return currentCtx->damage.count;
+}
+
+void pfResetDamage(void)
+{
+    currentCtx->presentedDamage = currentCtx->damage;
+    currentCtx->presentedClearHistory = currentCtx->clearHistory;
+    Damage_Reset(&currentCtx->damage);
+}
+
 
 /* Getter API functions (see also 'getter.c') */
 
@@ -641,6 +863,8 @@ void pfViewport(PFint x, PFint y, PFsizei width, PFsizei height)
         return;
     }
 
+    pfInternal_FlushBins();
+
     currentCtx->vpPos[0] = x;
     currentCtx->vpPos[1] = y;
 
@@ -656,11 +880,13 @@ void pfViewport(PFint x, PFint y, PFsizei width, PFsizei height)
 
 void pfSetDefaultPixelGetter(PFpixelgetter func)
 {
+    pfInternal_FlushBins();
     currentCtx->mainFramebuffer.texture.pixelGetter = func;
 }
 
 void pfSetDefaultPixelSetter(PFpixelsetter func)
 {
+    pfInternal_FlushBins();
     currentCtx->mainFramebuffer.texture.pixelSetter = func;
 }
 
@@ -695,6 +921,11 @@ void pfPolygonMode(PFface face, PFpolygonmode mode)
 
 void pfShadeModel(PFshademode mode)
 {
+    if (currentCtx->shadingMode != mode)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx->shadingMode = mode;
 }
 
@@ -728,16 +959,28 @@ void pfCullFace(PFface face)
 
 void pfBlendFunc(PFblendfunc func)
 {
+    if (currentCtx->blendFunction != func)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx->blendFunction = func;
 }
 
 void pfDepthFunc(PFdepthfunc func)
 {
+    if (currentCtx->depthFunction != func)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx->depthFunction = func;
 }
 
 void pfBindFramebuffer(PFframebuffer* framebuffer)
 {
+    pfInternal_FlushBins();
+
     currentCtx->bindedFramebuffer = framebuffer;
 
     if (currentCtx->state & PF_FRAMEBUFFER)
@@ -749,6 +992,11 @@ void pfBindFramebuffer(PFframebuffer* framebuffer)
 
 void pfBindTexture(PFtexture* texture)
 {
+    if (currentCtx->currentTexture != texture)
+    {
+        pfInternal_FlushBins();
+    }
+
     currentCtx->currentTexture = texture;
 }
 
@@ -756,54 +1004,56 @@ void pfClear(PFclearflag flag)
 {
     if (!flag) return;
 
+    pfInternal_FlushBins();
+
     PFframebuffer *framebuffer = currentCtx->currentFramebuffer;
     PFsizei size = framebuffer->texture.width*framebuffer->texture.height;
 
     if (flag & (PF_COLOR_BUFFER_BIT | PF_DEPTH_BUFFER_BIT))
     {
         PFtexture *texture = &framebuffer->texture;
-        PFfloat *zbuffer = framebuffer->zbuffer;
-
-        PFpixelsetter pixelSetter = texture->pixelSetter;
         PFcolor color = currentCtx->clearColor;
-        PFfloat depth = currentCtx->clearDepth;
 
-#       ifdef PF_SUPPORT_OPENMP
-#           pragma omp parallel for if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
-#       endif //PF_SUPPORT_OPENMP
-        for (PFsizei i = 0; i < size; i++)
+        pfInternal_DamageClear(color);
+
+        if (!pfInternal_FillPixels(texture, size, color))
         {
-            pixelSetter(texture->pixels, i, color);
-            zbuffer[i] = depth;
+            PFpixelsetter pixelSetter = texture->pixelSetter;
+
+#           ifdef PF_SUPPORT_OPENMP
+#               pragma omp parallel for if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#           endif //PF_SUPPORT_OPENMP
+            for (PFsizei i = 0; i < size; i++)
+            {
+                pixelSetter(texture->pixels, i, color);
+            }
         }
+
+        Depth_Clear(framebuffer, currentCtx->clearDepth);
     }
     else if (flag & PF_COLOR_BUFFER_BIT)
     {
         PFtexture *texture = &framebuffer->texture;
-
-        PFpixelsetter pixelSetter = texture->pixelSetter;
         PFcolor color = currentCtx->clearColor;
 
-#       ifdef PF_SUPPORT_OPENMP
-#           pragma omp parallel for if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
-#       endif //PF_SUPPORT_OPENMP
-        for (PFsizei i = 0; i < size; i++)
+        pfInternal_DamageClear(color);
+
+        if (!pfInternal_FillPixels(texture, size, color))
         {
-            pixelSetter(texture->pixels, i, color);
+            PFpixelsetter pixelSetter = texture->pixelSetter;
+
+#           ifdef PF_SUPPORT_OPENMP
+#               pragma omp parallel for if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#           endif //PF_SUPPORT_OPENMP
+            for (PFsizei i = 0; i < size; i++)
+            {
+                pixelSetter(texture->pixels, i, color);
+            }
         }
     }
     else if (flag & PF_DEPTH_BUFFER_BIT)
     {
-        PFfloat *zbuffer = framebuffer->zbuffer;
-        PFfloat depth = currentCtx->clearDepth;
-
-#       ifdef PF_SUPPORT_OPENMP
-#           pragma omp parallel for if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
-#       endif //PF_SUPPORT_OPENMP
-        for (PFsizei i = 0; i < size; i++)
-        {
-            zbuffer[i] = depth;
-        }
+        Depth_Clear(framebuffer, currentCtx->clearDepth);
     }
 }
 
@@ -833,6 +1083,8 @@ void pfEnableLight(PFsizei light)
         return;
     }
 
+    pfInternal_FlushBins();
+
     PFlight *desiredLight = currentCtx->lights + light;     // Get the pointer to the desired light from the lights array.
     PFlight **nodeLight = &currentCtx->activeLights;        // Get a pointer to the pointer pointing to the head of the active lights list.
 
@@ -867,6 +1119,8 @@ void pfDisableLight(PFsizei light)
         return;
     }
 
+    pfInternal_FlushBins();
+
     PFlight *desiredLight = currentCtx->lights + light;     // Get the pointer to the desired light from the lights array.
     PFlight **nodeLight = &currentCtx->activeLights;        // Get a pointer to the pointer pointing to the head of the active lights list.
 
@@ -911,6 +1165,8 @@ void pfLightf(PFsizei light, PFenum param, PFfloat value)
         return;
     }
 
+    pfInternal_FlushBins();
+
     PFlight *l = &currentCtx->lights[light];
 
     switch (param)
@@ -964,18 +1220,26 @@ void pfLightfv(PFsizei light, PFenum param, const void* value)
         return;
     }
 
+    pfInternal_FlushBins();
+
     PFlight *l = &currentCtx->lights[light];
 
     switch (param)
     {
         case PF_POSITION:
             memcpy(l->position, value, sizeof(PFMvec3));
+            l->directional = PF_FALSE;
             break;
 
         case PF_SPOT_DIRECTION:
             memcpy(l->direction, value, sizeof(PFMvec3));
             break;
 
+        case PF_DIRECTION:
+            memcpy(l->direction, value, sizeof(PFMvec3));
+            l->directional = PF_TRUE;
+            break;
+
         case PF_SPOT_INNER_CUTOFF:
         {
             PFfloat v = *(PFfloat*)value;
@@ -1055,6 +1319,8 @@ void pfMaterialf(PFface face, PFenum param, PFfloat value)
     PFmaterial *material0 = NULL;
     PFmaterial *material1 = NULL;
 
+    pfInternal_FlushBins();
+
     switch (face)
     {
         case PF_FRONT:
@@ -1145,6 +1411,8 @@ void pfMaterialfv(PFface face, PFenum param, const void *value)
     PFmaterial *material0 = NULL;
     PFmaterial *material1 = NULL;
 
+    pfInternal_FlushBins();
+
     switch (face)
     {
         case PF_FRONT:
@@ -1354,19 +1622,39 @@ void pfDrawElements(PFdrawmode mode, PFsizei count, PFdatatype type, const void*
     PFsizei indicesTypeSize = pfInternal_GetDataTypeSize(type);
     PFsizei drawModeVertexCount = pfInternal_GetDrawModeVertexCount(mode);
 
+    PFboolean transform = !(mode == PF_POINTS || mode == PF_LINES);
+    PFboolean lighting = (currentCtx->state & PF_LIGHTING) && (currentCtx->activeLights != NULL);
+
+    PFvertex v0 = {0,0,0,0};
+    v0.color = currentCtx->currentColor;
+
     for (PFsizei i = 0; i < drawModeVertexCount; i++)
     {
-        PFvertex v0 = {0,0,0,0};
         currentCtx->vertexBuffer[i] = v0;
-        currentCtx->vertexBuffer[i].color = currentCtx->currentColor;
+    }
+
+    // Post-transform vertex cache, direct-mapped on the vertex index
+    // NOTE: A vertex shared by several triangles is only fetched and transformed
+    //       again if its slot has been taken by another index in the meantime.
+
+    PFvertex cache[PF_VERTEX_CACHE_SIZE];
+    PFuint cacheIndices[PF_VERTEX_CACHE_SIZE];
+    memset(cacheIndices, 0xFF, sizeof(cacheIndices));
+
+    // NOTE: The lines are rasterized directly, so the bins are flushed and the
+    //       rasterizer is selected once for the whole array instead of for each line
+    PFlinefunc rasterizeLine = NULL;
+
+    if (mode == PF_LINES)
+    {
+        pfInternal_FlushBins();
+        rasterizeLine = Rasterize_GetLineFunc();
     }
 
     pfBegin(mode);
 
     for (PFsizei i = 0; i < count; i++)
     {
-        PFvertex *vertex = currentCtx->vertexBuffer + (currentCtx->vertexCounter++);
-
         // Get vertex index
 
         const void *p = (const PFubyte*)indices + i*indicesTypeSize;
@@ -1380,73 +1668,55 @@ void pfDrawElements(PFdrawmode mode, PFsizei count, PFdatatype type, const void*
             default: break;
         }
 
-        // Fill the vertex with given vertices data
+        // Lookup the vertex in the cache
 
-        memset(&vertex->position, 0, sizeof(PFMvec3));
-        vertex->position[3] = 1.0f;
+        PFsizei slot = j & (PF_VERTEX_CACHE_SIZE - 1);
+        PFvertex *vertex = cache + slot;
 
-        switch (positions->type)
+        if (cacheIndices[slot] != j)
         {
-            case PF_SHORT:
-            {
-                for (int_fast8_t k = 0; k < positions->size; k++)
-                {
-                    vertex->position[k] = ((const PFshort*)positions->buffer)[j*positions->size + k];
-                }
-            }
-            break;
+            cacheIndices[slot] = j;
+            *vertex = v0;
 
-            case PF_INT:
-            {
-                for (int_fast8_t k = 0; k < positions->size; k++)
-                {
-                    vertex->position[k] = ((const PFint*)positions->buffer)[j*positions->size + k];
-                }
-            }
-            break;
+            // Fill the vertex with given vertices data
+
+            memset(&vertex->position, 0, sizeof(PFMvec3));
+            vertex->position[3] = 1.0f;
 
-            case PF_FLOAT:
+            switch (positions->type)
             {
-                for (int_fast8_t k = 0; k < positions->size; k++)
+                case PF_SHORT:
                 {
-                    vertex->position[k] = ((const PFfloat*)positions->buffer)[j*positions->size + k];
+                    for (int_fast8_t k = 0; k < positions->size; k++)
+                    {
+                        vertex->position[k] = ((const PFshort*)positions->buffer)[j*positions->size + k];
+                    }
                 }
-            }
-            break;
+                break;
 
-            case PF_DOUBLE:
-            {
-                for (int_fast8_t k = 0; k < positions->size; k++)
+                case PF_INT:
                 {
-                    vertex->position[k] = ((const PFdouble*)positions->buffer)[j*positions->size + k];
+                    for (int_fast8_t k = 0; k < positions->size; k++)
+                    {
+                        vertex->position[k] = ((const PFint*)positions->buffer)[j*positions->size + k];
+                    }
                 }
-            }
-            break;
-
-            default:
                 break;
-        }
 
-        if (useNormalArray)
-        {
-            memset(&vertex->normal, 0, sizeof(PFMvec3));
-
-            switch (normals->type)
-            {
                 case PF_FLOAT:
                 {
-                    for (int_fast8_t k = 0; k < 3; k++)
+                    for (int_fast8_t k = 0; k < positions->size; k++)
                     {
-                        vertex->normal[k] = ((const PFfloat*)normals->buffer)[j*3 + k];
+                        vertex->position[k] = ((const PFfloat*)positions->buffer)[j*positions->size + k];
                     }
                 }
                 break;
 
                 case PF_DOUBLE:
                 {
-                    for (int_fast8_t k = 0; k < 3; k++)
+                    for (int_fast8_t k = 0; k < positions->size; k++)
                     {
-                        vertex->normal[k] = ((const PFdouble*)normals->buffer)[j*3 + k];
+                        vertex->position[k] = ((const PFdouble*)positions->buffer)[j*positions->size + k];
                     }
                 }
                 break;
@@ -1454,98 +1724,135 @@ void pfDrawElements(PFdrawmode mode, PFsizei count, PFdatatype type, const void*
                 default:
                     break;
             }
-        }
-
-        if (useTexCoordArray)
-        {
-            memset(&vertex->texcoord, 0, sizeof(PFMvec2));
 
-            switch (texcoords->type)
+            if (useNormalArray)
             {
-                case PF_FLOAT:
+                memset(&vertex->normal, 0, sizeof(PFMvec3));
+
+                switch (normals->type)
                 {
-                    for (int_fast8_t k = 0; k < 2; k++)
+                    case PF_FLOAT:
+                    {
+                        for (int_fast8_t k = 0; k < 3; k++)
+                        {
+                            vertex->normal[k] = ((const PFfloat*)normals->buffer)[j*3 + k];
+                        }
+                    }
+                    break;
+
+                    case PF_DOUBLE:
                     {
-                        vertex->texcoord[k] = ((const PFfloat*)texcoords->buffer)[j*2 + k];
+                        for (int_fast8_t k = 0; k < 3; k++)
+                        {
+                            vertex->normal[k] = ((const PFdouble*)normals->buffer)[j*3 + k];
+                        }
                     }
+                    break;
+
+                    default:
+                        break;
                 }
-                break;
+            }
 
-                case PF_DOUBLE:
+            if (useTexCoordArray)
+            {
+                memset(&vertex->texcoord, 0, sizeof(PFMvec2));
+
+                switch (texcoords->type)
                 {
-                    for (int_fast8_t k = 0; k < 2; k++)
+                    case PF_FLOAT:
                     {
-                        vertex->texcoord[k] = ((const PFdouble*)texcoords->buffer)[j*2 + k];
+                        for (int_fast8_t k = 0; k < 2; k++)
+                        {
+                            vertex->texcoord[k] = ((const PFfloat*)texcoords->buffer)[j*2 + k];
+                        }
                     }
-                }
-                break;
+                    break;
 
-                default:
+                    case PF_DOUBLE:
+                    {
+                        for (int_fast8_t k = 0; k < 2; k++)
+                        {
+                            vertex->texcoord[k] = ((const PFdouble*)texcoords->buffer)[j*2 + k];
+                        }
+                    }
                     break;
-            }
-        }
 
-        if (useColorArray)
-        {
-            memset(&vertex->color, 0xFF, sizeof(PFcolor));
+                    default:
+                        break;
+                }
+            }
 
-            switch (colors->type)
+            if (useColorArray)
             {
-                case PF_UNSIGNED_BYTE:
+                memset(&vertex->color, 0xFF, sizeof(PFcolor));
+
+                switch (colors->type)
                 {
-                    for (int_fast8_t k = 0; k < colors->size; k++)
+                    case PF_UNSIGNED_BYTE:
                     {
-                        ((PFubyte*)&vertex->color)[k] = ((const PFubyte*)colors->buffer)[j*colors->size + k];
+                        for (int_fast8_t k = 0; k < colors->size; k++)
+                        {
+                            ((PFubyte*)&vertex->color)[k] = ((const PFubyte*)colors->buffer)[j*colors->size + k];
+                        }
                     }
-                }
-                break;
+                    break;
 
-                case PF_UNSIGNED_SHORT:
-                {
-                    for (int_fast8_t k = 0; k < colors->size; k++)
+                    case PF_UNSIGNED_SHORT:
                     {
-                        ((PFubyte*)&vertex->color)[k] = ((const PFushort*)colors->buffer)[j*colors->size + k] >> 8;
+                        for (int_fast8_t k = 0; k < colors->size; k++)
+                        {
+                            ((PFubyte*)&vertex->color)[k] = ((const PFushort*)colors->buffer)[j*colors->size + k] >> 8;
+                        }
                     }
-                }
-                break;
+                    break;
 
-                case PF_UNSIGNED_INT:
-                {
-                    for (int_fast8_t k = 0; k < colors->size; k++)
+                    case PF_UNSIGNED_INT:
                     {
-                        ((PFubyte*)&vertex->color)[k] = ((const PFuint*)colors->buffer)[j*colors->size + k] >> 24;
+                        for (int_fast8_t k = 0; k < colors->size; k++)
+                        {
+                            ((PFubyte*)&vertex->color)[k] = ((const PFuint*)colors->buffer)[j*colors->size + k] >> 24;
+                        }
                     }
-                }
-                break;
+                    break;
 
-                case PF_FLOAT:
-                {
-                    for (int_fast8_t k = 0; k < colors->size; k++)
+                    case PF_FLOAT:
                     {
-                        ((PFubyte*)&vertex->color)[k] = ((const PFfloat*)colors->buffer)[j*colors->size + k] * 255;
+                        for (int_fast8_t k = 0; k < colors->size; k++)
+                        {
+                            ((PFubyte*)&vertex->color)[k] = ((const PFfloat*)colors->buffer)[j*colors->size + k] * 255;
+                        }
                     }
-                }
-                break;
+                    break;
 
-                case PF_DOUBLE:
-                {
-                    for (int_fast8_t k = 0; k < colors->size; k++)
+                    case PF_DOUBLE:
                     {
-                        ((PFubyte*)&vertex->color)[k] = ((const PFdouble*)colors->buffer)[j*colors->size + k] * 255;
+                        for (int_fast8_t k = 0; k < colors->size; k++)
+                        {
+                            ((PFubyte*)&vertex->color)[k] = ((const PFdouble*)colors->buffer)[j*colors->size + k] * 255;
+                        }
                     }
+                    break;
+
+                    default:
+                        break;
                 }
-                break;
+            }
 
-                default:
-                    break;
+            if (transform)
+            {
+                pfInternal_TransformVertex(vertex, lighting);
             }
         }
 
+        currentCtx->vertexBuffer[currentCtx->vertexCounter++] = *vertex;
+
         // If the number of vertices has reached that necessary for, we process the shape
 
         if (currentCtx->vertexCounter == drawModeVertexCount)
         {
-            ProcessRasterize();
+            if (rasterizeLine) ProcessRasterize_LineWith(rasterizeLine);
+            else ProcessRasterize(transform);
             pfInternal_ResetVertexBufferForNextElement();
         }
     }
@@ -1561,7 +1868,6 @@ void pfDrawArrays(PFdrawmode mode, PFint first, PFsizei count)
         return;
     }
 
-    const PFvertexattribbuffer *positions = &currentCtx->vertexAttribs.positions;
     const PFvertexattribbuffer *texcoords = &currentCtx->vertexAttribs.texcoords;
     const PFvertexattribbuffer *normals = &currentCtx->vertexAttribs.normals;
     const PFvertexattribbuffer *colors = &currentCtx->vertexAttribs.colors;
@@ -1579,92 +1885,63 @@ void pfDrawArrays(PFdrawmode mode, PFint first, PFsizei count)
         currentCtx->vertexBuffer[i].color = currentCtx->currentColor;
     }
 
+    // NOTE: The lines are rasterized directly, so the bins are flushed and the
+    //       rasterizer is selected once for the whole array instead of for each line
+    PFlinefunc rasterizeLine = NULL;
+
+    if (mode == PF_LINES)
+    {
+        pfInternal_FlushBins();
+        rasterizeLine = Rasterize_GetLineFunc();
+    }
+
+    PFboolean transform = !(mode == PF_POINTS || mode == PF_LINES);
+    PFboolean lighting = (currentCtx->state & PF_LIGHTING) && (currentCtx->activeLights != NULL);
+
+    PFvertexbatch *batch = &currentCtx->vertexBatch;
+
     pfBegin(mode);
 
     for (PFsizei i = 0; i < count; i++)
     {
-        PFvertex *vertex = currentCtx->vertexBuffer + (currentCtx->vertexCounter++);
-
-        // Fill the vertex with given vertices data
+        PFsizei k = i % PF_VERTEX_BATCH_SIZE;
 
-        memset(&vertex->position, 0, sizeof(PFMvec3));
-        vertex->position[3] = 1.0f;
+        // Fetch the positions and normals of the next vertices, and transform all of
+        // them at once for the primitives that would otherwise transform their copies
 
-        switch (positions->type)
+        if (k == 0)
         {
-            case PF_SHORT:
-            {
-                for (int_fast8_t j = 0; j < positions->size; j++)
-                {
-                    vertex->position[j] =
-                        ((const PFshort*)positions->buffer + first*positions->size)[i*positions->size + j];
-                }
-            }
-            break;
+            PFsizei batchCount = MIN(count - i, PF_VERTEX_BATCH_SIZE);
 
-            case PF_INT:
-            {
-                for (int_fast8_t j = 0; j < positions->size; j++)
-                {
-                    vertex->position[j] =
-                        ((const PFint*)positions->buffer + first*positions->size)[i*positions->size + j];
-                }
-            }
-            break;
+            Transform_FetchBatch(batch, &currentCtx->vertexAttribs, useNormalArray, first + i, batchCount);
 
-            case PF_FLOAT:
+            if (transform)
             {
-                for (int_fast8_t j = 0; j < positions->size; j++)
-                {
-                    vertex->position[j] =
-                        ((const PFfloat*)positions->buffer + first*positions->size)[i*positions->size + j];
-                }
+                Transform_ProcessBatch(batch, batchCount, currentCtx->matMVP,
+                    lighting ? currentCtx->matNormal : NULL);
             }
-            break;
+        }
 
-            case PF_DOUBLE:
-            {
-                for (int_fast8_t j = 0; j < positions->size; j++)
-                {
-                    vertex->position[j] =
-                        ((const PFdouble*)positions->buffer + first*positions->size)[i*positions->size + j];
-                }
-            }
-            break;
+        PFvertex *vertex = currentCtx->vertexBuffer + (currentCtx->vertexCounter++);
 
-            default:
-                break;
-        }
+        // Fill the vertex with given vertices data
 
-        if (useNormalArray)
-        {
-            memset(&vertex->normal, 0, sizeof(PFMvec3));
+        vertex->position[0] = batch->px[k];
+        vertex->position[1] = batch->py[k];
+        vertex->position[2] = batch->pz[k];
+        vertex->position[3] = batch->pw[k];
 
-            switch (normals->type)
-            {
-                case PF_FLOAT:
-                {
-                    for (int_fast8_t j = 0; j < 3; j++)
-                    {
-                        vertex->normal[j] =
-                            ((const PFfloat*)normals->buffer + first*3)[i*3 + j];
-                    }
-                }
-                break;
-
-                case PF_DOUBLE:
-                {
-                    for (int_fast8_t j = 0; j < 3; j++)
-                    {
-                        vertex->normal[j] =
-                            ((const PFdouble*)normals->buffer + first*3)[i*3 + j];
-                    }
-                }
-                break;
+        vertex->normal[0] = batch->nx[k];
+        vertex->normal[1] = batch->ny[k];
+        vertex->normal[2] = batch->nz[k];
 
-                default:
-                    break;
-            }
+        if (transform)
+        {
+            vertex->homogeneous[0] = batch->hx[k];
+            vertex->homogeneous[1] = batch->hy[k];
+            vertex->homogeneous[2] = batch->hz[k];
+            vertex->homogeneous[3] = batch->hw[k];
+            vertex->clipCode = batch->clipCodes[k];
         }
 
         if (useTexCoordArray)
@@ -1763,7 +2040,8 @@ void pfDrawArrays(PFdrawmode mode, PFint first, PFsizei count)
 
         if (currentCtx->vertexCounter == drawModeVertexCount)
         {
-            ProcessRasterize();
+            if (rasterizeLine) ProcessRasterize_LineWith(rasterizeLine);
+            else ProcessRasterize(transform);
             pfInternal_ResetVertexBufferForNextElement();
         }
     }
@@ -1785,6 +2063,37 @@ void pfBegin(PFdrawmode mode)
     pfInternal_UpdateMatrices(
         !(mode == PF_POINTS || mode == PF_LINES));
 
+    // NOTE: The binned triangles are shaded and sampled with the current setups, a new
+    //       one only replaces them once they are drawn. The view position is not part of
+    //       it, each triangle keeps its own.
+
+    if ((currentCtx->state & PF_LIGHTING) && currentCtx->activeLights)
+    {
+        PFlighting lighting = currentCtx->lighting;
+        Lighting_Setup(&lighting);
+
+        pfmVec3Copy(currentCtx->lighting.viewPos, lighting.viewPos);
+
+        if (memcmp(&lighting, &currentCtx->lighting, sizeof(PFlighting)) != 0)
+        {
+            pfInternal_FlushBins();
+            memcpy(&currentCtx->lighting, &lighting, sizeof(PFlighting));
+        }
+    }
+
+    if ((currentCtx->state & PF_TEXTURE_2D) && currentCtx->currentTexture)
+    {
+        PFsampler sampler;
+        memset(&sampler, 0, sizeof(PFsampler));
+        Sampler_Init(&sampler, currentCtx->currentTexture);
+
+        if (memcmp(&sampler, &currentCtx->sampler, sizeof(PFsampler)) != 0)
+        {
+            pfInternal_FlushBins();
+            memcpy(&currentCtx->sampler, &sampler, sizeof(PFsampler));
+        }
+    }
+
     currentCtx->currentDrawMode = mode;
     currentCtx->vertexCounter = 0;
 }
@@ -1859,7 +2168,7 @@ void pfVertex4fv(const PFfloat* v)
 
     if (currentCtx->vertexCounter == pfInternal_GetDrawModeVertexCount(currentCtx->currentDrawMode))
     {
-        ProcessRasterize();
+        ProcessRasterize(PF_FALSE);
         pfInternal_ResetVertexBufferForNextElement();
     }
 }
@@ -1870,6 +2179,8 @@ static void pfInternal_SetMaterialColor(PFcolor color)
 {
     PFmaterial *m1 = NULL, *m2 = NULL;
 
+    pfInternal_FlushBins();
+
     switch (currentCtx->materialColorFollowing.face)
     {
         case PF_BACK:
@@ -2134,6 +2445,8 @@ void pfRectiv(const PFint* v1, const PFint* v2)
 
 void pfRectf(PFfloat x1, PFfloat y1, PFfloat x2, PFfloat y2)
 {
+    pfInternal_FlushBins();
+
     // Get the transformation matrix from model to view (ModelView) and projection
     pfInternal_UpdateMatrices(PF_FALSE);
 
@@ -2160,13 +2473,15 @@ void pfRectf(PFfloat x1, PFfloat y1, PFfloat x2, PFfloat y2)
     iY2 = CLAMP(iY2, currentCtx->vpMin[1], currentCtx->vpMax[1]);
 
     // Retrieve framebuffer information
-    PFint wDst = currentCtx->currentFramebuffer->texture.width;
-    void *bufDst = currentCtx->currentFramebuffer->texture.pixels;
-    PFpixelsetter pixelSetter = currentCtx->currentFramebuffer->texture.pixelSetter;
+    const PFtexture *texDst = &currentCtx->currentFramebuffer->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFint wDst = texDst->width;
 
     // Retrieve current drawing color
     PFcolor color = currentCtx->currentColor;
 
+    pfInternal_Damage(iX1, iY1, iX2, iY2);
+
     // Draw rectangle
     for (PFint y = iY1; y <= iY2; y++)
     {
@@ -2174,7 +2489,7 @@ void pfRectf(PFfloat x1, PFfloat y1, PFfloat x2, PFfloat y2)
 
         for (PFint x = iX1; x <= iX2; x++)
         {
-            pixelSetter(bufDst, yOffset + x, color);
+            Pixel_Set(texDst, dstFormat, yOffset + x, color);
         }
     }
 }
@@ -2190,16 +2505,17 @@ void pfRectfv(const PFfloat* v1, const PFfloat* v2)
 void pfDrawPixels(PFsizei width, PFsizei height, PFpixelformat format, const void* pixels)
 {
     // Retrieve the appropriate pixel getter function for the given buffer format
-    PFpixelgetter getPixelSrc = NULL;
-    pfInternal_GetPixelGetterSetter(&getPixelSrc, NULL, format);
+    PFtexture texSrc = pfGenTexture((void*)pixels, width, height, format);
 
     // Check if we were able to get the pixel getter function
-    if (!getPixelSrc)
+    if (!texSrc.pixelGetter)
     {
         currentCtx->errCode = PF_INVALID_ENUM;
         return;
     }
 
+    pfInternal_FlushBins();
+
     // Get the transformation matrix from model to view (ModelView) and projection
     pfInternal_UpdateMatrices(PF_FALSE);
 
@@ -2215,64 +2531,28 @@ void pfDrawPixels(PFsizei width, PFsizei height, PFpixelformat format, const voi
     PFfloat zPos = rasterPos[2]; // Z position remains unchanged
 
     // Calculate the destination rectangle (clipped to viewport boundaries)
-    PFint xMin = CLAMP(xScreen, currentCtx->vpMin[0], currentCtx->vpMax[0]);
-    PFint yMin = CLAMP(yScreen, currentCtx->vpMin[1], currentCtx->vpMax[1]);
-    PFint xMax = CLAMP(xScreen + width*currentCtx->pixelZoom[0], currentCtx->vpMin[0], currentCtx->vpMax[0]);
-    PFint yMax = CLAMP(yScreen + height*currentCtx->pixelZoom[1], currentCtx->vpMin[1], currentCtx->vpMax[1]);
-
-    // Calculate inverse lengths for texture sampling
-    PFfloat invXLen = 1.0f/(PFfloat)(width*currentCtx->pixelZoom[0]);
-    PFfloat invYLen = 1.0f/(PFfloat)(height*currentCtx->pixelZoom[1]);
-
-    // Get current framebuffer and depth buffer
-    PFtexture *texDst = &currentCtx->currentFramebuffer->texture;
-    PFfloat *zBuffer = currentCtx->currentFramebuffer->zbuffer;
-
-    // Check if depth test is enabled
-    PFboolean noDepthTest = !(currentCtx->state & PF_DEPTH_TEST);
+    // NOTE: The last column and row are the ones of the last source pixel
+    PFint xMin = MAX(xScreen, currentCtx->vpMin[0]);
+    PFint yMin = MAX(yScreen, currentCtx->vpMin[1]);
+    PFint xMax = MIN((PFint)(xScreen + width*currentCtx->pixelZoom[0]) - 1, currentCtx->vpMax[0]);
+    PFint yMax = MIN((PFint)(yScreen + height*currentCtx->pixelZoom[1]) - 1, currentCtx->vpMax[1]);
 
-    // Get the color mixing function (if necessary)
-    PFblendfunc blendFunction = currentCtx->state & PF_BLEND ?
-        currentCtx->blendFunction : NULL;
+    if (xMin > xMax || yMin > yMax) return;
 
-    // Loop through each pixel in the destination rectangle
-#   ifdef PF_SUPPORT_OPENMP
-#       pragma omp parallel for if ((yMax - yMin)*(xMax - xMin) >= PF_OPENMP_RASTER_THRESHOLD_AREA)
-#   endif // PF_SUPPORT_OPENMP
-    for (PFint y = yMin; y <= yMax; y++)
-    {
-        // Calculate texture V coordinate based on screen Y coordinate
-        PFfloat v = (PFfloat)(y - yScreen)*invYLen;
-        PFsizei ySrcOffset = (PFsizei)(v*height)*width; // Offset into source texture
-
-        // Calculate destination offset for this scanline
-        PFsizei yDstOffset = y*texDst->width;
+    // NOTE: In overlay mode the pixels are drawn over everything and the depth buffer isn't touched
+    PFboolean overlay = (currentCtx->state & PF_PIXELS_OVERLAY);
 
-        for (PFint x = xMin; x <= xMax; x++)
-        {
-            // Calculate destination offset for this pixel
-            PFsizei xyDstOffset = yDstOffset + x;
+    if (!overlay) Depth_ResolveTiles(currentCtx->currentFramebuffer, xMin, yMin, xMax, yMax);
 
-            // Perform depth test or skip if disabled
-            if (noDepthTest || currentCtx->depthFunction(zPos, zBuffer[xyDstOffset]))
-            {
-                // Calculate texture U coordinate based on screen X coordinate
-                PFfloat u = (PFfloat)(x - xScreen)*invXLen;
+    pfInternal_Damage(xMin, yMin, xMax, yMax);
 
-                // Calculate offset into source texture for this pixel
-                PFsizei xySrcOffset = ySrcOffset + (PFsizei)(u*width);
+    const PFint bounds[4] = { xMin, yMin, xMax, yMax };
+    Rasterize_PixelRect(&texSrc, bounds, xScreen, yScreen, currentCtx->pixelZoom, zPos, overlay);
 
-                // Update depth buffer with new depth value
-                zBuffer[xyDstOffset] = zPos;
-
-                // Retrieve source color
-                PFcolor color = getPixelSrc(pixels, xySrcOffset);
-
-                // Blend source and destination colors and update framebuffer
-                texDst->pixelSetter(texDst->pixels, xyDstOffset, blendFunction
-                    ? blendFunction(color, texDst->pixelGetter(texDst->pixels, xyDstOffset)) : color);
-            }
-        }
+    // Keep the coarse depth buffer conservative if the depths may have been raised
+    if (!overlay && (!(currentCtx->state & PF_DEPTH_TEST) || !Depth_IsLessTest(currentCtx->depthFunction)))
+    {
+        Depth_RaiseTiles(currentCtx->currentFramebuffer, xMin, yMin, xMax, yMax, zPos);
     }
 }
 
@@ -2505,12 +2785,21 @@ void pfFogfv(PFfogparam pname, PFfloat* param)
 
 void pfFogProcess(void)
 {
+    pfInternal_FlushBins();
+
+    if (currentCtx->currentFramebuffer == &currentCtx->mainFramebuffer)
+    {
+        pfInternal_DamageAll();
+    }
+
     PFint width = currentCtx->currentFramebuffer->texture.width;
     PFint height = currentCtx->currentFramebuffer->texture.height;
 
     void *pixels = currentCtx->currentFramebuffer->texture.pixels;
     const PFfloat *zBuffer = currentCtx->currentFramebuffer->zbuffer;
 
+    Depth_ResolveAll(currentCtx->currentFramebuffer);
+
     PFpixelgetter pixelGetter = currentCtx->currentFramebuffer->texture.pixelGetter;
     PFpixelsetter pixelSetter = currentCtx->currentFramebuffer->texture.pixelSetter;
 
@@ -2603,6 +2892,8 @@ void pfReadPixels(PFint x, PFint y, PFsizei width, PFsizei height, PFpixelformat
         return;
     }
 
+    pfInternal_FlushBins();
+
     /* Retrieve information about the source framebuffer */
 
     const PFframebuffer *srcFB = currentCtx->currentFramebuffer;
@@ -2619,6 +2910,23 @@ void pfReadPixels(PFint x, PFint y, PFsizei width, PFsizei height, PFpixelformat
 
     /* Reads pixels from the framebuffer and copies them to the destination */
 
+    // NOTE: The rows of a framebuffer accessed with its built-in getter are converted at once
+    PFpixelformat srcFormat = pfInternal_GetDirectPixelFormat(&srcFB->texture);
+
+    if (srcFormat != PF_PIXELFORMAT_UNKNOWN)
+    {
+        PFsizei srcBpp = pfInternal_GetPixelBytes(srcFormat);
+        PFsizei dstBpp = pfInternal_GetPixelBytes(format);
+
+        for (PFsizei ySrc = yMin, yDst = 0; ySrc < yMax; ySrc++, yDst++)
+        {
+            pfConvertPixels((PFubyte*)pixels + yDst*width*dstBpp, format,
+                (const PFubyte*)srcPixels + (ySrc*srcWidth + xMin)*srcBpp, srcFormat, xMax - xMin);
+        }
+
+        return;
+    }
+
 #ifdef PF_SUPPORT_OPENMP
 #   pragma omp parallel for collapse(2)
     for (PFsizei ySrc = yMin; ySrc < yMax; ySrc++)
@@ -2643,12 +2951,21 @@ void pfReadPixels(PFint x, PFint y, PFsizei width, PFsizei height, PFpixelformat
 
 void pfPostProcess(PFpostprocessfunc postProcessFunction)
 {
+    pfInternal_FlushBins();
+
+    if (currentCtx->currentFramebuffer == &currentCtx->mainFramebuffer)
+    {
+        pfInternal_DamageAll();
+    }
+
     PFint width = currentCtx->currentFramebuffer->texture.width;
     PFint height = currentCtx->currentFramebuffer->texture.height;
 
     void *pixels = currentCtx->currentFramebuffer->texture.pixels;
     const PFfloat *zBuffer = currentCtx->currentFramebuffer->zbuffer;
 
+    Depth_ResolveAll(currentCtx->currentFramebuffer);
+
     PFpixelgetter pixelGetter = currentCtx->currentFramebuffer->texture.pixelGetter;
     PFpixelsetter pixelSetter = currentCtx->currentFramebuffer->texture.pixelSetter;
 
@@ -2694,27 +3011,27 @@ void pfPostProcess(PFpostprocessfunc postProcessFunction)
 
 void pfInternal_HomogeneousToScreen(PFvertex* v)
 {
-    // NOTE: We add 0.5 to the screen coordinates to round them to the nearest integer
-    // when they are converted to integer coordinates. This adjustment was added because
-    // during clipping, some triangle vertices from the positive plane were found to be
-    // offset by -1 pixel in X or Y (or both in some cases), which could even cause
-    // triangle "tearing". While it's unclear if this is the best or correct solution,
-    // it effectively resolves the issue without observed problems so far. There may be
-    // an error in the polygon clipping functions. Nonetheless, this solution has been
-    // functioning without issue up to this point.
+    // NOTE: The viewport covers the screen coordinates from 'vpPos' to 'vpPos + vpDim + 1',
+    //       the pixel (x, y) being the square from (x, y) to (x + 1, y + 1). Truncating the
+    //       coordinates gives the pixel they fall in, and the triangle rasterizer samples
+    //       the pixels at their center (see 'Rasterize_ToSubPixel').
 
-    v->screen[0] = (currentCtx->vpPos[0] + (v->homogeneous[0] + 1.0f) * 0.5f * currentCtx->vpDim[0]) + 0.5f;
-    v->screen[1] = (currentCtx->vpPos[1] + (1.0f - v->homogeneous[1]) * 0.5f * currentCtx->vpDim[1]) + 0.5f;
+    v->screen[0] = currentCtx->vpPos[0] + (v->homogeneous[0] + 1.0f) * 0.5f * (currentCtx->vpDim[0] + 1);
+    v->screen[1] = currentCtx->vpPos[1] + (1.0f - v->homogeneous[1]) * 0.5f * (currentCtx->vpDim[1] + 1);
 }
 
 /* Internal processing and rasterization function definitions */
 
 static void ProcessRasterize_Point(void)
 {
+    pfInternal_FlushBins();
+
     PFvertex *processed = currentCtx->vertexBuffer;
 
     if (Process_ProjectPoint(processed))
     {
+        pfInternal_DamageVertices(processed, 1, 0.5f*currentCtx->pointSize);
+
         (currentCtx->state & PF_DEPTH_TEST ?
             Rasterize_Point_DEPTH : Rasterize_Point_NODEPTH)(processed);
     }
@@ -2722,19 +3039,25 @@ static void ProcessRasterize_Point(void)
 
 static void ProcessRasterize_PolygonPoints(int_fast8_t vertexCount)
 {
+    pfInternal_FlushBins();
+
     for (int_fast8_t i = 0; i < vertexCount; i++)
     {
         PFvertex *processed = currentCtx->vertexBuffer + i;
 
         if (Process_ProjectPoint(processed))
         {
+            pfInternal_DamageVertices(processed, 1, 0.5f*currentCtx->pointSize);
+
             (currentCtx->state & PF_DEPTH_TEST ?
                 Rasterize_Point_DEPTH : Rasterize_Point_NODEPTH)(processed);
         }
     }
 }
 
-static void ProcessRasterize_Line()
+// NOTE: Does not flush the bins, the callers drawing many lines flush them and select
+//       the rasterizer once, lines never go through the bins
+static void ProcessRasterize_LineWith(PFlinefunc rasterizeLine)
 {
     // Process vertices
     int_fast8_t processedCounter = 2;
@@ -2747,21 +3070,24 @@ static void ProcessRasterize_Line()
     Process_ProjectAndClipLine(processed, &processedCounter);
     if (processedCounter != 2) return;
 
-    // Rasterize line (review condition)
-    if (currentCtx->lineWidth > 1.5f)
-    {
-        (currentCtx->state & PF_DEPTH_TEST ? Rasterize_Line_THICK_DEPTH
-            : Rasterize_Line_THICK_NODEPTH)(&processed[0], &processed[1]);
-    }
-    else
-    {
-        (currentCtx->state & PF_DEPTH_TEST ? Rasterize_Line_DEPTH
-            : Rasterize_Line_NODEPTH)(&processed[0], &processed[1]);
-    }
+    // NOTE: Thick lines are widened along the minor axis by up to width/sqrt(2) on each side
+    pfInternal_DamageVertices(processed, 2, currentCtx->lineWidth);
+
+    rasterizeLine(&processed[0], &processed[1]);
+}
+
+static void ProcessRasterize_Line(void)
+{
+    pfInternal_FlushBins();
+    ProcessRasterize_LineWith(Rasterize_GetLineFunc());
 }
 
 static void ProcessRasterize_PolygonLines(int_fast8_t vertexCount)
 {
+    pfInternal_FlushBins();
+
+    PFlinefunc rasterizeLine = Rasterize_GetLineFunc();
+
     for (int_fast8_t i = 0; i < vertexCount; i++)
     {
         // Process vertices
@@ -2773,38 +3099,31 @@ static void ProcessRasterize_PolygonLines(int_fast8_t vertexCount)
         };
 
         Process_ProjectAndClipLine(processed, &processedCounter);
-        if (processedCounter != 2) return;
+        if (processedCounter != 2) continue;
 
-        // Rasterize line
-        if (currentCtx->lineWidth > 1.5f)
-        {
-            (currentCtx->state & PF_DEPTH_TEST ? Rasterize_Line_THICK_DEPTH
-                : Rasterize_Line_THICK_NODEPTH)(&processed[0], &processed[1]);
-        }
-        else
-        {
-            (currentCtx->state & PF_DEPTH_TEST ? Rasterize_Line_DEPTH
-                : Rasterize_Line_NODEPTH)(&processed[0], &processed[1]);
-        }
+        pfInternal_DamageVertices(processed, 2, currentCtx->lineWidth);
+
+        rasterizeLine(&processed[0], &processed[1]);
     }
 }
 
 // NOTE: An array of vertices with a total size equal to 'PF_MAX_CLIPPED_POLYGON_VERTICES' must be provided as a parameter
 //       with only the first three vertices defined; the extra space is used in case the triangle needs to be clipped.
-static void ProcessRasterize_Triangle_IMPL(PFface faceToRender, PFvertex processed[PF_MAX_CLIPPED_POLYGON_VERTICES])
+//       If 'transformed' is true the vertices have already been passed through 'pfInternal_TransformVertex'
+//       (or through the bulk transform of 'pfDrawArrays').
+//       With PF_FRONT_AND_BACK the triangle is processed once and each rasterized triangle gets the
+//       face given by its signed area, instead of processing it once per face and rejecting it once.
+static void ProcessRasterize_Triangle_IMPL(PFface faceToRender, PFvertex processed[PF_MAX_CLIPPED_POLYGON_VERTICES], PFboolean transformed)
 {
-#ifndef NDEBUG
-    if (faceToRender == PF_FRONT_AND_BACK)
-    {
-        // WARNING: This should not be called with PF_FRONT_AND_BACK
-        currentCtx->errCode = PF_DEBUG_INVALID_OPERATION;
-        return;
-    }
-#endif
-
     PFboolean lighting = (currentCtx->state & PF_LIGHTING) &&
                          (currentCtx->activeLights != NULL);
 
+    PFboolean twoSided = (faceToRender == PF_FRONT_AND_BACK);
+
+    // NOTE: With PF_VERTEX_LIGHTING the vertices are lit before clipping and the rasterizer
+    //       only interpolates their colors; in two-sided mode they are lit per rasterized triangle
+    PFboolean vertexLighting = lighting && (currentCtx->state & PF_VERTEX_LIGHTING);
+
     int_fast8_t processedCounter = 3;
 
     // Performs certain operations that must be done before
@@ -2816,44 +3135,94 @@ static void ProcessRasterize_Triangle_IMPL(PFface faceToRender, PFvertex process
         // And multiply vertex color with diffuse color
         for (int_fast8_t i = 0; i < processedCounter; i++)
         {
-            pfmVec3Transform(processed[i].normal, processed[i].normal, currentCtx->matNormal);
-            pfmVec3Normalize(processed[i].normal, processed[i].normal); // REVIEW: Only with PF_NORMALIZE state??
+            if (!transformed)
+            {
+                pfmVec3Transform(processed[i].normal, processed[i].normal, currentCtx->matNormal);
+                pfmVec3Normalize(processed[i].normal, processed[i].normal); // REVIEW: Only with PF_NORMALIZE state??
+            }
+
+            // NOTE: In two-sided mode the face is only known after projection,
+            //       the diffuse color is then applied per rasterized triangle
+            if (!twoSided)
+            {
+                processed[i].color = pfBlendMultiplicative(processed[i].color,
+                    currentCtx->faceMaterial[faceToRender].diffuse);
 
-            processed[i].color = pfBlendMultiplicative(processed[i].color,
-                currentCtx->faceMaterial[faceToRender].diffuse);
+                if (vertexLighting)
+                {
+                    processed[i].color = Lighting_Shade(&currentCtx->lighting, faceToRender,
+                        processed[i].color, currentCtx->lighting.viewPos, processed[i].position, processed[i].normal);
+                }
+            }
         }
     }
 
     // Process vertices
 
-    PFboolean is3D = Process_ProjectAndClipTriangle(processed, &processedCounter);
+    PFboolean is3D = transformed
+        ? Process_ClipAndProjectTriangle(processed, &processedCounter)
+        : Process_ProjectAndClipTriangle(processed, &processedCounter);
     if (processedCounter < 3) return;
 
-    // Rasterize filled triangles
+    pfInternal_DamageVertices(processed, processedCounter, 0.0f);
 
-    PFMvec3 viewPos = { 0 };
+    // Rasterize filled triangles
 
-    if (lighting)
-    {
-        PFMmat4 invMatView;
-        pfmMat4Invert(invMatView, currentCtx->matView);
-        pfmVec3Copy(viewPos, invMatView + 12);
-    }
+    // NOTE: The position of the camera is computed once per draw by 'Lighting_Setup'
+    const PFfloat *viewPos = currentCtx->lighting.viewPos;
 
     for (int_fast8_t i = 0; i < processedCounter - 2; i++)
     {
-        Rasterize_Triangle(faceToRender, is3D, &processed[0], &processed[i + 1], &processed[i + 2], viewPos);
+        PFface face = faceToRender;
+        const PFvertex *v1 = &processed[0], *v2 = &processed[i + 1], *v3 = &processed[i + 2];
+        PFvertex lit[3];
+
+        if (twoSided)
+        {
+            face = Rasterize_TriangleFace(v1, v2, v3);
+            if (face == PF_FRONT_AND_BACK) continue;
+
+            if (lighting)
+            {
+                const PFcolor diffuse = currentCtx->faceMaterial[face].diffuse;
+
+                lit[0] = *v1, lit[1] = *v2, lit[2] = *v3;
+
+                for (int_fast8_t j = 0; j < 3; j++)
+                {
+                    lit[j].color = pfBlendMultiplicative(lit[j].color, diffuse);
+
+                    if (vertexLighting)
+                    {
+                        lit[j].color = Lighting_Shade(&currentCtx->lighting, face,
+                            lit[j].color, viewPos, lit[j].position, lit[j].normal);
+                    }
+                }
+
+                v1 = &lit[0], v2 = &lit[1], v3 = &lit[2];
+            }
+        }
+
+#ifdef PF_SUPPORT_BINNED_RASTER
+        if (currentCtx->binner)
+        {
+            Binning_PushTriangle(currentCtx->binner, face, is3D, v1, v2, v3, viewPos);
+            continue;
+        }
+#endif //PF_SUPPORT_BINNED_RASTER
+
+        Rasterize_Triangle(face, is3D, v1, v2, v3, viewPos);
     }
 }
 
-static void ProcessRasterize_Triangle(PFface faceToRender)
+static void ProcessRasterize_Triangle(PFface faceToRender, PFboolean transformed)
 {
     PFvertex processed[PF_MAX_CLIPPED_POLYGON_VERTICES];
     memcpy(processed, currentCtx->vertexBuffer, 3 * sizeof(PFvertex));
-    ProcessRasterize_Triangle_IMPL(faceToRender, processed);
+    ProcessRasterize_Triangle_IMPL(faceToRender, processed, transformed);
 }
 
-static void ProcessRasterize_TriangleFan(PFface faceToRender, int_fast8_t numTriangles)
+static void ProcessRasterize_TriangleFan(PFface faceToRender, int_fast8_t numTriangles, PFboolean transformed)
 {
     for (int_fast8_t i = 0; i < numTriangles; i++)
     {
@@ -2863,11 +3232,11 @@ static void ProcessRasterize_TriangleFan(PFface faceToRender, int_fast8_t numTri
             currentCtx->vertexBuffer[i + 2]
         };
 
-        ProcessRasterize_Triangle_IMPL(faceToRender, processed);
+        ProcessRasterize_Triangle_IMPL(faceToRender, processed, transformed);
     }
 }
 
-static void ProcessRasterize_TriangleStrip(PFface faceToRender, int_fast8_t numTriangles)
+static void ProcessRasterize_TriangleStrip(PFface faceToRender, int_fast8_t numTriangles, PFboolean transformed)
 {
     for (int_fast8_t i = 0; i < numTriangles; i++)
     {
@@ -2886,11 +3255,126 @@ static void ProcessRasterize_TriangleStrip(PFface faceToRender, int_fast8_t numT
             processed[2] = currentCtx->vertexBuffer[i];
         }
 
-        ProcessRasterize_Triangle_IMPL(faceToRender, processed);
+        ProcessRasterize_Triangle_IMPL(faceToRender, processed, transformed);
     }
 }
 
-void ProcessRasterize(void)
+// NOTE: Filled triangles of both faces can be rasterized in a single pass (see 'ProcessRasterize_Triangle_IMPL')
+static inline PFboolean pfInternal_IsTwoSidedFill(void)
+{
+    return currentCtx->polygonMode[PF_FRONT] == PF_FILL
+        && currentCtx->polygonMode[PF_BACK] == PF_FILL;
+}
+
+// NOTE: Screen-aligned 2D quads with a single color (and a single texel when textured) are
+//       filled row by row by 'Rasterize_RectSpans' instead of being rasterized as two triangles.
+//       Returns false if the quad doesn't qualify and must go through the triangle path.
+static PFboolean ProcessRasterize_QuadSpans(PFface faceToRender, PFboolean transformed)
+{
+#ifdef PF_SUPPORT_BINNED_RASTER
+    // NOTE: Filling it now would draw it before the triangles still in the bins
+    if (currentCtx->binner) return PF_FALSE;
+#endif //PF_SUPPORT_BINNED_RASTER
+
+    if ((currentCtx->state & PF_LIGHTING) && currentCtx->activeLights) return PF_FALSE;
+
+    if (faceToRender == PF_FRONT_AND_BACK
+        ? !pfInternal_IsTwoSidedFill()
+        : currentCtx->polygonMode[faceToRender] != PF_FILL)
+    {
+        return PF_FALSE;
+    }
+
+    /* Check that all the fragments would get the same color */
+
+    const PFvertex *quad = currentCtx->vertexBuffer;
+    PFboolean texturing = (currentCtx->state & PF_TEXTURE_2D) && currentCtx->currentTexture;
+
+    for (int_fast8_t i = 1; i < 4; i++)
+    {
+        if (quad[i].color.r != quad[0].color.r || quad[i].color.g != quad[0].color.g
+         || quad[i].color.b != quad[0].color.b || quad[i].color.a != quad[0].color.a)
+        {
+            return PF_FALSE;
+        }
+
+        if (texturing && (quad[i].texcoord[0] != quad[0].texcoord[0] || quad[i].texcoord[1] != quad[0].texcoord[1]))
+        {
+            return PF_FALSE;
+        }
+    }
+
+    /* Project the quad, it must be "2D" (see 'Process_ClipAndProjectTriangle') with a constant depth */
+
+    PFvertex projected[4];
+    PFint x[4], y[4];
+
+    for (int_fast8_t i = 0; i < 4; i++)
+    {
+        projected[i] = quad[i];
+
+        if (!transformed)
+        {
+            memcpy(projected[i].homogeneous, projected[i].position, sizeof(PFMvec4));
+            pfmVec4Transform(projected[i].homogeneous, projected[i].homogeneous, currentCtx->matMVP);
+        }
+
+        if (fabsf(projected[i].homogeneous[3] - 1.0f) >= PF_CLIP_EPSILON
+         || projected[i].homogeneous[2] != projected[0].homogeneous[2])
+        {
+            return PF_FALSE;
+        }
+
+        pfInternal_HomogeneousToScreen(&projected[i]);
+        x[i] = Rasterize_ToSubPixel(projected[i].screen[0]);
+        y[i] = Rasterize_ToSubPixel(projected[i].screen[1]);
+    }
+
+    // NOTE: Compared on the sub-pixel coordinates used by the triangle rasterizer, for which
+    //       the two triangles of such a quad cover exactly the pixels whose center is inside
+    //       of it, excluding its right and bottom sides (top-left rule)
+
+    if (!(x[0] == x[1] && x[2] == x[3] && y[0] == y[3] && y[1] == y[2])
+     && !(y[0] == y[1] && y[2] == y[3] && x[0] == x[3] && x[1] == x[2]))
+    {
+        return PF_FALSE;
+    }
+
+    /* From there, the quad is handled here */
+
+    PFface face = Rasterize_TriangleFace(&projected[0], &projected[1], &projected[2]);
+    if (face == PF_FRONT_AND_BACK) return PF_TRUE;  // Degenerate, covers no pixel
+    if (faceToRender != PF_FRONT_AND_BACK && face != faceToRender) return PF_TRUE;
+
+    const PFtexture *texDst = &currentCtx->currentFramebuffer->texture;
+
+    PFint xLast = MIN(currentCtx->vpPos[0] + (PFint)currentCtx->vpDim[0], MIN(currentCtx->vpMax[0], (PFint)texDst->width - 1));
+    PFint yLast = MIN(currentCtx->vpPos[1] + (PFint)currentCtx->vpDim[1], MIN(currentCtx->vpMax[1], (PFint)texDst->height - 1));
+
+    const PFint bounds[4] = {
+        MAX(Rasterize_FirstPixel(MIN(x[0], x[2])), currentCtx->vpMin[0]),
+        MAX(Rasterize_FirstPixel(MIN(y[0], y[2])), currentCtx->vpMin[1]),
+        MIN(Rasterize_FirstPixel(MAX(x[0], x[2])) - 1, xLast),
+        MIN(Rasterize_FirstPixel(MAX(y[0], y[2])) - 1, yLast)
+    };
+
+    if (bounds[0] > bounds[2] || bounds[1] > bounds[3]) return PF_TRUE;
+
+    PFcolor color = quad[0].color;
+
+    if (texturing)
+    {
+        PFcolor texel = Sampler_Sample(&currentCtx->sampler, quad[0].texcoord[0], quad[0].texcoord[1], 0.0f);
+        color = pfBlendMultiplicative(texel, color);
+    }
+
+    pfInternal_Damage(bounds[0], bounds[1], bounds[2], bounds[3]);
+    Rasterize_RectSpans(bounds, 1.0f/projected[0].homogeneous[2], color);
+
+    return PF_TRUE;
+}
+
+void ProcessRasterize(PFboolean transformed)
 {
     switch (currentCtx->currentDrawMode)
     {
@@ -2910,7 +3394,11 @@ void ProcessRasterize(void)
             PFface faceToRender = (currentCtx->state & PF_CULL_FACE)
                 ? (!currentCtx->cullFace) : PF_FRONT_AND_BACK;
 
-            if (faceToRender == PF_FRONT_AND_BACK)
+            if (faceToRender == PF_FRONT_AND_BACK && pfInternal_IsTwoSidedFill())
+            {
+                ProcessRasterize_Triangle(PF_FRONT_AND_BACK, transformed);
+            }
+            else if (faceToRender == PF_FRONT_AND_BACK)
             {
                 for (PFint iFace = 0; iFace < 2; iFace++)
                 {
@@ -2925,7 +3413,7 @@ void ProcessRasterize(void)
                             break;
 
                         case PF_FILL:
-                            ProcessRasterize_Triangle(iFace);
+                            ProcessRasterize_Triangle(iFace, transformed);
                             break;
                     }
                 }
@@ -2943,7 +3431,7 @@ void ProcessRasterize(void)
                         break;
 
                     case PF_FILL:
-                        ProcessRasterize_Triangle(faceToRender);
+                        ProcessRasterize_Triangle(faceToRender, transformed);
                         break;
                 }
             }
@@ -2958,15 +3446,7 @@ void ProcessRasterize(void)
             PFface faceToRender = (currentCtx->state & PF_CULL_FACE)
                 ? (!currentCtx->cullFace) : PF_FRONT_AND_BACK;
 
-            if (faceToRender == PF_FRONT_AND_BACK)
-            {
-                ProcessRasterize_TriangleFan(PF_FRONT, 2);
-                ProcessRasterize_TriangleFan(PF_BACK, 2);
-            }
-            else
-            {
-                ProcessRasterize_TriangleFan(faceToRender, 2);
-            }
+            ProcessRasterize_TriangleFan(faceToRender, 2, transformed);
         }
         break;
 
@@ -2978,15 +3458,7 @@ void ProcessRasterize(void)
             PFface faceToRender = (currentCtx->state & PF_CULL_FACE)
                 ? (!currentCtx->cullFace) : PF_FRONT_AND_BACK;
 
-            if (faceToRender == PF_FRONT_AND_BACK)
-            {
-                ProcessRasterize_TriangleStrip(PF_FRONT, 2);
-                ProcessRasterize_TriangleStrip(PF_BACK, 2);
-            }
-            else
-            {
-                ProcessRasterize_TriangleStrip(faceToRender, 2);
-            }
+            ProcessRasterize_TriangleStrip(faceToRender, 2, transformed);
         }
         break;
 
@@ -2998,7 +3470,16 @@ void ProcessRasterize(void)
             PFface faceToRender = (currentCtx->state & PF_CULL_FACE)
                 ? (!currentCtx->cullFace) : PF_FRONT_AND_BACK;
 
-            if (faceToRender == PF_FRONT_AND_BACK)
+            if (ProcessRasterize_QuadSpans(faceToRender, transformed))
+            {
+                break;
+            }
+
+            if (faceToRender == PF_FRONT_AND_BACK && pfInternal_IsTwoSidedFill())
+            {
+                ProcessRasterize_TriangleFan(PF_FRONT_AND_BACK, 2, transformed);
+            }
+            else if (faceToRender == PF_FRONT_AND_BACK)
             {
                 for (PFint iFace = 0; iFace < 2; iFace++)
                 {
@@ -3013,7 +3494,7 @@ void ProcessRasterize(void)
                             break;
 
                         case PF_FILL:
-                            ProcessRasterize_TriangleFan(iFace, 2);
+                            ProcessRasterize_TriangleFan(iFace, 2, transformed);
                             break;
                     }
                 }
@@ -3031,7 +3512,7 @@ void ProcessRasterize(void)
                         break;
 
                     case PF_FILL:
-                        ProcessRasterize_TriangleFan(faceToRender, 2);
+                        ProcessRasterize_TriangleFan(faceToRender, 2, transformed);
                         break;
                 }
             }
@@ -3046,15 +3527,7 @@ void ProcessRasterize(void)
             PFface faceToRender = (currentCtx->state & PF_CULL_FACE)
                 ? (!currentCtx->cullFace) : PF_FRONT_AND_BACK;
 
-            if (faceToRender == PF_FRONT_AND_BACK)
-            {
-                ProcessRasterize_TriangleFan(PF_FRONT, 4);
-                ProcessRasterize_TriangleFan(PF_BACK, 4);
-            }
-            else
-            {
-                ProcessRasterize_TriangleFan(faceToRender, 4);
-            }
+            ProcessRasterize_TriangleFan(faceToRender, 4, transformed);
         }
         break;
 
@@ -3066,38 +3539,154 @@ void ProcessRasterize(void)
             PFface faceToRender = (currentCtx->state & PF_CULL_FACE)
                 ? (!currentCtx->cullFace) : PF_FRONT_AND_BACK;
 
-            if (faceToRender == PF_FRONT_AND_BACK)
-            {
-                ProcessRasterize_TriangleStrip(PF_FRONT, 4);
-                ProcessRasterize_TriangleStrip(PF_BACK, 4);
-            }
-            else
-            {
-                ProcessRasterize_TriangleStrip(faceToRender, 4);
-            }
+            ProcessRasterize_TriangleStrip(faceToRender, 4, transformed);
         }
         break;
     }
 }
 
-// TODO: don't realloc-bump shit
-static PFtexture **t_store = NULL;
-static long t_store_n = 0;
+/* Texture registry */
+
+// NOTE: The registry is a slot map shared by all contexts. An id packs the slot index
+//       (plus one, so that zero is never a valid id) in its low bits and the slot
+//       generation in its high bits; the generation is bumped whenever a slot is released
+//       so ids of released textures stop resolving even once their slot is reused.
+
+#define PF_TEXTURE_ID_INDEX_BITS    20
+#define PF_TEXTURE_ID_INDEX_MASK    ((1u << PF_TEXTURE_ID_INDEX_BITS) - 1)
+#define PF_TEXTURE_ID_MAX_SLOTS     PF_TEXTURE_ID_INDEX_MASK
+
+typedef struct {
+    PFtexture *texture;     ///< Allocated once and kept for the lifetime of the slot
+    PFsizei bytes;          ///< Size of the pixels owned by the slot
+    PFuint generation;      ///< Incremented each time the slot is released
+    PFint nextFree;         ///< Next slot of the free list, -1 at its end
+    PFboolean used;
+} PFtextureslot;
+
+static struct {
+    PFtextureslot *slots;
+    PFsizei capacity;
+    PFsizei count;          ///< Number of slots handed out so far (free or not)
+    PFint firstFree;
+    PFsizei liveTextures;
+    PFsizei liveBytes;
+} textureRegistry = { NULL, 0, 0, -1, 0, 0 };
+
+static PFtextureslot* pfInternal_GetTextureSlot(PFuint id)
+{
+    PFuint index = (id & PF_TEXTURE_ID_INDEX_MASK) - 1;
+    if (id == 0 || index >= textureRegistry.count) return NULL;
+
+    PFtextureslot *slot = &textureRegistry.slots[index];
+    if ((slot->generation & (~0u >> PF_TEXTURE_ID_INDEX_BITS)) != (id >> PF_TEXTURE_ID_INDEX_BITS)) return NULL;
+
+    return slot->used ? slot : NULL;
+}
+
+PFuint pfStoreTexture(const PFtexture* texture)
+{
+    PFint index = textureRegistry.firstFree;
+
+    if (index >= 0)
+    {
+        textureRegistry.firstFree = textureRegistry.slots[index].nextFree;
+    }
+    else
+    {
+        if (textureRegistry.count == PF_TEXTURE_ID_MAX_SLOTS) return 0;
+
+        if (textureRegistry.count == textureRegistry.capacity)
+        {
+            PFsizei capacity = textureRegistry.capacity ? 2*textureRegistry.capacity : 16;
+            if (capacity > PF_TEXTURE_ID_MAX_SLOTS) capacity = PF_TEXTURE_ID_MAX_SLOTS;
+
+            PFtextureslot *slots = (PFtextureslot*)PF_REALLOC(textureRegistry.slots, capacity*sizeof(PFtextureslot));
+            if (slots == NULL) goto outOfMemory;
+
+            textureRegistry.slots = slots;
+            textureRegistry.capacity = capacity;
+        }
+
+        PFtexture *allocated = (PFtexture*)PF_MALLOC(sizeof(PFtexture));
+        if (allocated == NULL) goto outOfMemory;
+
+        index = textureRegistry.count++;
+        textureRegistry.slots[index] = (PFtextureslot) { allocated, 0, 0, -1, PF_FALSE };
+    }
+
+    PFtextureslot *slot = &textureRegistry.slots[index];
+
+    *slot->texture = *texture;
+    slot->bytes = pfInternal_GetTextureBytes(texture);
+    slot->used = PF_TRUE;
+
+    textureRegistry.liveTextures++;
+    textureRegistry.liveBytes += slot->bytes;
+
+    return ((slot->generation << PF_TEXTURE_ID_INDEX_BITS) | (PFuint)(index + 1));
+
+outOfMemory:
+    if (currentCtx) currentCtx->errCode = PF_ERROR_OUT_OF_MEMORY;
+    return 0;
+}
+
+// NOTE: Called when the pixels of a texture are reallocated, if it's a stored one (the
+//       registry owns a copy, the one returned by 'pfGetTexture') its size is updated
+void pfInternal_UpdateStoredTexture(const PFtexture* texture)
+{
+    for (PFsizei i = 0; i < textureRegistry.count; i++)
+    {
+        PFtextureslot *slot = &textureRegistry.slots[i];
 
-unsigned int
-pfStoreTexture(PFtexture *p)
+        if (slot->used && slot->texture == texture)
+        {
+            PFsizei bytes = pfInternal_GetTextureBytes(texture);
+            textureRegistry.liveBytes += bytes - slot->bytes;
+            slot->bytes = bytes;
+            return;
+        }
+    }
+}
+
+PFtexture* pfGetTexture(PFuint id)
+{
+    PFtextureslot *slot = pfInternal_GetTextureSlot(id);
+    return slot ? slot->texture : NULL;
+}
+
+void pfReleaseTexture(PFuint id)
 {
-  t_store = realloc(t_store, sizeof(PFtexture*) * (t_store_n+1));
-  t_store[t_store_n] = p;
+    PFtextureslot *slot = pfInternal_GetTextureSlot(id);
+    if (slot == NULL) return;
+
+    if (currentCtx)
+    {
+        // NOTE: Binned triangles and the current binding may still reference the texture
+        pfInternal_FlushBins();
+        if (currentCtx->currentTexture == slot->texture)
+        {
+            currentCtx->currentTexture = NULL;
+        }
+    }
+
+    pfDeleteTexture(slot->texture);
 
-  // bodge that makes the indicies n+1, because raylib checks for id = 0 as a status of
-  // texture not being loaded yet ffs
-  return ++t_store_n;
+    textureRegistry.liveTextures--;
+    textureRegistry.liveBytes -= slot->bytes;
+
+    slot->used = PF_FALSE;
+    slot->generation++;
+    slot->nextFree = textureRegistry.firstFree;
+    textureRegistry.firstFree = (PFint)(slot - textureRegistry.slots);
+}
+
+PFsizei pfGetStoredTextureCount(void)
+{
+    return textureRegistry.liveTextures;
 }
 
-PFtexture *
-pfGetTexture(unsigned int id)
+PFsizei pfGetStoredTextureBytes(void)
 {
-  if (id == 0) return NULL;
-  return t_store[id-1];
+    return textureRegistry.liveBytes;
 }
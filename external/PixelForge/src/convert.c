@@ -0,0 +1,375 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "internal/context.h"
+#include "internal/pixel.h"
+#include "internal/config.h"
+#include "pixelforge.h"
+
+#include <string.h>
+
+/*
+    Row-wise pixel conversions.
+
+    Every conversion goes through 8 bit RGBA: the source row is expanded to
+    R8G8B8A8, then packed into the destination format, each with a loop
+    specialized for the format instead of a getter and a setter call per
+    pixel. When one of the formats is R8G8B8A8 the other loop works on the
+    pixels directly, otherwise the pixels are converted by chunks through a
+    buffer on the stack. The channels are computed as by the getters and
+    setters of 'texture.c', so both give exactly the same pixels.
+*/
+
+#if !defined(PF_NO_SIMD) && defined(__SSE2__)
+#   include <emmintrin.h>
+#   define PF_CONVERT_SSE2
+#endif
+
+/* Including internal function prototypes */
+
+extern void pfInternal_GetPixelGetterSetter(PFpixelgetter* getter, PFpixelsetter* setter, PFpixelformat format);
+extern PFsizei pfInternal_GetPixelBytes(PFpixelformat format);
+
+
+/* Internal convert functions */
+
+static void Convert_ToR8G8B8A8(PFubyte* dst, const void* src, PFpixelformat format, PFsizei count)
+{
+    const PFubyte *in = (const PFubyte*)src;
+    PFsizei i = 0;
+
+    switch (format)
+    {
+        case PF_PIXELFORMAT_GRAYSCALE:
+        {
+#       ifdef PF_CONVERT_SSE2
+            const __m128i ones = _mm_set1_epi8(-1);
+
+            // NOTE: 16 pixels, the gray bytes are duplicated then interleaved with 255
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i gray = _mm_loadu_si128((const __m128i*)(in + i));
+                __m128i ggLo = _mm_unpacklo_epi8(gray, gray), gaLo = _mm_unpacklo_epi8(gray, ones);
+                __m128i ggHi = _mm_unpackhi_epi8(gray, gray), gaHi = _mm_unpackhi_epi8(gray, ones);
+
+                _mm_storeu_si128((__m128i*)(dst + i*4), _mm_unpacklo_epi16(ggLo, gaLo));
+                _mm_storeu_si128((__m128i*)(dst + i*4 + 16), _mm_unpackhi_epi16(ggLo, gaLo));
+                _mm_storeu_si128((__m128i*)(dst + i*4 + 32), _mm_unpacklo_epi16(ggHi, gaHi));
+                _mm_storeu_si128((__m128i*)(dst + i*4 + 48), _mm_unpackhi_epi16(ggHi, gaHi));
+            }
+#       endif //PF_CONVERT_SSE2
+
+            for (; i < count; i++)
+            {
+                PFubyte *pixel = dst + i*4;
+                pixel[0] = pixel[1] = pixel[2] = in[i], pixel[3] = 255;
+            }
+        }
+        break;
+
+        case PF_PIXELFORMAT_GRAY_ALPHA:
+        {
+#       ifdef PF_CONVERT_SSE2
+            const __m128i grayMask = _mm_set1_epi16(0x00FF);
+
+            // NOTE: 8 pixels, the gray-gray pairs are interleaved with the gray-alpha pairs
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i grayAlpha = _mm_loadu_si128((const __m128i*)(in + i*2));
+                __m128i gray = _mm_and_si128(grayAlpha, grayMask);
+                __m128i grayGray = _mm_or_si128(gray, _mm_slli_epi16(gray, 8));
+
+                _mm_storeu_si128((__m128i*)(dst + i*4), _mm_unpacklo_epi16(grayGray, grayAlpha));
+                _mm_storeu_si128((__m128i*)(dst + i*4 + 16), _mm_unpackhi_epi16(grayGray, grayAlpha));
+            }
+#       endif //PF_CONVERT_SSE2
+
+            for (; i < count; i++)
+            {
+                PFubyte *pixel = dst + i*4;
+                pixel[0] = pixel[1] = pixel[2] = in[i*2], pixel[3] = in[i*2 + 1];
+            }
+        }
+        break;
+
+        case PF_PIXELFORMAT_R5G6B5:
+        {
+#       ifdef PF_CONVERT_SSE2
+            const __m128i mask5 = _mm_set1_epi16(0x1F), mask6 = _mm_set1_epi16(0x3F);
+
+            // NOTE: 8 pixels, the channels are expanded in 16 bit lanes as by 'Pixel_Expand5/6'
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i pixels = _mm_loadu_si128((const __m128i*)((const PFushort*)src + i));
+
+                __m128i r = _mm_srli_epi16(pixels, 11);
+                __m128i g = _mm_and_si128(_mm_srli_epi16(pixels, 5), mask6);
+                __m128i b = _mm_and_si128(pixels, mask5);
+
+                r = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(527)), _mm_set1_epi16(23)), 6);
+                g = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(259)), _mm_set1_epi16(33)), 6);
+                b = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(527)), _mm_set1_epi16(23)), 6);
+
+                // Bytes r, g in the low half of each 32 bit pixel, b, 255 in the high half
+                __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+                __m128i ba = _mm_or_si128(b, _mm_set1_epi16((short)0xFF00));
+
+                _mm_storeu_si128((__m128i*)(dst + i*4), _mm_unpacklo_epi16(rg, ba));
+                _mm_storeu_si128((__m128i*)(dst + i*4 + 16), _mm_unpackhi_epi16(rg, ba));
+            }
+#       endif //PF_CONVERT_SSE2
+
+            for (; i < count; i++)
+            {
+                PFushort pixel = ((const PFushort*)src)[i];
+                PFubyte *out = dst + i*4;
+
+                out[0] = Pixel_Expand5(pixel >> 11);
+                out[1] = Pixel_Expand6((pixel >> 5) & 0x3F);
+                out[2] = Pixel_Expand5(pixel & 0x1F);
+                out[3] = 255;
+            }
+        }
+        break;
+
+        case PF_PIXELFORMAT_R8G8B8:
+        case PF_PIXELFORMAT_B8G8R8:
+        {
+            PFboolean swap = (format == PF_PIXELFORMAT_B8G8R8);
+
+#       ifdef PF_CONVERT_SSE2
+            const __m128i alpha = _mm_set1_epi32((PFint)0xFF000000);
+            const __m128i greenAlpha = _mm_set1_epi32((PFint)0xFF00FF00);
+            const __m128i byteMask = _mm_set1_epi32(0xFF);
+
+            // NOTE: 4 pixels, shifted by 3 bytes each so that their low 32 bits are gathered;
+            //       16 bytes are loaded for 12, hence the 2 pixels left for the scalar loop
+            for (; i + 6 <= count; i += 4)
+            {
+                __m128i rgb = _mm_loadu_si128((const __m128i*)(in + i*3));
+
+                __m128i p01 = _mm_unpacklo_epi32(rgb, _mm_srli_si128(rgb, 3));
+                __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(rgb, 6), _mm_srli_si128(rgb, 9));
+                __m128i pixels = _mm_or_si128(_mm_unpacklo_epi64(p01, p23), alpha);
+
+                if (swap)
+                {
+                    __m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask);
+                    __m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, byteMask), 16);
+                    pixels = _mm_or_si128(_mm_and_si128(pixels, greenAlpha), _mm_or_si128(red, blue));
+                }
+
+                _mm_storeu_si128((__m128i*)(dst + i*4), pixels);
+            }
+#       endif //PF_CONVERT_SSE2
+
+            PFint r = swap ? 2 : 0, b = swap ? 0 : 2;
+
+            for (; i < count; i++)
+            {
+                PFubyte *pixel = dst + i*4;
+                pixel[0] = in[i*3 + r], pixel[1] = in[i*3 + 1], pixel[2] = in[i*3 + b], pixel[3] = 255;
+            }
+        }
+        break;
+
+        case PF_PIXELFORMAT_R8G8B8A8:
+            memcpy(dst, src, count*4);
+            break;
+
+        default:
+        {
+            PFpixelgetter getter = NULL;
+            pfInternal_GetPixelGetterSetter(&getter, NULL, format);
+
+            for (; i < count; i++)
+            {
+                PFcolor color = getter(src, i);
+                PFubyte *pixel = dst + i*4;
+                pixel[0] = color.r, pixel[1] = color.g, pixel[2] = color.b, pixel[3] = color.a;
+            }
+        }
+        break;
+    }
+}
+
+static void Convert_FromR8G8B8A8(void* dst, PFpixelformat format, const PFubyte* src, PFsizei count)
+{
+    PFubyte *out = (PFubyte*)dst;
+    PFsizei i = 0;
+
+    switch (format)
+    {
+        case PF_PIXELFORMAT_GRAYSCALE:
+            for (; i < count; i++)
+            {
+                const PFubyte *pixel = src + i*4;
+                out[i] = Pixel_Gray(pixel[0], pixel[1], pixel[2]);
+            }
+            break;
+
+        case PF_PIXELFORMAT_GRAY_ALPHA:
+            for (; i < count; i++)
+            {
+                const PFubyte *pixel = src + i*4;
+                out[i*2] = Pixel_Gray(pixel[0], pixel[1], pixel[2]), out[i*2 + 1] = pixel[3];
+            }
+            break;
+
+        case PF_PIXELFORMAT_R5G6B5:
+        {
+#       ifdef PF_CONVERT_SSE2
+            const __m128i byteMask = _mm_set1_epi32(0xFF);
+
+            // NOTE: 4 pixels per 32 bit lanes, each channel is reduced as by 'Pixel_ReduceChannel'
+            //       with 16 bit operations (the high half of the lanes stays zero)
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i packed[2];
+
+                for (PFint half = 0; half < 2; half++)
+                {
+                    __m128i pixels = _mm_loadu_si128((const __m128i*)(src + (i + half*4)*4));
+
+                    __m128i r = _mm_and_si128(pixels, byteMask);
+                    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask);
+                    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask);
+
+                    r = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi32(31)), _mm_set1_epi32(127));
+                    g = _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi32(63)), _mm_set1_epi32(127));
+                    b = _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi32(31)), _mm_set1_epi32(127));
+
+                    r = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(r, _mm_set1_epi32(1)), _mm_srli_epi32(r, 8)), 8);
+                    g = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(g, _mm_set1_epi32(1)), _mm_srli_epi32(g, 8)), 8);
+                    b = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(b, _mm_set1_epi32(1)), _mm_srli_epi32(b, 8)), 8);
+
+                    __m128i rgb = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 11), _mm_slli_epi32(g, 5)), b);
+
+                    // NOTE: Sign extended so that the signed saturation of the pack keeps the 16 bits
+                    packed[half] = _mm_srai_epi32(_mm_slli_epi32(rgb, 16), 16);
+                }
+
+                _mm_storeu_si128((__m128i*)((PFushort*)dst + i), _mm_packs_epi32(packed[0], packed[1]));
+            }
+#       endif //PF_CONVERT_SSE2
+
+            for (; i < count; i++)
+            {
+                const PFubyte *pixel = src + i*4;
+
+                PFubyte r = Pixel_ReduceChannel(pixel[0], 31);
+                PFubyte g = Pixel_ReduceChannel(pixel[1], 63);
+                PFubyte b = Pixel_ReduceChannel(pixel[2], 31);
+
+                ((PFushort*)dst)[i] = (PFushort)r << 11 | (PFushort)g << 5 | (PFushort)b;
+            }
+        }
+        break;
+
+        case PF_PIXELFORMAT_R8G8B8:
+            for (; i < count; i++)
+            {
+                const PFubyte *pixel = src + i*4;
+                out[i*3] = pixel[0], out[i*3 + 1] = pixel[1], out[i*3 + 2] = pixel[2];
+            }
+            break;
+
+        case PF_PIXELFORMAT_B8G8R8:
+            for (; i < count; i++)
+            {
+                const PFubyte *pixel = src + i*4;
+                out[i*3] = pixel[2], out[i*3 + 1] = pixel[1], out[i*3 + 2] = pixel[0];
+            }
+            break;
+
+        case PF_PIXELFORMAT_R8G8B8A8:
+            memcpy(dst, src, count*4);
+            break;
+
+        default:
+        {
+            PFpixelsetter setter = NULL;
+            pfInternal_GetPixelGetterSetter(NULL, &setter, format);
+
+            for (; i < count; i++)
+            {
+                const PFubyte *pixel = src + i*4;
+                setter(dst, i, (PFcolor) { pixel[0], pixel[1], pixel[2], pixel[3] });
+            }
+        }
+        break;
+    }
+}
+
+// NOTE: Swaps the red and blue bytes, from R8G8B8 to B8G8R8 or the other way
+static void Convert_SwapR8G8B8(PFubyte* dst, const PFubyte* src, PFsizei count)
+{
+    for (PFsizei i = 0; i < count*3; i += 3)
+    {
+        dst[i] = src[i + 2], dst[i + 1] = src[i + 1], dst[i + 2] = src[i];
+    }
+}
+
+
+/* Convert API functions */
+
+PFboolean pfConvertPixels(void* dst, PFpixelformat dstFormat, const void* src, PFpixelformat srcFormat, PFsizei count)
+{
+    PFpixelgetter getter = NULL;
+    PFpixelsetter setter = NULL;
+
+    pfInternal_GetPixelGetterSetter(&getter, NULL, srcFormat);
+    pfInternal_GetPixelGetterSetter(NULL, &setter, dstFormat);
+
+    if (!getter || !setter) return PF_FALSE;
+
+    // NOTE: The pixels of the same format are copied as they are, without going through 8 bits
+    if (srcFormat == dstFormat)
+    {
+        memcpy(dst, src, count*pfInternal_GetPixelBytes(srcFormat));
+    }
+    else if (srcFormat == PF_PIXELFORMAT_R8G8B8A8)
+    {
+        Convert_FromR8G8B8A8(dst, dstFormat, (const PFubyte*)src, count);
+    }
+    else if (dstFormat == PF_PIXELFORMAT_R8G8B8A8)
+    {
+        Convert_ToR8G8B8A8((PFubyte*)dst, src, srcFormat, count);
+    }
+    else if ((srcFormat == PF_PIXELFORMAT_R8G8B8 && dstFormat == PF_PIXELFORMAT_B8G8R8) ||
+             (srcFormat == PF_PIXELFORMAT_B8G8R8 && dstFormat == PF_PIXELFORMAT_R8G8B8))
+    {
+        Convert_SwapR8G8B8((PFubyte*)dst, (const PFubyte*)src, count);
+    }
+    else
+    {
+        PFubyte buffer[PF_CONVERT_CHUNK_SIZE*4];
+        PFsizei srcBpp = pfInternal_GetPixelBytes(srcFormat);
+        PFsizei dstBpp = pfInternal_GetPixelBytes(dstFormat);
+
+        for (PFsizei i = 0; i < count; i += PF_CONVERT_CHUNK_SIZE)
+        {
+            PFsizei chunk = MIN(PF_CONVERT_CHUNK_SIZE, count - i);
+            Convert_ToR8G8B8A8(buffer, (const PFubyte*)src + i*srcBpp, srcFormat, chunk);
+            Convert_FromR8G8B8A8((PFubyte*)dst + i*dstBpp, dstFormat, buffer, chunk);
+        }
+    }
+
+    return PF_TRUE;
+}
@@ -19,38 +19,47 @@
 
 #include "internal/context.h"
 #include "internal/config.h"
+#include "internal/depth.h"
 #include "pixelforge.h"
 #include <stdlib.h>
 #include <float.h>
 
+/* Including internal function prototypes */
+
+extern PFboolean pfInternal_FillPixels(PFtexture* texture, PFsizei size, PFcolor color);
+extern void pfInternal_FlushBins(void);
+
 /* Framebuffer functions */
 
 PFframebuffer pfGenFramebuffer(PFsizei width, PFsizei height, PFpixelformat format)
 {
     PFtexture texture = pfGenTextureBuffer(width, height, format);
-    PFframebuffer fb0 = {0,0};
+    PFframebuffer fb0 = {0,0,0};
     if (texture.pixels == NULL) return fb0;
 
     PFsizei size = width*height;
     PFfloat *zbuffer = (PFfloat*)PF_MALLOC(size*sizeof(PFfloat));
+    PFfloat *zbufferMax = (PFfloat*)PF_MALLOC(Depth_TileCount(width, height)*sizeof(PFfloat));
+    PFubyte *zbufferPending = (PFubyte*)PF_MALLOC(Depth_TileCount(width, height));
 
-    if (!zbuffer)
+    if (!zbuffer || !zbufferMax || !zbufferPending)
     {
         if (currentCtx)
         {
             currentCtx->errCode = PF_ERROR_OUT_OF_MEMORY;
         }
 
+        PF_FREE(zbuffer);
+        PF_FREE(zbufferMax);
+        PF_FREE(zbufferPending);
         pfDeleteTexture(&texture);
         return fb0;
     }
 
-    for (PFsizei i = 0; i < size; i++)
-    {
-        zbuffer[i] = FLT_MAX;
-    }
+    PFframebuffer framebuffer = { texture, zbuffer, zbufferMax, zbufferPending };
+    Depth_Clear(&framebuffer, FLT_MAX);
 
-    return (PFframebuffer) { texture, zbuffer };
+    return framebuffer;
 }
 
 void pfDeleteFramebuffer(PFframebuffer* framebuffer)
@@ -64,6 +73,18 @@ void pfDeleteFramebuffer(PFframebuffer* framebuffer)
             PF_FREE(framebuffer->zbuffer);
             framebuffer->zbuffer = NULL;
         }
+
+        if (framebuffer->zbufferMax)
+        {
+            PF_FREE(framebuffer->zbufferMax);
+            framebuffer->zbufferMax = NULL;
+        }
+
+        if (framebuffer->zbufferPending)
+        {
+            PF_FREE(framebuffer->zbufferPending);
+            framebuffer->zbufferPending = NULL;
+        }
     }
 }
 
@@ -75,31 +96,50 @@ PFboolean pfIsValidFramebuffer(PFframebuffer* framebuffer)
 
 void pfClearFramebuffer(PFframebuffer* framebuffer, PFcolor color, PFfloat depth)
 {
+    pfInternal_FlushBins();
+
     PFsizei size = framebuffer->texture.width*framebuffer->texture.height;
 
-#   ifdef PF_SUPPORT_OPENMP
-#       pragma omp parallel for \
-            if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
-#   endif
-    for (PFsizei i = 0; i < size; i++)
+    if (!pfInternal_FillPixels(&framebuffer->texture, size, color))
     {
-        framebuffer->texture.pixelSetter(framebuffer->texture.pixels, i, color);
-        framebuffer->zbuffer[i] = depth;
+#       ifdef PF_SUPPORT_OPENMP
+#           pragma omp parallel for \
+                if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#       endif
+        for (PFsizei i = 0; i < size; i++)
+        {
+            framebuffer->texture.pixelSetter(framebuffer->texture.pixels, i, color);
+        }
     }
+
+    Depth_Clear(framebuffer, depth);
 }
 
 PFcolor pfGetFramebufferPixel(const PFframebuffer* framebuffer, PFsizei x, PFsizei y)
 {
+    pfInternal_FlushBins();
     return framebuffer->texture.pixelGetter(framebuffer->texture.pixels, y*framebuffer->texture.width + x);;
 }
 
 PFfloat pfGetFramebufferDepth(const PFframebuffer* framebuffer, PFsizei x, PFsizei y)
 {
+    pfInternal_FlushBins();
+
+    if (Depth_IsLazy(framebuffer))
+    {
+        PFsizei index = (y/PF_DEPTH_TILE_SIZE)*Depth_TilesPerRow(framebuffer->texture.width) + x/PF_DEPTH_TILE_SIZE;
+        if (framebuffer->zbufferPending[index]) return framebuffer->zbufferMax[index];
+    }
+
     return framebuffer->zbuffer[y*framebuffer->texture.width + x];
 }
 
 void pfSetFramebufferPixelDepthTest(PFframebuffer* framebuffer, PFsizei x, PFsizei y, PFfloat z, PFcolor color, PFdepthfunc depthFunc)
 {
+    pfInternal_FlushBins();
+
+    Depth_ResolveTile(framebuffer, x, y);
+
     PFsizei offset = y*framebuffer->texture.width + x;
     PFfloat *zp = framebuffer->zbuffer + offset;
 
@@ -107,18 +147,30 @@ void pfSetFramebufferPixelDepthTest(PFframebuffer* framebuffer, PFsizei x, PFsiz
     {
         framebuffer->texture.pixelSetter(framebuffer->texture.pixels, offset, color);
         *zp = z;
+
+        if (!Depth_IsLessTest(depthFunc))
+        {
+            Depth_RaiseTile(framebuffer, x, y, z);
+        }
     }
 }
 
 void pfSetFramebufferPixelDepth(PFframebuffer* framebuffer, PFsizei x, PFsizei y, PFfloat z, PFcolor color)
 {
+    pfInternal_FlushBins();
+
+    Depth_ResolveTile(framebuffer, x, y);
+
     PFsizei offset = y*framebuffer->texture.width + x;
 
     framebuffer->texture.pixelSetter(framebuffer->texture.pixels, offset, color);
     framebuffer->zbuffer[offset] = z;
+
+    Depth_RaiseTile(framebuffer, x, y, z);
 }
 
 void pfSetFramebufferPixel(PFframebuffer* framebuffer, PFsizei x, PFsizei y, PFcolor color)
 {
+    pfInternal_FlushBins();
     framebuffer->texture.pixelSetter(framebuffer->texture.pixels, y*framebuffer->texture.width + x, color);
 }
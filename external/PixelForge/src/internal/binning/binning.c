@@ -0,0 +1,382 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#include "./binning.h"
+
+#ifdef PF_SUPPORT_BINNED_RASTER
+
+#include "../primitives/triangles/triangles.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Internal types */
+
+typedef struct {
+    PFvertex v1, v2, v3;                ///< Projected and clipped vertices of the triangle
+    PFMvec3 viewPos;                    ///< View position used for lighting
+    PFint bounds[4];                    ///< Screen bounding box given by 'Rasterize_TriangleBounds'
+    PFface faceToRender;                ///< Face the triangle was processed for
+    PFboolean is3D;                     ///< Whether the triangle went through the perspective division
+} PFbintriangle;
+
+typedef struct {
+    PFuint *triangles;                  ///< Indices of the triangles overlapping the tile, in submission order
+    PFsizei count;                      ///< Number of indices stored in the bin
+    PFsizei capacity;                   ///< Number of indices the bin can hold before growing
+} PFbin;
+
+struct PFbinner {
+    PFctx *ctx;                         ///< Context owning the binner, its state is used while rasterizing
+
+    PFbintriangle *triangles;           ///< Triangles waiting to be rasterized (at most PF_BIN_MAX_TRIANGLES)
+    PFsizei triangleCount;              ///< Number of triangles waiting to be rasterized
+
+    PFbin *bins;                        ///< One bin per screen tile, row by row
+    PFsizei binCount;                   ///< Number of allocated bins
+    PFint tilesX, tilesY;               ///< Dimensions in tiles of the framebuffer being binned
+
+    pthread_t *workers;                 ///< Worker threads rasterizing the tiles
+    PFsizei workerCount;                ///< Number of running worker threads
+
+    pthread_mutex_t mutex;              ///< Protects all the members below
+    pthread_cond_t startCond;           ///< Signaled when a new flush starts
+    pthread_cond_t doneCond;            ///< Signaled when the last worker is done with the current flush
+    PFuint generation;                  ///< Incremented on every flush, tells workers there is work to do
+    PFsizei nextTile;                   ///< Next tile to be taken by a thread during a flush
+    PFsizei pendingWorkers;             ///< Workers that did not finish the current flush yet
+    PFboolean quit;                     ///< Asks the workers to exit
+};
+
+/* Internal helper function declarations */
+
+static void* Binning_WorkerMain(void* arg);
+static void Binning_WorkTiles(PFbinner* binner);
+static void Binning_RasterizeTile(PFbinner* binner, PFsizei tile);
+static PFboolean Binning_SetupTiles(PFbinner* binner);
+static PFboolean Binning_ReserveBin(PFbin* bin);
+
+/* Binner management functions */
+
+PFbinner* Binning_Create(PFctx* ctx)
+{
+    PFbinner *binner = (PFbinner*)PF_CALLOC(1, sizeof(PFbinner));
+    if (!binner) return NULL;
+
+    binner->ctx = ctx;
+    binner->triangles = (PFbintriangle*)PF_MALLOC(PF_BIN_MAX_TRIANGLES*sizeof(PFbintriangle));
+
+    if (!binner->triangles)
+    {
+        PF_FREE(binner);
+        return NULL;
+    }
+
+    pthread_mutex_init(&binner->mutex, NULL);
+    pthread_cond_init(&binner->startCond, NULL);
+    pthread_cond_init(&binner->doneCond, NULL);
+
+    /* Start the worker threads */
+
+    long workerCount = PF_BIN_WORKER_COUNT;
+
+    if (workerCount <= 0)
+    {
+        workerCount = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    }
+
+    if (workerCount > 0)
+    {
+        binner->workers = (pthread_t*)PF_MALLOC(workerCount*sizeof(pthread_t));
+
+        for (long i = 0; binner->workers && i < workerCount; i++)
+        {
+            if (pthread_create(&binner->workers[i], NULL, Binning_WorkerMain, binner) != 0) break;
+            binner->workerCount++;
+        }
+    }
+
+    return binner;
+}
+
+void Binning_Delete(PFbinner* binner)
+{
+    if (!binner) return;
+
+    pthread_mutex_lock(&binner->mutex);
+    binner->quit = PF_TRUE;
+    pthread_cond_broadcast(&binner->startCond);
+    pthread_mutex_unlock(&binner->mutex);
+
+    for (PFsizei i = 0; i < binner->workerCount; i++)
+    {
+        pthread_join(binner->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&binner->doneCond);
+    pthread_cond_destroy(&binner->startCond);
+    pthread_mutex_destroy(&binner->mutex);
+
+    for (PFsizei i = 0; i < binner->binCount; i++)
+    {
+        PF_FREE(binner->bins[i].triangles);
+    }
+
+    PF_FREE(binner->bins);
+    PF_FREE(binner->workers);
+    PF_FREE(binner->triangles);
+    PF_FREE(binner);
+}
+
+/* Binning functions */
+
+void Binning_PushTriangle(PFbinner* binner, PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos)
+{
+    PFint bounds[4];
+
+    if (!Rasterize_TriangleBounds(faceToRender, v1, v2, v3, bounds))
+    {
+        return;
+    }
+
+    /* Make room for the triangle, the tile grid is set up by the first triangle of each batch */
+
+    if (binner->triangleCount == PF_BIN_MAX_TRIANGLES)
+    {
+        Binning_Flush(binner);
+    }
+
+    if (binner->triangleCount == 0 && !Binning_SetupTiles(binner))
+    {
+        Rasterize_TriangleRect(faceToRender, is3D, v1, v2, v3, viewPos, bounds);
+        return;
+    }
+
+    /* Get the range of tiles overlapped by the bounding box */
+
+    PFint txMin = MAX(bounds[0], 0)/PF_BIN_TILE_SIZE;
+    PFint tyMin = MAX(bounds[1], 0)/PF_BIN_TILE_SIZE;
+    PFint txMax = MIN(bounds[2]/PF_BIN_TILE_SIZE, binner->tilesX - 1);
+    PFint tyMax = MIN(bounds[3]/PF_BIN_TILE_SIZE, binner->tilesY - 1);
+
+    if (txMin > txMax || tyMin > tyMax) return;
+
+    /* Make sure every bin can take the triangle before adding it anywhere */
+
+    for (PFint ty = tyMin; ty <= tyMax; ty++)
+    {
+        for (PFint tx = txMin; tx <= txMax; tx++)
+        {
+            if (!Binning_ReserveBin(&binner->bins[ty*binner->tilesX + tx]))
+            {
+                // NOTE: Out of memory, we draw everything we have and this triangle immediately
+                Binning_Flush(binner);
+                Rasterize_TriangleRect(faceToRender, is3D, v1, v2, v3, viewPos, bounds);
+                return;
+            }
+        }
+    }
+
+    /* Store the triangle and add it to the bins */
+
+    PFuint index = binner->triangleCount++;
+    PFbintriangle *triangle = &binner->triangles[index];
+
+    triangle->v1 = *v1, triangle->v2 = *v2, triangle->v3 = *v3;
+    memcpy(triangle->viewPos, viewPos, sizeof(PFMvec3));
+    memcpy(triangle->bounds, bounds, sizeof(bounds));
+    triangle->faceToRender = faceToRender;
+    triangle->is3D = is3D;
+
+    for (PFint ty = tyMin; ty <= tyMax; ty++)
+    {
+        for (PFint tx = txMin; tx <= txMax; tx++)
+        {
+            PFbin *bin = &binner->bins[ty*binner->tilesX + tx];
+            bin->triangles[bin->count++] = index;
+        }
+    }
+}
+
+void Binning_Flush(PFbinner* binner)
+{
+    if (binner->triangleCount == 0) return;
+
+    // NOTE: The rasterizer reads its state from 'currentCtx', we make sure
+    //       it points to the binner context while the tiles are processed.
+    PFctx *prevCtx = currentCtx;
+    currentCtx = binner->ctx;
+
+    /* Wake up the workers, then take tiles ourselves until there are none left */
+
+    pthread_mutex_lock(&binner->mutex);
+    binner->nextTile = 0;
+    binner->pendingWorkers = binner->workerCount;
+    binner->generation++;
+    pthread_cond_broadcast(&binner->startCond);
+    pthread_mutex_unlock(&binner->mutex);
+
+    Binning_WorkTiles(binner);
+
+    pthread_mutex_lock(&binner->mutex);
+    while (binner->pendingWorkers > 0)
+    {
+        pthread_cond_wait(&binner->doneCond, &binner->mutex);
+    }
+    pthread_mutex_unlock(&binner->mutex);
+
+    currentCtx = prevCtx;
+
+    /* Empty the bins */
+
+    for (PFint i = 0; i < binner->tilesX*binner->tilesY; i++)
+    {
+        binner->bins[i].count = 0;
+    }
+
+    binner->triangleCount = 0;
+}
+
+/* Internal helper function definitions */
+
+void* Binning_WorkerMain(void* arg)
+{
+    PFbinner *binner = (PFbinner*)arg;
+    PFuint generation = 0;
+
+    // NOTE: The rasterizer reads its state from 'currentCtx'. A worker only binds the
+    //       context of its binner to its own copy, when 'currentCtx' is shared by all
+    //       threads it is already the binner context during a flush (see 'Binning_Flush').
+#ifdef PF_CTX_THREAD_LOCAL
+    currentCtx = binner->ctx;
+#endif //PF_CTX_THREAD_LOCAL
+
+    pthread_mutex_lock(&binner->mutex);
+
+    for (;;)
+    {
+        while (!binner->quit && binner->generation == generation)
+        {
+            pthread_cond_wait(&binner->startCond, &binner->mutex);
+        }
+
+        if (binner->quit) break;
+
+        generation = binner->generation;
+        pthread_mutex_unlock(&binner->mutex);
+
+        Binning_WorkTiles(binner);
+
+        pthread_mutex_lock(&binner->mutex);
+
+        if (--binner->pendingWorkers == 0)
+        {
+            pthread_cond_signal(&binner->doneCond);
+        }
+    }
+
+    pthread_mutex_unlock(&binner->mutex);
+
+    return NULL;
+}
+
+void Binning_WorkTiles(PFbinner* binner)
+{
+    const PFsizei tileCount = binner->tilesX*binner->tilesY;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&binner->mutex);
+        PFsizei tile = binner->nextTile++;
+        pthread_mutex_unlock(&binner->mutex);
+
+        if (tile >= tileCount) break;
+
+        Binning_RasterizeTile(binner, tile);
+    }
+}
+
+void Binning_RasterizeTile(PFbinner* binner, PFsizei tile)
+{
+    const PFbin *bin = &binner->bins[tile];
+
+    const PFint xTile = (tile % binner->tilesX)*PF_BIN_TILE_SIZE;
+    const PFint yTile = (tile / binner->tilesX)*PF_BIN_TILE_SIZE;
+
+    // NOTE: Each tile is owned by a single thread and its triangles are drawn
+    //       in submission order, so blending and depth testing give the same
+    //       result as the immediate path.
+    for (PFsizei i = 0; i < bin->count; i++)
+    {
+        const PFbintriangle *triangle = &binner->triangles[bin->triangles[i]];
+
+        PFint bounds[4] = {
+            MAX(triangle->bounds[0], xTile),
+            MAX(triangle->bounds[1], yTile),
+            MIN(triangle->bounds[2], xTile + PF_BIN_TILE_SIZE - 1),
+            MIN(triangle->bounds[3], yTile + PF_BIN_TILE_SIZE - 1)
+        };
+
+        Rasterize_TriangleRect(triangle->faceToRender, triangle->is3D,
+            &triangle->v1, &triangle->v2, &triangle->v3, triangle->viewPos, bounds);
+    }
+}
+
+PFboolean Binning_SetupTiles(PFbinner* binner)
+{
+    const PFtexture *target = &binner->ctx->currentFramebuffer->texture;
+
+    PFint tilesX = (target->width + PF_BIN_TILE_SIZE - 1)/PF_BIN_TILE_SIZE;
+    PFint tilesY = (target->height + PF_BIN_TILE_SIZE - 1)/PF_BIN_TILE_SIZE;
+    PFsizei binCount = tilesX*tilesY;
+
+    if (binCount > binner->binCount)
+    {
+        PFbin *bins = (PFbin*)PF_REALLOC(binner->bins, binCount*sizeof(PFbin));
+        if (!bins) return PF_FALSE;
+
+        memset(bins + binner->binCount, 0, (binCount - binner->binCount)*sizeof(PFbin));
+        binner->bins = bins;
+        binner->binCount = binCount;
+    }
+
+    binner->tilesX = tilesX;
+    binner->tilesY = tilesY;
+
+    return PF_TRUE;
+}
+
+PFboolean Binning_ReserveBin(PFbin* bin)
+{
+    if (bin->count < bin->capacity) return PF_TRUE;
+
+    PFsizei capacity = bin->capacity ? 2*bin->capacity : 64;
+    PFuint *triangles = (PFuint*)PF_REALLOC(bin->triangles, capacity*sizeof(PFuint));
+    if (!triangles) return PF_FALSE;
+
+    bin->triangles = triangles;
+    bin->capacity = capacity;
+
+    return PF_TRUE;
+}
+
+#endif //PF_SUPPORT_BINNED_RASTER
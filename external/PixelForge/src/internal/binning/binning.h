@@ -0,0 +1,39 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#ifndef PF_BINNING_H
+#define PF_BINNING_H
+
+#include "../context.h"
+#include "../config.h"
+
+#ifdef PF_SUPPORT_BINNED_RASTER
+
+typedef struct PFbinner PFbinner;
+
+PFbinner* Binning_Create(PFctx* ctx);
+void Binning_Delete(PFbinner* binner);
+
+void Binning_PushTriangle(PFbinner* binner, PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos);
+void Binning_Flush(PFbinner* binner);
+
+#endif //PF_SUPPORT_BINNED_RASTER
+
+#endif //PF_BINNING_H
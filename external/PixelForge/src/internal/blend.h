@@ -0,0 +1,259 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you
+ *  wrote the original software. If you use this software in a product, an acknowledgment
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_BLEND_H
+#define PF_BLEND_H
+
+#include "./context.h"
+#include "./pixel.h"
+#include "./simd.h"
+
+#include <string.h>
+
+/*
+    Alpha blending kernels.
+
+    When 'pfBlendAlpha' or 'pfBlendPremultiplied' is the current blend function
+    and the framebuffer format can be accessed directly (see 'pixel.h'), the
+    rasterizers blend their fragments with these kernels instead of calling it
+    through 'PFctx.blendFunction' for each pixel. The barycentric rasterizer
+    gives them whole blocks of fragments, which are blended four pixels at once
+    with SSE2 in the RGBA framebuffers.
+
+    With straight alpha, every channel is computed as round((s*a + d*(255 - a))/255),
+    and with premultiplied alpha as s + round(d*(255 - a)/255) (saturated), with
+    integer math, the same as the blend functions, so the kernels and the functions
+    give exactly the same pixels. Opaque fragments replace the pixel, transparent
+    ones (whose channels are all zero when premultiplied) leave it untouched, so
+    they are copied or skipped.
+*/
+
+#if defined(PF_SIMD_SSE2) || defined(PF_SIMD_AVX2)
+#   define PF_BLEND_SSE2
+#endif
+
+typedef enum {
+    PF_BLEND_KERNEL_NONE = 0,           ///< The blend function is called for each fragment
+    PF_BLEND_KERNEL_ALPHA,              ///< 'pfBlendAlpha'
+    PF_BLEND_KERNEL_PREMULTIPLIED       ///< 'pfBlendPremultiplied'
+} PFblendkernel;
+
+// NOTE: 'blendFunction' is NULL when blending is disabled, 'directFormat' is given by 'pfInternal_GetDirectPixelFormat'
+static inline PFblendkernel Blend_GetKernel(PFblendfunc blendFunction, PFpixelformat directFormat)
+{
+    if (directFormat == PF_PIXELFORMAT_UNKNOWN) return PF_BLEND_KERNEL_NONE;
+    if (blendFunction == pfBlendAlpha) return PF_BLEND_KERNEL_ALPHA;
+    if (blendFunction == pfBlendPremultiplied) return PF_BLEND_KERNEL_PREMULTIPLIED;
+    return PF_BLEND_KERNEL_NONE;
+}
+
+/* Scalar kernels */
+
+// NOTE: Rounded division by 255, exact for 'x' up to 255*255
+static inline PFubyte Blend_Div255(PFuint x)
+{
+    x += 128;
+    return (PFubyte)((x + (x >> 8)) >> 8);
+}
+
+static inline PFubyte Blend_AlphaChannel(PFuint source, PFuint destination, PFuint alpha)
+{
+    return Blend_Div255(source*alpha + destination*(255 - alpha));
+}
+
+static inline PFubyte Blend_PremultipliedChannel(PFuint source, PFuint destination, PFuint alpha)
+{
+    return (PFubyte)MIN_255((PFint)(source + Blend_Div255(destination*(255 - alpha))));
+}
+
+static inline PFcolor Blend_Alpha(PFcolor source, PFcolor destination)
+{
+    PFuint alpha = source.a;
+
+    return (PFcolor) {
+        Blend_AlphaChannel(source.r, destination.r, alpha),
+        Blend_AlphaChannel(source.g, destination.g, alpha),
+        Blend_AlphaChannel(source.b, destination.b, alpha),
+        Blend_AlphaChannel(255, destination.a, alpha)
+    };
+}
+
+static inline PFcolor Blend_Premultiplied(PFcolor source, PFcolor destination)
+{
+    PFuint alpha = source.a;
+
+    return (PFcolor) {
+        Blend_PremultipliedChannel(source.r, destination.r, alpha),
+        Blend_PremultipliedChannel(source.g, destination.g, alpha),
+        Blend_PremultipliedChannel(source.b, destination.b, alpha),
+        Blend_PremultipliedChannel(source.a, destination.a, alpha)
+    };
+}
+
+// NOTE: Returns true if the fragment leaves the pixel untouched
+static inline PFboolean Blend_IsTransparent(PFcolor color, PFblendkernel kernel)
+{
+    return kernel == PF_BLEND_KERNEL_ALPHA ? color.a == 0
+        : (color.r | color.g | color.b | color.a) == 0;
+}
+
+static inline PFcolor Blend_Color(PFcolor source, PFcolor destination, PFblendkernel kernel)
+{
+    if (source.a == 255) return source;
+
+    return kernel == PF_BLEND_KERNEL_ALPHA
+        ? Blend_Alpha(source, destination)
+        : Blend_Premultiplied(source, destination);
+}
+
+// NOTE: 'directFormat' must be one given by 'pfInternal_GetDirectPixelFormat', other than unknown
+static inline void Blend_Pixel(void* pixels, PFpixelformat directFormat, PFsizei offset, PFcolor color, PFblendkernel kernel)
+{
+    if (Blend_IsTransparent(color, kernel)) return;
+
+    switch (directFormat)
+    {
+        case PF_PIXELFORMAT_R5G6B5:
+            Pixel_SetR5G6B5(pixels, offset, Blend_Color(color, Pixel_GetR5G6B5(pixels, offset), kernel));
+            break;
+
+        case PF_PIXELFORMAT_R8G8B8:
+            Pixel_SetR8G8B8(pixels, offset, Blend_Color(color, Pixel_GetR8G8B8(pixels, offset), kernel));
+            break;
+
+        case PF_PIXELFORMAT_B8G8R8:
+            Pixel_SetB8G8R8(pixels, offset, Blend_Color(color, Pixel_GetB8G8R8(pixels, offset), kernel));
+            break;
+
+        case PF_PIXELFORMAT_R8G8B8A8:
+            Pixel_SetR8G8B8A8(pixels, offset, Blend_Color(color, Pixel_GetR8G8B8A8(pixels, offset), kernel));
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Block kernels */
+
+#ifdef PF_BLEND_SSE2
+
+// NOTE: Same operations as 'Blend_AlphaChannel' on the 16 bit channels of two RGBA pixels
+static inline __m128i Blend_AlphaSSE2(__m128i source, __m128i destination)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+    // The alpha channel of the source counts as 255, as in 'Blend_Alpha'
+    source = _mm_or_si128(source, _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(source, alpha), _mm_mullo_epi16(destination, invAlpha));
+    sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+}
+
+// NOTE: Destination part of 'Blend_PremultipliedChannel' on the 16 bit channels of two RGBA pixels
+static inline __m128i Blend_PremultipliedSSE2(__m128i source, __m128i destination)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(destination, invAlpha), _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+}
+
+// NOTE: Blends four RGBA pixels, the pixels outside of 'mask' are neither read nor written
+static inline void Blend_QuadR8G8B8A8(PFubyte* pixels, const PFcolor colors[4], PFuint mask, PFblendkernel kernel)
+{
+    __m128i source = _mm_loadu_si128((const __m128i*)colors);
+
+    // Bits of the bytes of the pixels in the mask, and of their alpha bytes only
+    PFuint pixelBits = (mask & 1)*0xF | (mask & 2)*0x78 | (mask & 4)*0x3C0 | (mask & 8)*0x1E00;
+    PFuint alphaBits = pixelBits & 0x8888;
+
+    PFuint zero = (PFuint)_mm_movemask_epi8(_mm_cmpeq_epi8(source, _mm_setzero_si128()));
+    PFuint transparentBits = (kernel == PF_BLEND_KERNEL_ALPHA) ? alphaBits : pixelBits;
+    if ((zero & transparentBits) == transparentBits) return;
+
+    PFuint opaque = (PFuint)_mm_movemask_epi8(_mm_cmpeq_epi8(source, _mm_set1_epi8(-1)));
+
+    PFuint words[4];
+
+    if (mask == 0xF) memcpy(words, pixels, 16);
+    else for (PFint i = 0; i < 4; i++) if (mask & (1u << i)) memcpy(&words[i], pixels + 4*i, 4);
+
+    __m128i result = source;
+
+    if ((opaque & alphaBits) != alphaBits)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i destination = _mm_loadu_si128((const __m128i*)words);
+
+        __m128i srcLo = _mm_unpacklo_epi8(source, zero), srcHi = _mm_unpackhi_epi8(source, zero);
+        __m128i dstLo = _mm_unpacklo_epi8(destination, zero), dstHi = _mm_unpackhi_epi8(destination, zero);
+
+        if (kernel == PF_BLEND_KERNEL_ALPHA)
+        {
+            result = _mm_packus_epi16(Blend_AlphaSSE2(srcLo, dstLo), Blend_AlphaSSE2(srcHi, dstHi));
+        }
+        else
+        {
+            __m128i scaled = _mm_packus_epi16(Blend_PremultipliedSSE2(srcLo, dstLo), Blend_PremultipliedSSE2(srcHi, dstHi));
+            result = _mm_adds_epu8(source, scaled);
+        }
+    }
+
+    _mm_storeu_si128((__m128i*)words, result);
+
+    if (mask == 0xF) memcpy(pixels, words, 16);
+    else for (PFint i = 0; i < 4; i++) if (mask & (1u << i)) memcpy(pixels + 4*i, &words[i], 4);
+}
+
+#endif //PF_BLEND_SSE2
+
+#ifdef PF_SIMD_WIDTH
+
+// NOTE: Blends the fragments 'colors[i]' of a block of the barycentric rasterizer with the
+//       pixels 'offset + i', for each bit 'i' set in 'mask'
+static inline void Blend_Block(void* pixels, PFpixelformat directFormat, PFsizei offset, const PFcolor colors[PF_SIMD_WIDTH], PFuint mask, PFblendkernel kernel)
+{
+#ifdef PF_BLEND_SSE2
+    if (directFormat == PF_PIXELFORMAT_R8G8B8A8)
+    {
+        for (PFint i = 0; i < PF_SIMD_WIDTH; i += 4)
+        {
+            PFuint quadMask = (mask >> i) & 0xF;
+            if (quadMask) Blend_QuadR8G8B8A8((PFubyte*)pixels + (offset + i)*4, colors + i, quadMask, kernel);
+        }
+
+        return;
+    }
+#endif //PF_BLEND_SSE2
+
+    for (PFint i = 0; mask; i++, mask >>= 1)
+    {
+        if (mask & 1) Blend_Pixel(pixels, directFormat, offset + i, colors[i], kernel);
+    }
+}
+
+#endif //PF_SIMD_WIDTH
+
+#endif //PF_BLEND_H
@@ -21,9 +21,10 @@
 #define PF_CONFIG_H
 
 //#define PF_SCANLINES_RASTER_METHOD    // Performs triangle rasterization using scanline rather than barycentric method
-//#define PF_SUPPORT_NO_POT_TEXTURE     // Allows fetching samples from texcoords on non-power-of-two textures
 //#define PF_PHONG_REFLECTION           // Disable the Blinn-Phong reflection model for Phong
-//#define PF_GOURAUD_SHADING            // Enable vertex shading for lighting instead of per-fragment shading
+//#define PF_GOURAUD_SHADING            // Enables PF_VERTEX_LIGHTING by default (lighting per vertex instead of per fragment)
+//#define PF_SUPPORT_BINNED_RASTER      // Defers triangles into screen tiles rasterized by a pool of worker threads (needs pthreads)
+//#define PF_NO_SIMD                    // Disables the SSE2/AVX2/NEON block kernel of the barycentric rasterizer
 
 #ifndef PF_MAX_PROJECTION_STACK_SIZE
 #   define PF_MAX_PROJECTION_STACK_SIZE 2
@@ -41,6 +42,22 @@
 #   define PF_MAX_LIGHT_STACK 8
 #endif //PF_MAX_LIGHT_STACK
 
+//  Number of intervals of the tables of specular powers used instead of 'powf' by the lighting
+//  NOTE: The powers are linearly interpolated between the entries of the table
+#ifndef PF_SPECULAR_TABLE_SIZE
+#   define PF_SPECULAR_TABLE_SIZE 512
+#endif //PF_SPECULAR_TABLE_SIZE
+
+//  Maximum number of levels of a texture used by the sampler, enough for 32768x32768 textures
+#ifndef PF_MAX_TEXTURE_LEVELS
+#   define PF_MAX_TEXTURE_LEVELS 16
+#endif //PF_MAX_TEXTURE_LEVELS
+
+//  Log2 of the number of texels on each side of the blocks of the tiled textures (2: 4x4 texels, 64 bytes in RGBA)
+#ifndef PF_TEXTURE_TILE_BITS
+#   define PF_TEXTURE_TILE_BITS 2
+#endif //PF_TEXTURE_TILE_BITS
+
 #ifndef PF_MAX_CLIPPED_POLYGON_VERTICES
 #   define PF_MAX_CLIPPED_POLYGON_VERTICES 12
 #endif //PF_MAX_CLIPPED_POLYGON_VERTICES
@@ -53,6 +70,52 @@
 #   define PF_CLIP_EPSILON 1e-5f
 #endif //PF_CLIP_EPSILON
 
+//  Number of entries of the post-transform vertex cache used by 'pfDrawElements'
+//  NOTE: Must be a power of two, the cache is indexed with the low bits of the vertex index
+#ifndef PF_VERTEX_CACHE_SIZE
+#   define PF_VERTEX_CACHE_SIZE 32
+#endif //PF_VERTEX_CACHE_SIZE
+
+//  Number of vertices fetched and transformed at once by 'pfDrawArrays' (see 'internal/transform')
+//  NOTE: Must be a multiple of 8, the SIMD kernels process the batches by blocks of 4 or 8 vertices
+#ifndef PF_VERTEX_BATCH_SIZE
+#   define PF_VERTEX_BATCH_SIZE 256
+#endif //PF_VERTEX_BATCH_SIZE
+
+//  Largest absolute screen coordinate of the vertices of a triangle not clipped against the sides
+//  of the viewport (guard band, see 'Process_ClipAndProjectTriangle')
+//  NOTE: The edge functions of the rasterizer grow with the width times the height of the triangles
+//        in sub-pixels, with 4 bits of sub-pixel precision they fit in 32 bits up to 4096 pixels
+#ifndef PF_GUARD_BAND_SIZE
+#   define PF_GUARD_BAND_SIZE 2048
+#endif //PF_GUARD_BAND_SIZE
+
+//  Number of fractional bits of the fixed-point screen coordinates of the triangle rasterizer
+#ifndef PF_SUBPIXEL_BITS
+#   define PF_SUBPIXEL_BITS 4
+#endif //PF_SUBPIXEL_BITS
+
+//  Width and height in pixels of the blocks of the coarse depth buffer (see 'internal/depth.h')
+#ifndef PF_DEPTH_TILE_SIZE
+#   define PF_DEPTH_TILE_SIZE 8
+#endif //PF_DEPTH_TILE_SIZE
+
+//  Maximum number of separate rectangles in the damage region of the main framebuffer (see 'internal/damage.h')
+#ifndef PF_MAX_DAMAGE_RECTS
+#   define PF_MAX_DAMAGE_RECTS 8
+#endif //PF_MAX_DAMAGE_RECTS
+
+//  Number of columns whose source pixels are looked up in a table at once by 'pfDrawPixels' (see 'internal/primitives/pixels')
+#ifndef PF_BLIT_SPAN_SIZE
+#   define PF_BLIT_SPAN_SIZE 256
+#endif //PF_BLIT_SPAN_SIZE
+
+//  Number of pixels converted at once through an RGBA buffer on the stack by 'pfConvertPixels'
+//  when neither format is R8G8B8A8
+#ifndef PF_CONVERT_CHUNK_SIZE
+#   define PF_CONVERT_CHUNK_SIZE 256
+#endif //PF_CONVERT_CHUNK_SIZE
+
 #ifdef PF_SUPPORT_OPENMP
 
 //  Pixel threshold for parallelizing the rasterization loop
@@ -71,4 +134,33 @@
 
 #endif //PF_SUPPORT_OPENMP
 
+#ifdef PF_SUPPORT_BINNED_RASTER
+
+#   ifdef PF_SCANLINES_RASTER_METHOD
+#       error "PF_SUPPORT_BINNED_RASTER is only implemented for the barycentric raster method"
+#   endif //PF_SCANLINES_RASTER_METHOD
+
+//  Width and height in pixels of the screen tiles triangles are binned into
+#   ifndef PF_BIN_TILE_SIZE
+#       define PF_BIN_TILE_SIZE 64
+#   endif //PF_BIN_TILE_SIZE
+
+//  NOTE: The coarse depth blocks must not straddle two tiles, they are updated by the thread owning the tile
+#   if PF_BIN_TILE_SIZE % PF_DEPTH_TILE_SIZE != 0
+#       error "PF_BIN_TILE_SIZE must be a multiple of PF_DEPTH_TILE_SIZE"
+#   endif
+
+//  Number of worker threads rasterizing the tiles (the flushing thread also takes tiles)
+//  NOTE: 0 means one worker per online processor minus the flushing thread
+#   ifndef PF_BIN_WORKER_COUNT
+#       define PF_BIN_WORKER_COUNT 0
+#   endif //PF_BIN_WORKER_COUNT
+
+//  Maximum number of triangles waiting in the bins before they are flushed implicitly
+#   ifndef PF_BIN_MAX_TRIANGLES
+#       define PF_BIN_MAX_TRIANGLES 16384
+#   endif //PF_BIN_MAX_TRIANGLES
+
+#endif //PF_SUPPORT_BINNED_RASTER
+
 #endif //PF_CONFIG_H
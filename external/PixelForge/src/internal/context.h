@@ -58,8 +58,27 @@ typedef struct {
     PFMvec3 normal;                     ///< Normal vector
     PFMvec2 texcoord;                   ///< Texture coordinates
     PFcolor color;                      ///< Color
+    PFubyte clipCode;                   ///< Planes of the view frustum outside of which is 'homogeneous' (see 'Transform_ClassifyVertex')
 } PFvertex;
 
+/**
+ * @brief Structure-of-arrays scratch buffers of the bulk vertex transform of 'pfDrawArrays' (see 'internal/transform').
+ */
+typedef struct {
+    PFfloat px[PF_VERTEX_BATCH_SIZE];           ///< Positions, as fetched from the vertex array
+    PFfloat py[PF_VERTEX_BATCH_SIZE];
+    PFfloat pz[PF_VERTEX_BATCH_SIZE];
+    PFfloat pw[PF_VERTEX_BATCH_SIZE];
+    PFfloat hx[PF_VERTEX_BATCH_SIZE];           ///< Homogeneous coordinates, positions transformed by 'matMVP'
+    PFfloat hy[PF_VERTEX_BATCH_SIZE];
+    PFfloat hz[PF_VERTEX_BATCH_SIZE];
+    PFfloat hw[PF_VERTEX_BATCH_SIZE];
+    PFfloat nx[PF_VERTEX_BATCH_SIZE];           ///< Normals, transformed by 'matNormal' and normalized with lighting
+    PFfloat ny[PF_VERTEX_BATCH_SIZE];
+    PFfloat nz[PF_VERTEX_BATCH_SIZE];
+    PFubyte clipCodes[PF_VERTEX_BATCH_SIZE];    ///< Frustum classification of each vertex
+} PFvertexbatch;
+
 /**
  * @brief Structure representing a light source.
  */
@@ -75,6 +94,7 @@ struct PFlight {
     PFcolor ambient;                    ///< Ambient color of the light
     PFcolor diffuse;                    ///< Diffuse color of the light
     PFcolor specular;                   ///< Specular color of the light
+    PFboolean directional;              ///< True if the light only has a direction (see PF_DIRECTION)
     PFlight *next;                      ///< Pointer to the next light in a linked list
 };
 
@@ -89,6 +109,76 @@ typedef struct {
     PFfloat shininess;                  ///< Material shininess coefficient
 } PFmaterial;
 
+/**
+ * @brief Mipmap levels used by a sampler (see 'internal/sampler.h').
+ */
+typedef enum {
+    PF_MIPMAP_NONE,                     ///< Only the first level is sampled
+    PF_MIPMAP_NEAREST,                  ///< The level nearest to the level of detail is sampled
+    PF_MIPMAP_LINEAR                    ///< The two levels around the level of detail are sampled and blended
+} PFmipmapmode;
+
+/**
+ * @brief Structure representing a level of a texture prepared for sampling.
+ */
+typedef struct {
+    const void *pixels;                 ///< First texel of the level
+    PFint width;                        ///< Width of the level in texels
+    PFint height;                       ///< Height of the level in texels
+    PFint maskX;                        ///< Width minus one if it's a power of two, otherwise -1
+    PFint maskY;                        ///< Height minus one if it's a power of two, otherwise -1
+    PFint tilesX;                       ///< Number of blocks in a row of blocks if the texture is tiled, otherwise 0
+    PFfloat scaleX;                     ///< Width in fixed-point texels (see PF_SAMPLER_SUBTEXEL_BITS)
+    PFfloat scaleY;                     ///< Height in fixed-point texels
+} PFsamplerlevel;
+
+/**
+ * @brief Structure representing a texture prepared for sampling once per draw (see 'internal/sampler.h').
+ */
+typedef struct {
+    PFsamplerlevel levels[PF_MAX_TEXTURE_LEVELS];   ///< Levels of the texture, the first one being the texture itself
+    PFint levelCount;                               ///< Number of levels
+    PFpixelformat format;                           ///< Format whose texels are read directly, unknown to use 'getter'
+    PFpixelgetter getter;                           ///< Pixel getter of the texture
+    PFboolean minLinear;                            ///< Bilinear filtering of the minified texture
+    PFboolean magLinear;                            ///< Bilinear filtering of the magnified texture
+    PFmipmapmode mipmapMode;                        ///< Levels sampled when the texture is minified
+    PFtexturewrap wrapS;                            ///< Wrap mode of the U coordinates
+    PFtexturewrap wrapT;                            ///< Wrap mode of the V coordinates
+    PFboolean useLod;                               ///< False if the samples don't depend on the level of detail
+} PFsampler;
+
+/**
+ * @brief Structure representing an active light prepared for the current draw (see 'Lighting_Setup').
+ */
+typedef struct {
+    PFMvec3 position;                   ///< Position of the light source
+    PFMvec3 negDirection;               ///< Opposite of the direction of the light source, normalized for directional lights
+    PFfloat outerCutOff;                ///< Cosine of the outer cut off angle of the light cone
+    PFfloat invCutOffRange;             ///< Reciprocal of the difference between the inner and outer cut off cosines
+    PFfloat attConstant;                ///< Constant attenuation factor
+    PFfloat attLinear;                  ///< Linear attenuation factor
+    PFfloat attQuadratic;               ///< Quadratic attenuation factor
+    PFMvec3 ambient;                    ///< Ambient color of the light, in [0..1]
+    PFMvec3 diffuse;                    ///< Diffuse color of the light, in [0..1]
+    PFMvec3 specular;                   ///< Specular color of the light, in [0..1]
+    PFboolean spot;                     ///< True if the light has a cone (soft edges)
+    PFboolean attenuated;               ///< True if the light is attenuated with the distance
+    PFboolean directional;              ///< True if the light only has a direction, 'position' and the terms above are unused
+} PFlightdata;
+
+/**
+ * @brief Structure representing the lighting state computed once per draw (see 'internal/lighting').
+ */
+typedef struct {
+    PFlightdata lights[PF_MAX_LIGHT_STACK];                 ///< Active lights, the directional ones first
+    PFsizei count;                                          ///< Number of active lights
+    PFsizei directionalCount;                               ///< Number of active directional lights
+    PFMvec3 viewPos;                                        ///< Position of the camera, from the inverse of the view matrix
+    PFfloat shininess[2];                                   ///< Shininess the specular tables were built for [0: front] [1: back]
+    PFfloat specularTable[2][PF_SPECULAR_TABLE_SIZE + 2];   ///< Specular powers over [0..1] of each face, with one extra entry for the interpolation
+} PFlighting;
+
 /**
  * @brief Structure representing material color following.
  */
@@ -108,6 +198,23 @@ typedef struct {
     PFcolor color;                     ///< Color of the fog
 } PFfog;
 
+/**
+ * @brief Structure representing a set of modified regions of a framebuffer (see 'internal/damage.h').
+ */
+typedef struct {
+    PFrect rects[PF_MAX_DAMAGE_RECTS];  ///< Non-overlapping rectangles
+    PFsizei count;                      ///< Number of rectangles in use
+} PFdamage;
+
+/**
+ * @brief Structure representing what a framebuffer holds since its last color clear.
+ */
+typedef struct {
+    PFdamage drawn;                     ///< Regions drawn since the clear
+    PFcolor color;                      ///< Color of the clear
+    PFboolean valid;                    ///< False if the framebuffer may differ from 'color' outside of 'drawn'
+} PFclearhistory;
+
 /**
  * @brief Structure representing the main rendering context of the library.
  * TODO: Reorganize the context structure
@@ -116,6 +223,7 @@ typedef struct {
 
     PFframebuffer *currentFramebuffer;                      ///< Pointer to the current framebuffer
     PFtexture *currentTexture;                              ///< Pointer to the current texture
+    PFsampler sampler;                                      ///< Current texture prepared by 'pfBegin' for the sampling of the current draw
     PFMmat4 *currentMatrix;                                 ///< Pointer to the current matrix
     void *auxFramebuffer;                                   ///< Auxiliary buffer for double buffering
 
@@ -130,6 +238,7 @@ typedef struct {
     PFvertexattribs vertexAttribs;                          ///< Vertex attributes used by 'pfDrawArrays' or 'pfDrawElements' (e.g., normal, texture coordinates)
     PFvertex vertexBuffer[6];                               ///< Buffer used for storing primitive vertices, used for processing and rendering
     PFsizei vertexCounter;                                  ///< Number of vertices in 'ctx.vertexBuffer'
+    PFvertexbatch vertexBatch;                              ///< Vertices transformed at once by 'pfDrawArrays' before being assembled in 'ctx.vertexBuffer'
 
     PFMvec3 currentNormal;                                  ///< Current normal assigned by 'pfNormal'                  - (Stored in 'ctx.vertexBuffer' after the call to 'pfVertex')
     PFMvec2 currentTexcoord;                                ///< Current texture coordinates assigned by 'pfTexCoord'   - (Stored in 'ctx.vertexBuffer' after the call to 'pfVertex')
@@ -155,6 +264,7 @@ typedef struct {
 
     PFlight lights[PF_MAX_LIGHT_STACK];                     ///< Array of lights
     PFlight *activeLights;                                  ///< Pointer to the currently active light in the list of lights (see PFlight->next)
+    PFlighting lighting;                                    ///< Active lights prepared by 'pfBegin' for the lighting of the current draw
 
     PFfog fog;                                              ///< Fog properties (see PFfog)
 
@@ -179,9 +289,18 @@ typedef struct {
     PFshademode shadingMode;                                ///< Type of shading (e.g., flat, smooth)
     PFface cullFace;                                        ///< Faces to cull
 
+    PFdamage damage;                                        ///< Regions of the main framebuffer modified since 'pfResetDamage'
+    PFdamage presentedDamage;                               ///< Region emptied by the last 'pfResetDamage', still missing from the auxiliary buffer
+    PFclearhistory clearHistory;                            ///< Content of the main framebuffer since its last color clear
+    PFclearhistory presentedClearHistory;                   ///< Value of 'clearHistory' at the last 'pfResetDamage' (i.e. of the presented frame)
+
     PFerrcode errCode;                                      ///< Last error code
     PFuint state;                                           ///< Current context state
 
+#ifdef PF_SUPPORT_BINNED_RASTER
+    struct PFbinner *binner;                                ///< Triangles waiting to be rasterized by tiles (see 'internal/binning')
+#endif //PF_SUPPORT_BINNED_RASTER
+
 } PFctx;
 
 /* Current thread local-thread declaration */
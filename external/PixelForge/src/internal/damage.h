@@ -0,0 +1,132 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_DAMAGE_H
+#define PF_DAMAGE_H
+
+#include "./context.h"
+#include "./config.h"
+
+/*
+    Damage region.
+
+    The context keeps the bounds of everything written to the main framebuffer
+    so that a presenter only has to copy the modified regions to the screen
+    (see 'pfGetDamage'). A region is a short list of non-overlapping rectangles,
+    a new rectangle is merged with the ones it overlaps or touches, and when the
+    list is full with the one whose bounds grow the least.
+
+    The bounds are conservative, over-estimating a region only costs bandwidth.
+*/
+
+/* Helper functions */
+
+static inline PFint Damage_RectArea(PFint xMin, PFint yMin, PFint xMax, PFint yMax)
+{
+    return (xMax - xMin + 1)*(yMax - yMin + 1);
+}
+
+static inline void Damage_RemoveRect(PFdamage* damage, PFsizei index)
+{
+    damage->rects[index] = damage->rects[--damage->count];
+}
+
+/* Damage region functions */
+
+static inline void Damage_Reset(PFdamage* damage)
+{
+    damage->count = 0;
+}
+
+// NOTE: The bounds are inclusive and must already be clipped to the framebuffer
+static inline void Damage_AddRect(PFdamage* damage, PFint xMin, PFint yMin, PFint xMax, PFint yMax)
+{
+    if (xMin > xMax || yMin > yMax) return;
+
+    PFsizei i = 0;
+
+    while (i < damage->count)
+    {
+        const PFrect *r = &damage->rects[i];
+        PFint rxMax = r->x + (PFint)r->width - 1;
+        PFint ryMax = r->y + (PFint)r->height - 1;
+
+        // Nothing to do if the rectangle is already covered
+        if (xMin >= r->x && yMin >= r->y && xMax <= rxMax && yMax <= ryMax) return;
+
+        // Absorb the rectangles that overlap or touch the new one, then
+        // check the others again since the new bounds may now reach them
+        if (xMin <= rxMax + 1 && xMax + 1 >= r->x && yMin <= ryMax + 1 && yMax + 1 >= r->y)
+        {
+            xMin = MIN(xMin, r->x), yMin = MIN(yMin, r->y);
+            xMax = MAX(xMax, rxMax), yMax = MAX(yMax, ryMax);
+            Damage_RemoveRect(damage, i), i = 0;
+            continue;
+        }
+
+        i++;
+    }
+
+    if (damage->count == PF_MAX_DAMAGE_RECTS)
+    {
+        // Merge with the rectangle whose bounds grow the least
+        PFsizei best = 0;
+        PFint bestGrowth = 0;
+
+        for (PFsizei j = 0; j < damage->count; j++)
+        {
+            const PFrect *r = &damage->rects[j];
+            PFint rxMax = r->x + (PFint)r->width - 1;
+            PFint ryMax = r->y + (PFint)r->height - 1;
+
+            PFint growth = Damage_RectArea(MIN(xMin, r->x), MIN(yMin, r->y), MAX(xMax, rxMax), MAX(yMax, ryMax))
+                         - Damage_RectArea(r->x, r->y, rxMax, ryMax);
+
+            if (j == 0 || growth < bestGrowth) best = j, bestGrowth = growth;
+        }
+
+        PFrect r = damage->rects[best];
+        Damage_RemoveRect(damage, best);
+        Damage_AddRect(damage, MIN(xMin, r.x), MIN(yMin, r.y),
+            MAX(xMax, r.x + (PFint)r.width - 1), MAX(yMax, r.y + (PFint)r.height - 1));
+
+        return;
+    }
+
+    damage->rects[damage->count++] = (PFrect) {
+        xMin, yMin, (PFsizei)(xMax - xMin + 1), (PFsizei)(yMax - yMin + 1)
+    };
+}
+
+static inline void Damage_AddRegion(PFdamage* damage, const PFdamage* region)
+{
+    for (PFsizei i = 0; i < region->count; i++)
+    {
+        const PFrect *r = &region->rects[i];
+        Damage_AddRect(damage, r->x, r->y, r->x + (PFint)r->width - 1, r->y + (PFint)r->height - 1);
+    }
+}
+
+static inline void Damage_SetAll(PFdamage* damage, const PFframebuffer* framebuffer)
+{
+    damage->count = 0;
+    Damage_AddRect(damage, 0, 0, (PFint)framebuffer->texture.width - 1, (PFint)framebuffer->texture.height - 1);
+}
+
+#endif //PF_DAMAGE_H
@@ -0,0 +1,216 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_DEPTH_H
+#define PF_DEPTH_H
+
+#include "./context.h"
+#include "./config.h"
+
+#include <string.h>
+#include <math.h>
+
+/*
+    Coarse depth buffer.
+
+    'PFframebuffer.zbufferMax' holds, for each block of PF_DEPTH_TILE_SIZE^2 pixels,
+    a value greater than or equal to every depth of the block in 'zbuffer'. With
+    the 'pfDepthLess' and 'pfDepthLequal' tests, a triangle whose nearest possible
+    depth fails the test against this value cannot write any pixel of the block,
+    so the barycentric rasterizer skips the block entirely.
+
+    Every write to 'zbuffer' that can make a depth greater than the one stored
+    for its block must raise the block value, writes that passed a 'less' test
+    can only lower depths so they don't need to. A NULL 'zbufferMax' disables it.
+
+    Lazy depth clear.
+
+    'pfClear' only sets the value of the blocks and flags them in 'zbufferPending',
+    the depths of a flagged block are all its 'zbufferMax' value but haven't been
+    written yet. The rasterizers write them with 'Depth_ResolveTiles' before their
+    first access to a block, so the blocks that nothing is drawn on are never
+    written. A NULL 'zbufferPending' (or 'zbufferMax') clears the depths at once.
+*/
+
+#define PF_DEPTH_UNBOUNDED ((PFfloat)HUGE_VAL)
+
+/* Depth tests */
+
+// NOTE: The standard tests are inlined, the others go through the function pointer
+static inline PFboolean Depth_Test(PFdepthfunc func, PFfloat source, PFfloat destination)
+{
+    if (func == pfDepthLess) return (source < destination);
+    if (func == pfDepthLequal) return (source <= destination);
+    return func(source, destination);
+}
+
+// NOTE: Returns true if writes with this test can only lower the depths
+static inline PFboolean Depth_IsLessTest(PFdepthfunc func)
+{
+    return (func == pfDepthLess || func == pfDepthLequal);
+}
+
+/* Coarse depth buffer */
+
+static inline PFsizei Depth_TilesPerRow(PFsizei width)
+{
+    return (width + PF_DEPTH_TILE_SIZE - 1)/PF_DEPTH_TILE_SIZE;
+}
+
+static inline PFsizei Depth_TileCount(PFsizei width, PFsizei height)
+{
+    return Depth_TilesPerRow(width)*((height + PF_DEPTH_TILE_SIZE - 1)/PF_DEPTH_TILE_SIZE);
+}
+
+static inline void Depth_FillTiles(PFframebuffer* framebuffer, PFfloat depth)
+{
+    if (framebuffer->zbufferMax)
+    {
+        PFsizei count = Depth_TileCount(framebuffer->texture.width, framebuffer->texture.height);
+        for (PFsizei i = 0; i < count; i++) framebuffer->zbufferMax[i] = depth;
+    }
+}
+
+/* Lazy depth clear */
+
+static inline PFboolean Depth_IsLazy(const PFframebuffer* framebuffer)
+{
+    return framebuffer->zbufferPending && framebuffer->zbufferMax;
+}
+
+// NOTE: Sets every depth of the framebuffer, at once or by flagging all the blocks
+static inline void Depth_Clear(PFframebuffer* framebuffer, PFfloat depth)
+{
+    Depth_FillTiles(framebuffer, depth);
+
+    if (Depth_IsLazy(framebuffer))
+    {
+        memset(framebuffer->zbufferPending, 1, Depth_TileCount(framebuffer->texture.width, framebuffer->texture.height));
+        return;
+    }
+
+    PFfloat *zbuffer = framebuffer->zbuffer;
+    PFsizei size = framebuffer->texture.width*framebuffer->texture.height;
+
+#   ifdef PF_SUPPORT_OPENMP
+#       pragma omp parallel for if(size >= PF_OPENMP_CLEAR_BUFFER_SIZE_THRESHOLD)
+#   endif //PF_SUPPORT_OPENMP
+    for (PFsizei i = 0; i < size; i++)
+    {
+        zbuffer[i] = depth;
+    }
+}
+
+// NOTE: Writes the depths of a flagged block, 'index' being (ty*tilesPerRow + tx)
+static inline void Depth_WriteTile(PFframebuffer* framebuffer, PFint tx, PFint ty, PFsizei index)
+{
+    PFint width = framebuffer->texture.width, height = framebuffer->texture.height;
+
+    PFint x0 = tx*PF_DEPTH_TILE_SIZE, y0 = ty*PF_DEPTH_TILE_SIZE;
+    PFint w = MIN(PF_DEPTH_TILE_SIZE, width - x0);
+    PFint h = MIN(PF_DEPTH_TILE_SIZE, height - y0);
+
+    PFfloat depth = framebuffer->zbufferMax[index];
+    PFfloat *row = framebuffer->zbuffer + y0*width + x0;
+
+    for (PFint y = 0; y < h; y++, row += width)
+    {
+        for (PFint x = 0; x < w; x++) row[x] = depth;
+    }
+
+    framebuffer->zbufferPending[index] = 0;
+}
+
+// NOTE: To call before accessing the depth at (x, y), which must be in the framebuffer
+static inline void Depth_ResolveTile(PFframebuffer* framebuffer, PFint x, PFint y)
+{
+    if (!Depth_IsLazy(framebuffer)) return;
+
+    PFint tx = x/PF_DEPTH_TILE_SIZE, ty = y/PF_DEPTH_TILE_SIZE;
+    PFsizei index = ty*Depth_TilesPerRow(framebuffer->texture.width) + tx;
+
+    if (framebuffer->zbufferPending[index])
+    {
+        Depth_WriteTile(framebuffer, tx, ty, index);
+    }
+}
+
+// NOTE: To call before accessing the depths of the rectangle (inclusive bounds, clipped here).
+//       The blocks of the bins of the binned rasterizer are never shared between two bins.
+static inline void Depth_ResolveTiles(PFframebuffer* framebuffer, PFint xMin, PFint yMin, PFint xMax, PFint yMax)
+{
+    if (!Depth_IsLazy(framebuffer) || xMax < 0 || yMax < 0) return;
+
+    PFint tilesX = Depth_TilesPerRow(framebuffer->texture.width);
+    PFint tilesY = (framebuffer->texture.height + PF_DEPTH_TILE_SIZE - 1)/PF_DEPTH_TILE_SIZE;
+
+    PFint txMin = MAX(xMin, 0)/PF_DEPTH_TILE_SIZE, txMax = MIN(xMax/PF_DEPTH_TILE_SIZE, tilesX - 1);
+    PFint tyMin = MAX(yMin, 0)/PF_DEPTH_TILE_SIZE, tyMax = MIN(yMax/PF_DEPTH_TILE_SIZE, tilesY - 1);
+
+    for (PFint ty = tyMin; ty <= tyMax; ty++)
+    {
+        const PFubyte *row = framebuffer->zbufferPending + ty*tilesX;
+
+        for (PFint tx = txMin; tx <= txMax; tx++)
+        {
+            if (row[tx]) Depth_WriteTile(framebuffer, tx, ty, ty*tilesX + tx);
+        }
+    }
+}
+
+static inline void Depth_ResolveAll(PFframebuffer* framebuffer)
+{
+    Depth_ResolveTiles(framebuffer, 0, 0, (PFint)framebuffer->texture.width - 1, (PFint)framebuffer->texture.height - 1);
+}
+
+// NOTE: To call after writing 'depth' at (x, y) without a 'less' test
+static inline void Depth_RaiseTile(PFframebuffer* framebuffer, PFsizei x, PFsizei y, PFfloat depth)
+{
+    if (framebuffer->zbufferMax)
+    {
+        PFfloat *tileMax = framebuffer->zbufferMax
+            + (y/PF_DEPTH_TILE_SIZE)*Depth_TilesPerRow(framebuffer->texture.width) + x/PF_DEPTH_TILE_SIZE;
+
+        if (depth > *tileMax) *tileMax = depth;
+    }
+}
+
+// NOTE: Same as 'Depth_RaiseTile' for all the blocks overlapped by the rectangle (inclusive bounds)
+static inline void Depth_RaiseTiles(PFframebuffer* framebuffer, PFint xMin, PFint yMin, PFint xMax, PFint yMax, PFfloat depth)
+{
+    if (!framebuffer->zbufferMax) return;
+
+    PFint tilesX = Depth_TilesPerRow(framebuffer->texture.width);
+    PFint tilesY = (framebuffer->texture.height + PF_DEPTH_TILE_SIZE - 1)/PF_DEPTH_TILE_SIZE;
+
+    PFint txMin = MAX(xMin, 0)/PF_DEPTH_TILE_SIZE, txMax = MIN(xMax/PF_DEPTH_TILE_SIZE, tilesX - 1);
+    PFint tyMin = MAX(yMin, 0)/PF_DEPTH_TILE_SIZE, tyMax = MIN(yMax/PF_DEPTH_TILE_SIZE, tilesY - 1);
+
+    for (PFint ty = tyMin; ty <= tyMax; ty++)
+    {
+        PFfloat *row = framebuffer->zbufferMax + ty*tilesX;
+
+        for (PFint tx = txMin; tx <= txMax; tx++)
+        {
+            if (depth > row[tx]) row[tx] = depth;
+        }
+    }
+}
+
+#endif //PF_DEPTH_H
@@ -0,0 +1,278 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "./lighting.h"
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+/* Internal helper function declarations */
+
+static void Helper_PackLight(PFlightdata* data, const PFlight* light);
+static void Helper_BuildSpecularTable(PFfloat table[PF_SPECULAR_TABLE_SIZE + 2], PFfloat shininess);
+
+
+/* Lighting functions */
+
+void Lighting_Setup(PFlighting* lighting)
+{
+    /* Position of the camera */
+
+    PFMmat4 invMatView;
+    pfmMat4Invert(invMatView, currentCtx->matView);
+    pfmVec3Copy(lighting->viewPos, invMatView + 12);
+
+    /* Pack the active lights, the directional ones first */
+
+    PFsizei count = 0;
+
+    for (const PFlight *light = currentCtx->activeLights; light != NULL; light = light->next)
+    {
+        if (light->directional) Helper_PackLight(&lighting->lights[count++], light);
+    }
+
+    lighting->directionalCount = count;
+
+    for (const PFlight *light = currentCtx->activeLights; light != NULL; light = light->next)
+    {
+        if (!light->directional) Helper_PackLight(&lighting->lights[count++], light);
+    }
+
+    lighting->count = count;
+
+    /* Rebuild the specular tables whose shininess has changed */
+
+    for (int_fast8_t face = 0; face < 2; face++)
+    {
+        PFfloat shininess = currentCtx->faceMaterial[face].shininess;
+
+        if (lighting->shininess[face] != shininess)
+        {
+            Helper_BuildSpecularTable(lighting->specularTable[face], shininess);
+            lighting->shininess[face] = shininess;
+        }
+    }
+}
+
+// NOTE: Same as 'powf(MAX(x, 0), shininess)' up to the interpolation between the entries of the table
+static inline PFfloat Helper_SpecularPower(const PFfloat* table, PFfloat x)
+{
+    if (x <= 0.0f) return table[0];
+
+    PFfloat f = MIN(x, 1.0f)*PF_SPECULAR_TABLE_SIZE;
+    PFint i = (PFint)f;
+
+    return table[i] + (f - i)*(table[i + 1] - table[i]);
+}
+
+PFcolor Lighting_Shade(const PFlighting* lighting, PFface face, PFcolor diffuse, const PFMvec3 viewPos, const PFMvec3 fragPos, const PFMvec3 fragNormal)
+{
+    const PFmaterial *material = &currentCtx->faceMaterial[face];
+    const PFfloat *table = lighting->specularTable[face];
+
+    // NOTE: The colors of the fragment and of the material are kept in [0..255] and the
+    //       ones of the lights in [0..1], so that the sums are directly in [0..255]
+
+    PFfloat dR = diffuse.r, dG = diffuse.g, dB = diffuse.b;
+    PFfloat sR = material->specular.r, sG = material->specular.g, sB = material->specular.b;
+
+    PFfloat aR = material->ambient.r*dR*(1.0f/255.0f);
+    PFfloat aG = material->ambient.g*dG*(1.0f/255.0f);
+    PFfloat aB = material->ambient.b*dB*(1.0f/255.0f);
+
+    PFfloat R = material->emission.r;
+    PFfloat G = material->emission.g;
+    PFfloat B = material->emission.b;
+
+    PFMvec3 viewDir;
+    pfmVec3DirectionR(viewDir, viewPos, fragPos);
+
+#   ifndef PF_PHONG_REFLECTION
+#       define SPECULAR(lightDir) \
+            PFMvec3 halfWayDir; \
+            pfmVec3AddR(halfWayDir, lightDir, viewDir); \
+            pfmVec3Normalize(halfWayDir, halfWayDir); \
+            PFfloat spec = Helper_SpecularPower(table, pfmVec3Dot(fragNormal, halfWayDir));
+#   else
+#       define SPECULAR(lightDir) \
+            PFMvec3 reflectDir, negLightDir; \
+            pfmVec3NegR(negLightDir, lightDir); \
+            pfmVec3ReflectR(reflectDir, negLightDir, fragNormal); \
+            PFfloat spec = Helper_SpecularPower(table, pfmVec3Dot(reflectDir, viewDir));
+#   endif
+
+    // NOTE: Adds the diffuse and specular terms of a light whose direction is 'lightDir', scaled by 'factor'
+
+#   define ADD_DIFFUSE_SPECULAR(light, lightDir, factor) \
+    { \
+        PFfloat diff = MAX(pfmVec3Dot(fragNormal, lightDir), 0.0f)*(factor); \
+        SPECULAR(lightDir); \
+        spec *= (factor); \
+        \
+        R += dR*(light)->diffuse[0]*diff + sR*(light)->specular[0]*spec; \
+        G += dG*(light)->diffuse[1]*diff + sG*(light)->specular[1]*spec; \
+        B += dB*(light)->diffuse[2]*diff + sB*(light)->specular[2]*spec; \
+    }
+
+#   define ADD_AMBIENT(light) \
+    { \
+        R += aR*(light)->ambient[0]; \
+        G += aG*(light)->ambient[1]; \
+        B += aB*(light)->ambient[2]; \
+    }
+
+    // NOTE: Directional light kernel, the direction is the same for all the fragments
+
+#   define ADD_DIRECTIONAL_LIGHT(LIGHT) \
+    { \
+        const PFlightdata *light = (LIGHT); \
+        ADD_DIFFUSE_SPECULAR(light, light->negDirection, 1.0f); \
+        ADD_AMBIENT(light); \
+    }
+
+    // NOTE: Point light kernel, the spot and attenuation terms are skipped for the lights which
+    //       don't have them, the ambient contribution is added even outside of the cone of a spotlight.
+    //       As with the byte math this replaces, the attenuation never brightens the light and the
+    //       light is ignored once its attenuation would be truncated to zero.
+
+#   define ADD_POINT_LIGHT(LIGHT) \
+    { \
+        const PFlightdata *light = (LIGHT); \
+        \
+        PFMvec3 lightDir; \
+        pfmVec3SubR(lightDir, light->position, fragPos); \
+        \
+        PFfloat distSq = pfmVec3Dot(lightDir, lightDir); \
+        PFfloat dist = 0.0f; \
+        \
+        if (distSq != 0.0f) \
+        { \
+            dist = sqrtf(distSq); \
+            pfmVec3Scale(lightDir, lightDir, 1.0f/dist); \
+        } \
+        \
+        PFfloat factor = 1.0f; \
+        \
+        if (light->spot) \
+        { \
+            PFfloat theta = pfmVec3Dot(lightDir, light->negDirection); \
+            factor = CLAMP((theta - light->outerCutOff)*light->invCutOffRange, 0.0f, 1.0f); \
+        } \
+        \
+        if (light->attenuated) \
+        { \
+            PFfloat attenuation = 1.0f/(light->attConstant + light->attLinear*dist + light->attQuadratic*distSq); \
+            factor = (attenuation*255.0f >= 1.0f) ? factor*MIN(attenuation, 1.0f) : 0.0f; \
+        } \
+        \
+        if (factor > 0.0f) ADD_DIFFUSE_SPECULAR(light, lightDir, factor); \
+        ADD_AMBIENT(light); \
+    }
+
+#   define ADD_LIGHT(LIGHT) \
+    { \
+        if ((LIGHT)->directional) ADD_DIRECTIONAL_LIGHT(LIGHT) \
+        else ADD_POINT_LIGHT(LIGHT) \
+    }
+
+    switch (lighting->count)
+    {
+        case 1:
+            ADD_LIGHT(&lighting->lights[0]);
+            break;
+
+        case 2:
+            ADD_LIGHT(&lighting->lights[0]);
+            ADD_LIGHT(&lighting->lights[1]);
+            break;
+
+        default:
+            for (PFsizei i = 0; i < lighting->directionalCount; i++) ADD_DIRECTIONAL_LIGHT(&lighting->lights[i]);
+            for (PFsizei i = lighting->directionalCount; i < lighting->count; i++) ADD_POINT_LIGHT(&lighting->lights[i]);
+            break;
+    }
+
+#   undef ADD_LIGHT
+#   undef ADD_POINT_LIGHT
+#   undef ADD_DIRECTIONAL_LIGHT
+#   undef ADD_AMBIENT
+#   undef ADD_DIFFUSE_SPECULAR
+#   undef SPECULAR
+
+    return (PFcolor) {
+        (PFubyte)MIN(R, 255.0f),
+        (PFubyte)MIN(G, 255.0f),
+        (PFubyte)MIN(B, 255.0f),
+        diffuse.a
+    };
+}
+
+
+/* Internal helper function definitions */
+
+void Helper_PackLight(PFlightdata* data, const PFlight* light)
+{
+    const PFfloat inv255 = 1.0f/255.0f;
+
+    memcpy(data->position, light->position, sizeof(PFMvec3));
+    pfmVec3NegR(data->negDirection, light->direction);
+
+    // NOTE: A directional light has neither cone nor attenuation, its direction is
+    //       used as is by the kernel so it is normalized here once
+    data->directional = light->directional;
+
+    if (light->directional)
+    {
+        pfmVec3Normalize(data->negDirection, data->negDirection);
+    }
+
+    // NOTE: The cut offs are given as cosines, the default value of M_PI disables the cone
+    PFfloat cutOffRange = light->innerCutOff - light->outerCutOff;
+    data->spot = !light->directional && (light->innerCutOff < M_PI);
+    data->outerCutOff = light->outerCutOff;
+    data->invCutOffRange = (cutOffRange != 0.0f) ? 1.0f/cutOffRange : FLT_MAX;
+
+    data->attenuated = !light->directional && (light->attLinear != 0.0f || light->attQuadratic != 0.0f);
+    data->attConstant = light->attConstant;
+    data->attLinear = light->attLinear;
+    data->attQuadratic = light->attQuadratic;
+
+    data->ambient[0] = light->ambient.r*inv255;
+    data->ambient[1] = light->ambient.g*inv255;
+    data->ambient[2] = light->ambient.b*inv255;
+
+    data->diffuse[0] = light->diffuse.r*inv255;
+    data->diffuse[1] = light->diffuse.g*inv255;
+    data->diffuse[2] = light->diffuse.b*inv255;
+
+    data->specular[0] = light->specular.r*inv255;
+    data->specular[1] = light->specular.g*inv255;
+    data->specular[2] = light->specular.b*inv255;
+}
+
+void Helper_BuildSpecularTable(PFfloat table[PF_SPECULAR_TABLE_SIZE + 2], PFfloat shininess)
+{
+    for (PFint i = 0; i <= PF_SPECULAR_TABLE_SIZE; i++)
+    {
+        table[i] = powf((PFfloat)i/PF_SPECULAR_TABLE_SIZE, shininess);
+    }
+
+    // NOTE: Read by the interpolation of 'Helper_SpecularPower' when x is exactly one
+    table[PF_SPECULAR_TABLE_SIZE + 1] = table[PF_SPECULAR_TABLE_SIZE];
+}
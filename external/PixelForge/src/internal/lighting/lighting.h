@@ -0,0 +1,50 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_LIGHTING_H
+#define PF_LIGHTING_H
+
+#include "../context.h"
+#include "../config.h"
+
+/*
+    Lighting.
+
+    'pfBegin' prepares the active lights once per draw with 'Lighting_Setup': the list of
+    active lights is packed into an array with colors in [0..1], the reciprocal of the
+    spotlight cone range and flags for the spot and attenuation terms, the directional
+    lights (see PF_DIRECTION) being placed before the point lights, the position of the
+    camera is extracted from the view matrix, and the tables of specular powers are rebuilt
+    if the shininess of a material has changed.
+
+    'Lighting_Shade' then lights a fragment (or a vertex with PF_VERTEX_LIGHTING) with float
+    math, looking up the specular power in the table instead of calling 'powf'. Directional
+    and point lights have their own kernels, unrolled for one or two lights and otherwise
+    looped over each kind of light.
+*/
+
+// NOTE: Must be called before the vertices of a draw are lit, with PF_LIGHTING and at least one active light
+void Lighting_Setup(PFlighting* lighting);
+
+// NOTE: 'diffuse' is the color of the fragment, already multiplied by the diffuse color of the material,
+//       'face' selects the material (PF_FRONT or PF_BACK) and 'fragNormal' must be normalized.
+PFcolor Lighting_Shade(const PFlighting* lighting, PFface face, PFcolor diffuse,
+    const PFMvec3 viewPos, const PFMvec3 fragPos, const PFMvec3 fragNormal);
+
+#endif //PF_LIGHTING_H
@@ -0,0 +1,158 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_PIXEL_H
+#define PF_PIXEL_H
+
+#include "./context.h"
+#include "../pfm.h"
+
+#include <math.h>
+
+/*
+    Direct pixel access for the framebuffer formats that are worth specializing.
+
+    The rasterizers call 'pfInternal_GetDirectPixelFormat' once per primitive, then
+    use these inline functions instead of going through 'PFtexture.pixelGetter' and
+    'PFtexture.pixelSetter' for every fragment. The function pointers are only used
+    for the other formats, or when a custom getter/setter has been installed.
+*/
+
+/* Implemented in 'texture.c' */
+
+PFpixelformat pfInternal_GetDirectPixelFormat(const PFtexture* texture);
+
+/* Channel conversions */
+
+// NOTE: 8 bit channel to 'max' + 1 levels (15, 31, 63), rounded to nearest, with integer math
+//       only; same results as 'roundf(channel/255.0f*max)'
+static inline PFubyte Pixel_ReduceChannel(PFuint channel, PFuint max)
+{
+    PFuint x = channel*max + 127;
+    return (PFubyte)((x + 1 + (x >> 8)) >> 8);
+}
+
+// NOTE: 5 and 6 bit channels to 8 bits, rounded to nearest ('round(v*255/31)' and 'round(v*255/63)'),
+//       so that the largest values give 255
+static inline PFubyte Pixel_Expand5(PFuint v)
+{
+    return (PFubyte)((v*527 + 23) >> 6);
+}
+
+static inline PFubyte Pixel_Expand6(PFuint v)
+{
+    return (PFubyte)((v*259 + 33) >> 6);
+}
+
+// NOTE: Luminance of the grayscale formats
+static inline PFubyte Pixel_Gray(PFubyte r, PFubyte g, PFubyte b)
+{
+    PFMvec3 nCol = { (PFfloat)r*INV_255, (PFfloat)g*INV_255, (PFfloat)b*INV_255 };
+    return (PFubyte)((nCol[0]*0.299f + nCol[1]*0.587f + nCol[2]*0.114f)*255.0f);
+}
+
+/* Pixel setters */
+
+static inline void Pixel_SetR5G6B5(void* pixels, PFsizei offset, PFcolor color)
+{
+    PFubyte r = Pixel_ReduceChannel(color.r, 31);
+    PFubyte g = Pixel_ReduceChannel(color.g, 63);
+    PFubyte b = Pixel_ReduceChannel(color.b, 31);
+
+    ((PFushort*)pixels)[offset] = (PFushort)r << 11 | (PFushort)g << 5 | (PFushort)b;
+}
+
+static inline void Pixel_SetR8G8B8(void* pixels, PFsizei offset, PFcolor color)
+{
+    PFubyte* pixel = (PFubyte*)pixels + offset*3;
+    pixel[0] = color.r, pixel[1] = color.g, pixel[2] = color.b;
+}
+
+static inline void Pixel_SetB8G8R8(void* pixels, PFsizei offset, PFcolor color)
+{
+    PFubyte* pixel = (PFubyte*)pixels + offset*3;
+    pixel[0] = color.b, pixel[1] = color.g, pixel[2] = color.r;
+}
+
+static inline void Pixel_SetR8G8B8A8(void* pixels, PFsizei offset, PFcolor color)
+{
+    PFubyte* pixel = (PFubyte*)pixels + offset*4;
+    pixel[0] = color.r, pixel[1] = color.g, pixel[2] = color.b, pixel[3] = color.a;
+}
+
+/* Pixel getters */
+
+static inline PFcolor Pixel_GetR5G6B5(const void* pixels, PFsizei offset)
+{
+    PFushort pixel = ((const PFushort*)pixels)[offset];
+
+    return (PFcolor) {
+        Pixel_Expand5((pixel & 0xF800) >> 11),                              // 0b1111100000000000
+        Pixel_Expand6((pixel & 0x7E0) >> 5),                                // 0b0000011111100000
+        Pixel_Expand5(pixel & 0x1F),                                        // 0b0000000000011111
+        255
+    };
+}
+
+static inline PFcolor Pixel_GetR8G8B8(const void* pixels, PFsizei offset)
+{
+    const PFubyte* pixel = (const PFubyte*)pixels + offset*3;
+    return (PFcolor) { pixel[0], pixel[1], pixel[2], 255 };
+}
+
+static inline PFcolor Pixel_GetB8G8R8(const void* pixels, PFsizei offset)
+{
+    const PFubyte* pixel = (const PFubyte*)pixels + offset*3;
+    return (PFcolor) { pixel[2], pixel[1], pixel[0], 255 };
+}
+
+static inline PFcolor Pixel_GetR8G8B8A8(const void* pixels, PFsizei offset)
+{
+    // NOTE: Read byte per byte, 6c was aligning PFcolor to 8 bytes
+    const PFubyte* pixel = (const PFubyte*)pixels + offset*4;
+    return (PFcolor) { pixel[0], pixel[1], pixel[2], pixel[3] };
+}
+
+/* Dispatch on a format given by 'pfInternal_GetDirectPixelFormat' */
+
+static inline void Pixel_Set(const PFtexture* texture, PFpixelformat directFormat, PFsizei offset, PFcolor color)
+{
+    switch (directFormat)
+    {
+        case PF_PIXELFORMAT_R5G6B5:     Pixel_SetR5G6B5(texture->pixels, offset, color);     break;
+        case PF_PIXELFORMAT_R8G8B8:     Pixel_SetR8G8B8(texture->pixels, offset, color);     break;
+        case PF_PIXELFORMAT_B8G8R8:     Pixel_SetB8G8R8(texture->pixels, offset, color);     break;
+        case PF_PIXELFORMAT_R8G8B8A8:   Pixel_SetR8G8B8A8(texture->pixels, offset, color);   break;
+        default:                        texture->pixelSetter(texture->pixels, offset, color); break;
+    }
+}
+
+static inline PFcolor Pixel_Get(const PFtexture* texture, PFpixelformat directFormat, PFsizei offset)
+{
+    switch (directFormat)
+    {
+        case PF_PIXELFORMAT_R5G6B5:     return Pixel_GetR5G6B5(texture->pixels, offset);
+        case PF_PIXELFORMAT_R8G8B8:     return Pixel_GetR8G8B8(texture->pixels, offset);
+        case PF_PIXELFORMAT_B8G8R8:     return Pixel_GetB8G8R8(texture->pixels, offset);
+        case PF_PIXELFORMAT_R8G8B8A8:   return Pixel_GetR8G8B8A8(texture->pixels, offset);
+        default:                        return texture->pixelGetter(texture->pixels, offset);
+    }
+}
+
+#endif //PF_PIXEL_H
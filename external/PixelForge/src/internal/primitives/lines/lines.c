@@ -22,6 +22,8 @@
  */
 
 #include "./lines.h"
+#include "../../pixel.h"
+#include "../../depth.h"
 #include <stdlib.h>
 
 /* Including internal function prototypes */
@@ -36,9 +38,7 @@ static void Helper_SwapByte(PFubyte* a, PFubyte* b);
 static PFubyte Helper_EncodeClip2D(const PFMvec2 screen, PFint xMin, PFint yMin, PFint xMax, PFint yMax);
 static PFboolean Helper_ClipCoord3D(PFfloat q, PFfloat p, PFfloat* t1, PFfloat* t2);
 
-static PFcolor Helper_LerpColor(PFcolor a, PFcolor b, PFfloat t);
-
-/* Enums for internal use */
+/* Enums and structs for internal use */
 
 typedef enum {
     CLIP_INSIDE = 0x00, // 0000
@@ -48,6 +48,34 @@ typedef enum {
     CLIP_TOP    = 0x08, // 1000
 } PFclipcode;
 
+// NOTE: A line is walked pixel by pixel along its major axis with integer steps, the minor
+//       coordinate is kept in 16.16 fixed point. The last endpoint is not drawn.
+typedef struct {
+    PFint x, y;                     // First pixel of the line
+    PFint xStep, yStep;             // Step of the major axis by pixel, zero for the minor axis
+    PFint xMinor, yMinor;           // One for the minor axis, zero for the major axis
+    PFint minorInc;                 // Increment of the minor coordinate by pixel (16.16)
+    PFint count;                    // Number of pixels of the line
+    PFint first, last;              // Pixels of the line inside the bounds on the major axis
+    PFint xMin, yMin, xMax, yMax;   // Bounds of the viewport in the framebuffer (inclusive)
+    PFint minorMin, minorMax;       // Bounds of the minor axis
+} PFlinewalk;
+
+// NOTE: Channels of the first color and their increments by pixel (16.16)
+typedef struct {
+    PFint r, g, b, a;
+    PFint dr, dg, db, da;
+} PFlinecolor;
+
+static PFboolean Helper_InitLineWalk(PFlinewalk* walk, const PFvertex* v1, const PFvertex* v2);
+static PFint Helper_GetLineHalfWidth(const PFlinewalk* walk, const PFvertex* v1, const PFvertex* v2);
+
+static PFboolean Helper_IsFlatLine(const PFvertex* v1, const PFvertex* v2);
+static void Helper_InitLineColor(PFlinecolor* lineColor, PFcolor c1, PFcolor c2, PFint count);
+static inline PFcolor Helper_GetLineColor(const PFlinecolor* lineColor, PFint i);
+
+static void Helper_RasterizeLineSmooth(const PFvertex* v1, const PFvertex* v2, PFboolean depthTest);
+
 
 /* Line processing functions */
 
@@ -98,12 +126,12 @@ static PFboolean Process_ClipLine2D(PFvertex* restrict v1, PFvertex* restrict v2
             v1->screen[1] += (currentCtx->vpMax[0] - v1->screen[0])*m;
             v1->screen[0] = currentCtx->vpMax[0];
         }
-        else if (code0 & CLIP_BOTTOM)
+        else if (code0 & CLIP_TOP)
         {
             if (m) v1->screen[0] += (currentCtx->vpMin[1] - v1->screen[1]) / m;
             v1->screen[1] = currentCtx->vpMin[1];
         }
-        else if (code0 & CLIP_TOP)
+        else if (code0 & CLIP_BOTTOM)
         {
             if (m) v1->screen[0] += (currentCtx->vpMax[1] - v1->screen[1]) / m;
             v1->screen[1] = currentCtx->vpMax[1];
@@ -191,296 +219,232 @@ void Process_ProjectAndClipLine(PFvertex* line, int_fast8_t* vertexCounter)
 
 /* Internal line rasterizer function definitions */
 
-void Rasterize_Line_NODEPTH(const PFvertex* v1, const PFvertex* v2)
+PFlinefunc Rasterize_GetLineFunc(void)
 {
-    /* Get Some Values*/
-
-    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
-
-    PFpixelsetter pixelSetter = fbDst->texture.pixelSetter;
-    PFpixelgetter pixelGetter = fbDst->texture.pixelGetter;
-
-    PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
-        currentCtx->blendFunction : NULL;
-
-    void *bufDst = fbDst->texture.pixels;
-    PFsizei wDst = fbDst->texture.width;
-    PFfloat *zbDst = fbDst->zbuffer;
-
-    PFint x1 = v1->screen[0], y1 = v1->screen[1];
-    PFint x2 = v2->screen[0], y2 = v2->screen[1];
-    PFfloat z1 = v1->homogeneous[2];
-    PFfloat z2 = v2->homogeneous[2];
-    PFcolor c1 = v1->color;
-    PFcolor c2 = v2->color;
-
-    /* Draw Line */
+    PFboolean depthTest = currentCtx->state & PF_DEPTH_TEST;
 
-    PFint shortLen = y2 - y1;
-    PFint longLen = x2 - x1;
-    PFboolean yLonger = 0;
-
-    if (abs(shortLen) > abs(longLen))
+    // NOTE: Smoothing is only applied to thin lines, thick lines are drawn aliased
+    if (currentCtx->lineWidth > 1.5f)
     {
-        PFint tmp = shortLen;
-        shortLen = longLen;
-        longLen = tmp;
-        yLonger = 1;
+        return depthTest ? Rasterize_Line_THICK_DEPTH : Rasterize_Line_THICK_NODEPTH;
     }
 
-    // ICANT
-    if (longLen == 0.f) longLen = 0.1;
-    PFfloat invEndVal = 1.0f/longLen;
-    PFint endVal = longLen;
-    PFint sgnInc = 1;
-
-    if (longLen < 0)
+    if (currentCtx->state & PF_LINE_SMOOTH)
     {
-        longLen = -longLen;
-        sgnInc = -1;
+        return depthTest ? Rasterize_Line_SMOOTH_DEPTH : Rasterize_Line_SMOOTH_NODEPTH;
     }
 
-    PFint decInc = (longLen == 0.f) ? 0
-        : (shortLen << 16) / longLen;
+    return depthTest ? Rasterize_Line_DEPTH : Rasterize_Line_NODEPTH;
+}
 
-    PFint j = 0;
-    if (yLonger)
-    {	
-        for (PFint i = 0; i != endVal; i += sgnInc, j += decInc)
-        {
-            PFfloat t = (PFfloat)i*invEndVal;
+// NOTE: Declares, for each pixel of the walk inside the bounds, its index 'i' in the line,
+//       its coordinates 'x' and 'y' and its offset 'pOffset' in a framebuffer of width 'wDst'
+#define BEGIN_LINE_LOOP(walk) \
+    for (PFint i = (walk).first, j = i*(walk).minorInc; i <= (walk).last; i++, j += (walk).minorInc) \
+    { \
+        PFint x = (walk).x + i*(walk).xStep + (j >> 16)*(walk).xMinor; \
+        PFint y = (walk).y + i*(walk).yStep + (j >> 16)*(walk).yMinor; \
+        if (x < (walk).xMin || x > (walk).xMax || y < (walk).yMin || y > (walk).yMax) continue; \
+        PFsizei pOffset = y*wDst + x;
+
+// NOTE: Same as 'BEGIN_LINE_LOOP' for the center of a span of pixels along the minor axis,
+//       '(sMin, sMax)' is the part of '(-halfWidth, halfWidth)' inside the bounds
+#define BEGIN_SPAN_LOOP(walk, halfWidth) \
+    for (PFint i = (walk).first, j = i*(walk).minorInc; i <= (walk).last; i++, j += (walk).minorInc) \
+    { \
+        PFint x = (walk).x + i*(walk).xStep + (j >> 16)*(walk).xMinor; \
+        PFint y = (walk).y + i*(walk).yStep + (j >> 16)*(walk).yMinor; \
+        PFint minor = (walk).xMinor ? x : y; \
+        PFint sMin = MAX(-(halfWidth), (walk).minorMin - minor); \
+        PFint sMax = MIN((halfWidth), (walk).minorMax - minor); \
+        PFsizei pOffset = y*wDst + x;
+
+#define END_LOOP() \
+    }
 
-            PFint x = x1 + (j >> 16), y = y1 + i;
-            PFfloat z = z1 + t*(z2 - z1);
+void Rasterize_Line_NODEPTH(const PFvertex* v1, const PFvertex* v2)
+{
+    PFlinewalk walk;
+    if (!Helper_InitLineWalk(&walk, v1, v2)) return;
 
-            PFsizei pOffset = (PFint)y*wDst + (PFint)x;
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFsizei wDst = texDst->width;
 
-            PFcolor finalColor = Helper_LerpColor(c1, c2, t);
+    PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
+        currentCtx->blendFunction : NULL;
 
-            if (blendFunc) finalColor = blendFunc(
-                finalColor, pixelGetter(bufDst, pOffset));
+    if (Helper_IsFlatLine(v1, v2))
+    {
+        PFcolor color = v1->color;
 
-            pixelSetter(bufDst, pOffset, finalColor);
-            zbDst[pOffset] = z;
+        if (blendFunc == NULL)
+        {
+            BEGIN_LINE_LOOP(walk)
+                Pixel_Set(texDst, dstFormat, pOffset, color);
+            END_LOOP()
+        }
+        else
+        {
+            BEGIN_LINE_LOOP(walk)
+                Pixel_Set(texDst, dstFormat, pOffset, blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset)));
+            END_LOOP()
         }
     }
     else
     {
-        for (PFint i = 0; i != endVal; i += sgnInc, j += decInc)
-        {
-            PFfloat t = (PFfloat)i*invEndVal;
-
-            PFint x = x1 + i, y = y1 + (j >> 16);
-            PFfloat z = z1 + t*(z2 - z1);
-
-            PFsizei pOffset = (PFint)y*wDst + (PFint)x;
-
-            PFcolor finalColor = Helper_LerpColor(c1, c2, t);
-
-            if (blendFunc) finalColor = blendFunc(
-                finalColor, pixelGetter(bufDst, pOffset));
-
-            pixelSetter(bufDst, pOffset, finalColor);
-            zbDst[pOffset] = z;
-        }
+        PFlinecolor lineColor;
+        Helper_InitLineColor(&lineColor, v1->color, v2->color, walk.count);
+
+        BEGIN_LINE_LOOP(walk)
+            PFcolor color = Helper_GetLineColor(&lineColor, i);
+            if (blendFunc) color = blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset));
+            Pixel_Set(texDst, dstFormat, pOffset, color);
+        END_LOOP()
     }
 }
 
 void Rasterize_Line_DEPTH(const PFvertex* v1, const PFvertex* v2)
 {
-    /* Get Some Values*/
+    PFlinewalk walk;
+    if (!Helper_InitLineWalk(&walk, v1, v2)) return;
 
     PFframebuffer *fbDst = currentCtx->currentFramebuffer;
-
-    PFpixelsetter pixelSetter = fbDst->texture.pixelSetter;
-    PFpixelgetter pixelGetter = fbDst->texture.pixelGetter;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFsizei wDst = texDst->width;
+    PFfloat *zbDst = fbDst->zbuffer;
 
     PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
         currentCtx->blendFunction : NULL;
 
-    void *bufDst = fbDst->texture.pixels;
-    PFsizei wDst = fbDst->texture.width;
-    PFfloat *zbDst = fbDst->zbuffer;
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    const PFboolean raiseDepth = !Depth_IsLessTest(depthFunc);
 
-    PFint x1 = v1->screen[0], y1 = v1->screen[1];
-    PFint x2 = v2->screen[0], y2 = v2->screen[1];
     PFfloat z1 = v1->homogeneous[2];
-    PFfloat z2 = v2->homogeneous[2];
-    PFcolor c1 = v1->color;
-    PFcolor c2 = v2->color;
-
-    /* Draw Line */
-
-    PFint shortLen = y2 - y1;
-    PFint longLen = x2 - x1;
-    PFboolean yLonger = 0;
-
-    if (abs(shortLen) > abs(longLen))
-    {
-        PFint tmp = shortLen;
-        shortLen = longLen;
-        longLen = tmp;
-        yLonger = 1;
-    }
-
-    PFfloat invEndVal = 1.0f/(longLen == 0.f ? 0.2 : longLen);
-    PFint endVal = longLen;
-    PFint sgnInc = 1;
-
-    if (longLen < 0.f)
-    {
-        longLen = -longLen;
-        sgnInc = -1;
-    }
-
-    PFint decInc = ((PFint)longLen == 0) ? 0
-        : (PFint)(shortLen << 16) / (PFint)longLen;
+    PFfloat zInc = (v2->homogeneous[2] - z1)/walk.count;
 
-    PFint j = 0;
-    if (yLonger)
-    {	
-        for (PFint i = 0; i != endVal; i += sgnInc, j += decInc)
-        {
-            PFfloat t = (PFfloat)i*invEndVal;
+    PFboolean flat = Helper_IsFlatLine(v1, v2);
 
-            PFint x = x1 + (j >> 16), y = y1 + i;
-            PFfloat z = z1 + t*(z2 - z1);
+    PFlinecolor lineColor;
+    Helper_InitLineColor(&lineColor, v1->color, v2->color, walk.count);
 
-            PFsizei pOffset = (PFint)y*wDst + (PFint)x;
-            if (currentCtx->depthFunction(z, zbDst[pOffset]))
-            {
-                PFcolor finalColor = Helper_LerpColor(c1, c2, t);
+    BEGIN_LINE_LOOP(walk)
+        PFfloat z = z1 + i*zInc;
 
-                if (blendFunc) finalColor = blendFunc(
-                    finalColor, pixelGetter(bufDst, pOffset));
+        Depth_ResolveTile(fbDst, x, y);
 
-                pixelSetter(bufDst, pOffset, finalColor);
-                zbDst[pOffset] = z;
-            }
-        }
-    }
-    else
-    {
-        for (PFint i = 0; i != endVal; i += sgnInc, j += decInc)
+        if (Depth_Test(depthFunc, z, zbDst[pOffset]))
         {
-            PFfloat t = (PFfloat)i*invEndVal;
-
-            PFint x = x1 + i, y = y1 + (j >> 16);
-            PFfloat z = z1 + t*(z2 - z1);
+            PFcolor color = flat ? v1->color : Helper_GetLineColor(&lineColor, i);
+            if (blendFunc) color = blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset));
+            Pixel_Set(texDst, dstFormat, pOffset, color);
 
-            PFsizei pOffset = (PFint)y*wDst + (PFint)x;
-            if (currentCtx->depthFunction(z, zbDst[pOffset]))
-            {
-                PFcolor finalColor = Helper_LerpColor(c1, c2, t);
-
-                if (blendFunc) finalColor = blendFunc(
-                    finalColor, pixelGetter(bufDst, pOffset));
-
-                pixelSetter(bufDst, pOffset, finalColor);
-                zbDst[pOffset] = z;
-            }
+            zbDst[pOffset] = z;
+            if (raiseDepth) Depth_RaiseTile(fbDst, x, y, z);
         }
-    }
+    END_LOOP()
 }
 
-// TODO REVIEW: Can be highly optimized
+// NOTE: Thick lines are spans along the minor axis centered on the pixels of the thin line,
+//       the pixels of a span take the color and the depth of its center
 void Rasterize_Line_THICK_NODEPTH(const PFvertex* v1, const PFvertex* v2)
 {
-    PFvertex tv1, tv2;
+    PFlinewalk walk;
+    if (!Helper_InitLineWalk(&walk, v1, v2)) return;
 
-    PFint x1 = v1->screen[0], y1 = v1->screen[1];
-    PFint x2 = v2->screen[0], y2 = v2->screen[1];
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFsizei wDst = texDst->width;
 
-    PFint dx = x2 - x1, dy = y2 - y1;
+    PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
+        currentCtx->blendFunction : NULL;
 
-    PFint thickness = (PFint)(currentCtx->lineWidth + 0.5f);
+    PFint halfWidth = Helper_GetLineHalfWidth(&walk, v1, v2);
+    PFint sStride = walk.xMinor ? 1 : (PFint)wDst;
 
-    Rasterize_Line_DEPTH(v1, v2);
+    PFboolean flat = Helper_IsFlatLine(v1, v2);
 
-    if (dx != 0 && abs(dy / dx) < 1)
-    {
-        PFint wy = (thickness - 1)*sqrtf(dx*dx + dy*dy) / (2*abs(dx));
+    PFlinecolor lineColor;
+    Helper_InitLineColor(&lineColor, v1->color, v2->color, walk.count);
 
-        for (PFint i = 1; i <= wy; i++)
-        {
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[1] -= i;
-            tv2.screen[1] -= i;
-            Rasterize_Line_NODEPTH(&tv1, &tv2);
-
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[1] += i;
-            tv2.screen[1] += i;
-            Rasterize_Line_NODEPTH(&tv1, &tv2);
-        }
-    }
-    else if (dy != 0)
-    {
-        PFint wx = (thickness - 1)*sqrtf(dx*dx + dy*dy) / (2*abs(dy));
+    BEGIN_SPAN_LOOP(walk, halfWidth)
+        PFcolor color = flat ? v1->color : Helper_GetLineColor(&lineColor, i);
 
-        for (PFint i = 1; i <= wx; i++)
+        for (PFint s = sMin; s <= sMax; s++)
         {
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[0] -= i;
-            tv2.screen[0] -= i;
-            Rasterize_Line_NODEPTH(&tv1, &tv2);
-
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[0] += i;
-            tv2.screen[0] += i;
-            Rasterize_Line_NODEPTH(&tv1, &tv2);
+            PFsizei sOffset = pOffset + s*sStride;
+            PFcolor finalColor = blendFunc ? blendFunc(color, Pixel_Get(texDst, dstFormat, sOffset)) : color;
+            Pixel_Set(texDst, dstFormat, sOffset, finalColor);
         }
-    }
+    END_LOOP()
 }
 
-// TODO REVIEW: Can be highly optimized
 void Rasterize_Line_THICK_DEPTH(const PFvertex* v1, const PFvertex* v2)
 {
-    PFvertex tv1, tv2;
+    PFlinewalk walk;
+    if (!Helper_InitLineWalk(&walk, v1, v2)) return;
 
-    PFint x1 = v1->screen[0], y1 = v1->screen[1];
-    PFint x2 = v2->screen[0], y2 = v2->screen[1];
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFsizei wDst = texDst->width;
+    PFfloat *zbDst = fbDst->zbuffer;
 
-    PFint dx = x2 - x1, dy = y2 - y1;
+    PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
+        currentCtx->blendFunction : NULL;
 
-    PFint thickness = (PFint)(currentCtx->lineWidth + 0.5f);
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    const PFboolean raiseDepth = !Depth_IsLessTest(depthFunc);
+
+    PFfloat z1 = v1->homogeneous[2];
+    PFfloat zInc = (v2->homogeneous[2] - z1)/walk.count;
 
-    Rasterize_Line_DEPTH(v1, v2);
+    PFint halfWidth = Helper_GetLineHalfWidth(&walk, v1, v2);
+    PFint sStride = walk.xMinor ? 1 : (PFint)wDst;
 
-    if (dx != 0 && abs(dy / dx) < 1)
-    {
-        PFint wy = (thickness - 1)*sqrtf(dx*dx + dy*dy) / (2*abs(dx));
+    PFboolean flat = Helper_IsFlatLine(v1, v2);
 
-        for (PFint i = 1; i <= wy; i++)
-        {
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[1] -= i;
-            tv2.screen[1] -= i;
-            Rasterize_Line_DEPTH(&tv1, &tv2);
-
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[1] += i;
-            tv2.screen[1] += i;
-            Rasterize_Line_DEPTH(&tv1, &tv2);
-        }
-    }
-    else if (dy != 0)
-    {
-        PFint wx = (thickness - 1)*sqrtf(dx*dx + dy*dy) / (2*abs(dy));
+    PFlinecolor lineColor;
+    Helper_InitLineColor(&lineColor, v1->color, v2->color, walk.count);
 
-        for (PFint i = 1; i <= wx; i++)
+    BEGIN_SPAN_LOOP(walk, halfWidth)
+        PFfloat z = z1 + i*zInc;
+        PFcolor color = flat ? v1->color : Helper_GetLineColor(&lineColor, i);
+
+        for (PFint s = sMin; s <= sMax; s++)
         {
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[0] -= i;
-            tv2.screen[0] -= i;
-            Rasterize_Line_DEPTH(&tv1, &tv2);
-
-            tv1 = *v1, tv2 = *v2;
-            tv1.screen[0] += i;
-            tv2.screen[0] += i;
-            Rasterize_Line_DEPTH(&tv1, &tv2);
+            PFsizei sOffset = pOffset + s*sStride;
+            PFint sx = x + s*walk.xMinor, sy = y + s*walk.yMinor;
+
+            Depth_ResolveTile(fbDst, sx, sy);
+
+            if (Depth_Test(depthFunc, z, zbDst[sOffset]))
+            {
+                PFcolor finalColor = blendFunc ? blendFunc(color, Pixel_Get(texDst, dstFormat, sOffset)) : color;
+                Pixel_Set(texDst, dstFormat, sOffset, finalColor);
+
+                zbDst[sOffset] = z;
+                if (raiseDepth) Depth_RaiseTile(fbDst, sx, sy, z);
+            }
         }
-    }
+    END_LOOP()
+}
+
+#undef BEGIN_LINE_LOOP
+#undef BEGIN_SPAN_LOOP
+#undef END_LOOP
+
+void Rasterize_Line_SMOOTH_NODEPTH(const PFvertex* v1, const PFvertex* v2)
+{
+    Helper_RasterizeLineSmooth(v1, v2, PF_FALSE);
+}
+
+void Rasterize_Line_SMOOTH_DEPTH(const PFvertex* v1, const PFvertex* v2)
+{
+    Helper_RasterizeLineSmooth(v1, v2, PF_TRUE);
 }
 
 
@@ -501,11 +465,13 @@ void Helper_SwapByte(PFubyte* a, PFubyte* b)
 
 static PFubyte Helper_EncodeClip2D(const PFMvec2 screen, PFint xMin, PFint yMin, PFint xMax, PFint yMax)
 {
+    // NOTE: The max bounds are the last pixels, so the coordinates inside them
+    //       go up to the far side of these pixels (e.g. 47.5 is still in pixel 47)
     PFubyte code = CLIP_INSIDE;
     if (screen[0] < xMin) code |= CLIP_LEFT;
-    if (screen[0] > xMax) code |= CLIP_RIGHT;
+    if (screen[0] >= xMax + 1) code |= CLIP_RIGHT;
     if (screen[1] < yMin) code |= CLIP_TOP;
-    if (screen[1] > yMax) code |= CLIP_BOTTOM;
+    if (screen[1] >= yMax + 1) code |= CLIP_BOTTOM;
     return code;
 }
 
@@ -533,13 +499,171 @@ static PFboolean Helper_ClipCoord3D(PFfloat q, PFfloat p, PFfloat* t1, PFfloat*
     return PF_TRUE;
 }
 
-PFcolor Helper_LerpColor(PFcolor a, PFcolor b, PFfloat t)
+PFboolean Helper_InitLineWalk(PFlinewalk* walk, const PFvertex* v1, const PFvertex* v2)
+{
+    const PFtexture *texDst = &currentCtx->currentFramebuffer->texture;
+
+    walk->xMin = MAX(currentCtx->vpMin[0], 0);
+    walk->yMin = MAX(currentCtx->vpMin[1], 0);
+    walk->xMax = MIN(currentCtx->vpMax[0], (PFint)texDst->width - 1);
+    walk->yMax = MIN(currentCtx->vpMax[1], (PFint)texDst->height - 1);
+
+    PFint x1 = v1->screen[0], y1 = v1->screen[1];
+    PFint x2 = v2->screen[0], y2 = v2->screen[1];
+    PFint dx = x2 - x1, dy = y2 - y1;
+
+    walk->x = x1, walk->y = y1;
+
+    PFint majorStart, majorMin, majorMax, majorStep;
+
+    if (abs(dy) > abs(dx))
+    {
+        walk->count = abs(dy);
+        walk->xStep = 0, walk->yStep = (dy < 0) ? -1 : 1;
+        walk->xMinor = 1, walk->yMinor = 0;
+        walk->minorInc = dx*65536/walk->count;
+        walk->minorMin = walk->xMin, walk->minorMax = walk->xMax;
+        majorStart = y1, majorMin = walk->yMin, majorMax = walk->yMax, majorStep = walk->yStep;
+    }
+    else
+    {
+        walk->count = abs(dx);
+        if (walk->count == 0) return PF_FALSE;
+        walk->xStep = (dx < 0) ? -1 : 1, walk->yStep = 0;
+        walk->xMinor = 0, walk->yMinor = 1;
+        walk->minorInc = dy*65536/walk->count;
+        walk->minorMin = walk->yMin, walk->minorMax = walk->yMax;
+        majorStart = x1, majorMin = walk->xMin, majorMax = walk->xMax, majorStep = walk->xStep;
+    }
+
+    // NOTE: The pixels are clipped here on the major axis, on the minor one they are tested
+    //       by the loops, the clipped vertices can still be one pixel outside the bounds
+    if (majorStep > 0)
+    {
+        walk->first = MAX(0, majorMin - majorStart);
+        walk->last = MIN(walk->count - 1, majorMax - majorStart);
+    }
+    else
+    {
+        walk->first = MAX(0, majorStart - majorMax);
+        walk->last = MIN(walk->count - 1, majorStart - majorMin);
+    }
+
+    return walk->first <= walk->last;
+}
+
+PFint Helper_GetLineHalfWidth(const PFlinewalk* walk, const PFvertex* v1, const PFvertex* v2)
+{
+    PFint dx = (PFint)v2->screen[0] - (PFint)v1->screen[0];
+    PFint dy = (PFint)v2->screen[1] - (PFint)v1->screen[1];
+
+    PFint thickness = (PFint)(currentCtx->lineWidth + 0.5f);
+
+    // NOTE: Spans are measured along the minor axis, they are widened by the slope of the line
+    return (thickness - 1)*sqrtf(dx*dx + dy*dy)/(2*walk->count);
+}
+
+PFboolean Helper_IsFlatLine(const PFvertex* v1, const PFvertex* v2)
+{
+    return v1->color.r == v2->color.r && v1->color.g == v2->color.g
+        && v1->color.b == v2->color.b && v1->color.a == v2->color.a;
+}
+
+void Helper_InitLineColor(PFlinecolor* lineColor, PFcolor c1, PFcolor c2, PFint count)
+{
+    lineColor->r = c1.r << 16, lineColor->dr = ((PFint)c2.r - c1.r)*65536/count;
+    lineColor->g = c1.g << 16, lineColor->dg = ((PFint)c2.g - c1.g)*65536/count;
+    lineColor->b = c1.b << 16, lineColor->db = ((PFint)c2.b - c1.b)*65536/count;
+    lineColor->a = c1.a << 16, lineColor->da = ((PFint)c2.a - c1.a)*65536/count;
+}
+
+PFcolor Helper_GetLineColor(const PFlinecolor* lineColor, PFint i)
 {
     return (PFcolor) {
-        a.r + t*(b.r - a.r),
-        a.g + t*(b.g - a.g),
-        a.b + t*(b.b - a.b),
-        a.a + t*(b.a - a.a)
+        (PFubyte)((lineColor->r + i*lineColor->dr) >> 16),
+        (PFubyte)((lineColor->g + i*lineColor->dg) >> 16),
+        (PFubyte)((lineColor->b + i*lineColor->db) >> 16),
+        (PFubyte)((lineColor->a + i*lineColor->da) >> 16)
     };
 }
 
+// NOTE: Xiaolin Wu's algorithm, each pixel of the major axis covers the two pixels of the minor
+//       axis closest to the line, weighted by their distance. The coverage scales the alpha, then
+//       the pixels are blended with the current function, or 'pfBlendAlpha' if blending is disabled.
+void Helper_RasterizeLineSmooth(const PFvertex* v1, const PFvertex* v2, PFboolean depthTest)
+{
+    PFlinewalk walk;
+    if (!Helper_InitLineWalk(&walk, v1, v2)) return;
+
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFsizei wDst = texDst->width;
+    PFfloat *zbDst = fbDst->zbuffer;
+
+    PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
+        currentCtx->blendFunction : pfBlendAlpha;
+
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    const PFboolean raiseDepth = !Depth_IsLessTest(depthFunc);
+
+    PFfloat z1 = v1->homogeneous[2];
+    PFfloat zInc = (v2->homogeneous[2] - z1)/walk.count;
+
+    PFboolean flat = Helper_IsFlatLine(v1, v2);
+
+    PFlinecolor lineColor;
+    Helper_InitLineColor(&lineColor, v1->color, v2->color, walk.count);
+
+    // The minor coordinate is taken at the center of the pixels of the major axis, minus half a
+    // pixel, so that its integer part is the first pixel covered and its fraction the coverage
+    // of the second one (16.16)
+
+    PFboolean yMajor = (walk.yStep != 0);
+
+    PFint majorStart = yMajor ? walk.y : walk.x;
+    PFint majorStep = yMajor ? walk.yStep : walk.xStep;
+
+    PFfloat a1 = v1->screen[yMajor], a2 = v2->screen[yMajor];
+    PFfloat b1 = v1->screen[!yMajor], b2 = v2->screen[!yMajor];
+    PFfloat slope = (b2 - b1)/(a2 - a1);
+
+    PFint minorStart = (PFint)((b1 + ((PFfloat)majorStart + 0.5f - a1)*slope - 0.5f)*65536.0f);
+    PFint minorInc = (PFint)(majorStep*slope*65536.0f);
+
+    for (PFint i = walk.first; i <= walk.last; i++)
+    {
+        PFint major = majorStart + i*majorStep;
+        PFint minorFixed = minorStart + i*minorInc;
+        PFint coverage = (minorFixed >> 8) & 0xFF;
+
+        PFfloat z = z1 + i*zInc;
+        PFcolor color = flat ? v1->color : Helper_GetLineColor(&lineColor, i);
+
+        for (PFint k = 0; k < 2; k++)
+        {
+            PFint minor = (minorFixed >> 16) + k;
+            PFint weight = k ? coverage : 255 - coverage;
+
+            if (weight == 0 || minor < walk.minorMin || minor > walk.minorMax) continue;
+
+            PFint x = yMajor ? minor : major;
+            PFint y = yMajor ? major : minor;
+            PFsizei pOffset = y*wDst + x;
+
+            if (depthTest) Depth_ResolveTile(fbDst, x, y);
+            if (depthTest && !Depth_Test(depthFunc, z, zbDst[pOffset])) continue;
+
+            PFcolor source = color;
+            source.a = (PFubyte)((color.a*(weight + 1)) >> 8);
+
+            Pixel_Set(texDst, dstFormat, pOffset, blendFunc(source, Pixel_Get(texDst, dstFormat, pOffset)));
+
+            if (depthTest)
+            {
+                zbDst[pOffset] = z;
+                if (raiseDepth) Depth_RaiseTile(fbDst, x, y, z);
+            }
+        }
+    }
+}
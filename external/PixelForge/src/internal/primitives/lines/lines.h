@@ -23,12 +23,21 @@
 #include "../../context.h"
 #include "../../../pfm.h"
 
+typedef void (*PFlinefunc)(const PFvertex* v1, const PFvertex* v2);
+
 void Process_ProjectAndClipLine(PFvertex* line, int_fast8_t* vertexCounter);
 
+// NOTE: Returns the rasterizer matching the current line width, smoothing and depth test.
+//       The NODEPTH variants don't read or write the depth buffer.
+PFlinefunc Rasterize_GetLineFunc(void);
+
 void Rasterize_Line_NODEPTH(const PFvertex* v1, const PFvertex* v2);
 void Rasterize_Line_DEPTH(const PFvertex* v1, const PFvertex* v2);
 
 void Rasterize_Line_THICK_NODEPTH(const PFvertex* v1, const PFvertex* v2);
 void Rasterize_Line_THICK_DEPTH(const PFvertex* v1, const PFvertex* v2);
 
+void Rasterize_Line_SMOOTH_NODEPTH(const PFvertex* v1, const PFvertex* v2);
+void Rasterize_Line_SMOOTH_DEPTH(const PFvertex* v1, const PFvertex* v2);
+
 #endif //PF_LINES_H
@@ -0,0 +1,166 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you
+ *  wrote the original software. If you use this software in a product, an acknowledgment
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "./pixels.h"
+#include "../../pixel.h"
+#include "../../depth.h"
+#include "../../blend.h"
+#include <string.h>
+
+/* Including internal function prototypes */
+
+extern PFsizei pfInternal_GetPixelBytes(PFpixelformat format);
+
+
+/* Internal helper function declarations */
+
+static void Helper_CopySpan(PFubyte* dst, const PFubyte* src, const PFint* srcX, PFint count, PFsizei bpp);
+
+
+/* Pixel rectangle rasterization function */
+
+// NOTE: The columns are processed by spans of 'PF_BLIT_SPAN_SIZE' pixels, the source column of
+//       each pixel of the span is computed once in a table used by all the rows. Without depth
+//       test and blending, the rows of a source of the same format as the framebuffer are copied
+//       ('memcpy' if not scaled horizontally), the rows of another built-in format not scaled
+//       horizontally are converted with 'pfConvertPixels', the other ones pixel by pixel.
+void Rasterize_PixelRect(const PFtexture* source, const PFint bounds[4], PFint xScreen, PFint yScreen,
+                         const PFfloat zoom[2], PFfloat z, PFboolean overlay)
+{
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    PFtexture *texDst = &fbDst->texture;
+    PFfloat *zbDst = fbDst->zbuffer;
+    PFsizei wDst = texDst->width;
+
+    PFint xMin = bounds[0], yMin = bounds[1];
+    PFint xMax = bounds[2], yMax = bounds[3];
+
+    PFint width = source->width, height = source->height;
+
+    // Get the formats of the source and destination that can be accessed directly
+    PFpixelformat srcFormat = pfInternal_GetDirectPixelFormat(source);
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+
+    PFblendfunc blendFunction = (currentCtx->state & PF_BLEND) ? currentCtx->blendFunction : NULL;
+    PFblendkernel blendKernel = Blend_GetKernel(blendFunction, dstFormat);
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    PFboolean depthTest = !overlay && (currentCtx->state & PF_DEPTH_TEST);
+
+    // NOTE: The pixels are copied as they are if both formats are the same built-in one,
+    //       and the rows not scaled horizontally are converted at once if they differ
+    PFboolean direct = !depthTest && !blendFunction && srcFormat != PF_PIXELFORMAT_UNKNOWN && dstFormat != PF_PIXELFORMAT_UNKNOWN;
+    PFboolean copy = direct && srcFormat == dstFormat;
+    PFsizei srcBpp = direct ? pfInternal_GetPixelBytes(srcFormat) : 0;
+    PFsizei dstBpp = direct ? pfInternal_GetPixelBytes(dstFormat) : 0;
+
+    PFint srcX[PF_BLIT_SPAN_SIZE];
+
+    for (PFint xSpan = xMin; xSpan <= xMax; xSpan += PF_BLIT_SPAN_SIZE)
+    {
+        PFint count = MIN(PF_BLIT_SPAN_SIZE, xMax - xSpan + 1);
+
+        // NOTE: Divided by the zoom rather than scaled by its inverse, so that the columns are
+        //       exact for integer zooms (no column repeated or skipped by the rounding)
+        for (PFint i = 0; i < count; i++)
+        {
+            srcX[i] = MIN((PFint)((PFfloat)(xSpan + i - xScreen)/zoom[0]), width - 1);
+        }
+
+        // NOTE: The source columns never decrease, so they follow each other if the span isn't scaled
+        PFboolean contiguous = (srcX[count - 1] - srcX[0] == count - 1);
+
+#       ifdef PF_SUPPORT_OPENMP
+#           pragma omp parallel for if ((yMax - yMin)*count >= PF_OPENMP_RASTER_THRESHOLD_AREA)
+#       endif //PF_SUPPORT_OPENMP
+        for (PFint y = yMin; y <= yMax; y++)
+        {
+            PFsizei ySrcOffset = MIN((PFint)((PFfloat)(y - yScreen)/zoom[1]), height - 1)*width;
+            PFsizei yDstOffset = y*wDst + xSpan;
+
+            if (copy)
+            {
+                PFubyte *dst = (PFubyte*)texDst->pixels + yDstOffset*dstBpp;
+                const PFubyte *src = (const PFubyte*)source->pixels + ySrcOffset*srcBpp;
+
+                if (contiguous) memcpy(dst, src + srcX[0]*srcBpp, count*srcBpp);
+                else Helper_CopySpan(dst, src, srcX, count, srcBpp);
+            }
+            else if (direct && contiguous)
+            {
+                pfConvertPixels((PFubyte*)texDst->pixels + yDstOffset*dstBpp, dstFormat,
+                    (const PFubyte*)source->pixels + (ySrcOffset + srcX[0])*srcBpp, srcFormat, count);
+            }
+            else
+            {
+                for (PFint i = 0; i < count; i++)
+                {
+                    PFsizei xyDstOffset = yDstOffset + i;
+
+                    if (depthTest && !Depth_Test(depthFunc, z, zbDst[xyDstOffset])) continue;
+                    if (depthTest) zbDst[xyDstOffset] = z;
+
+                    PFcolor color = Pixel_Get(source, srcFormat, ySrcOffset + srcX[i]);
+
+                    if (blendKernel)
+                    {
+                        Blend_Pixel(texDst->pixels, dstFormat, xyDstOffset, color, blendKernel);
+                    }
+                    else
+                    {
+                        Pixel_Set(texDst, dstFormat, xyDstOffset, blendFunction
+                            ? blendFunction(color, Pixel_Get(texDst, dstFormat, xyDstOffset)) : color);
+                    }
+                }
+            }
+
+            // NOTE: Without depth test the depths are written anyway, as by the triangle rasterizer
+            if (!depthTest && !overlay)
+            {
+                PFfloat *zRow = zbDst + yDstOffset;
+                for (PFint i = 0; i < count; i++) zRow[i] = z;
+            }
+        }
+    }
+}
+
+
+/* Internal helper function definitions */
+
+// NOTE: Constant pixel sizes so that each pixel is copied with a single load and store
+void Helper_CopySpan(PFubyte* dst, const PFubyte* src, const PFint* srcX, PFint count, PFsizei bpp)
+{
+    switch (bpp)
+    {
+        case 2:
+            for (PFint i = 0; i < count; i++) memcpy(dst + i*2, src + srcX[i]*2, 2);
+            break;
+
+        case 3:
+            for (PFint i = 0; i < count; i++) memcpy(dst + i*3, src + srcX[i]*3, 3);
+            break;
+
+        case 4:
+            for (PFint i = 0; i < count; i++) memcpy(dst + i*4, src + srcX[i]*4, 4);
+            break;
+
+        default:
+            for (PFint i = 0; i < count; i++) memcpy(dst + i*bpp, src + srcX[i]*bpp, bpp);
+            break;
+    }
+}
@@ -18,6 +18,8 @@
  */
 
 #include "./points.h"
+#include "../../pixel.h"
+#include "../../depth.h"
 
 /* Including internal function prototypes */
 
@@ -57,13 +59,12 @@ void Rasterize_Point_NODEPTH(const PFvertex* point)
 {
     PFframebuffer *fbDst = currentCtx->currentFramebuffer;
 
-    PFpixelsetter pixelSetter = fbDst->texture.pixelSetter;
-    PFpixelgetter pixelGetter = fbDst->texture.pixelGetter;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
 
     PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
         currentCtx->blendFunction : NULL;
 
-    void *pbDst = fbDst->texture.pixels;
     PFfloat *zbDst = fbDst->zbuffer;
 
     PFsizei wDst = fbDst->texture.width;
@@ -76,16 +77,21 @@ void Rasterize_Point_NODEPTH(const PFvertex* point)
 
     if (currentCtx->pointSize <= 1.0f)
     {
+        Depth_ResolveTile(fbDst, cx, cy);
+
         PFsizei pOffset = cy*wDst + cx;
-        pixelSetter(pbDst, pOffset, blendFunc
-            ? blendFunc(color, pixelGetter(pbDst, pOffset)) : color);
+        Pixel_Set(texDst, dstFormat, pOffset, blendFunc
+            ? blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset)) : color);
         zbDst[pOffset] = z;
+        Depth_RaiseTile(fbDst, cx, cy, z);
         return;
     }
 
     PFfloat r = currentCtx->pointSize*0.5f;
     PFfloat rSq = r*r;
 
+    Depth_ResolveTiles(fbDst, cx - (PFint)r, cy - (PFint)r, cx + (PFint)r, cy + (PFint)r);
+
     for (PFint y = -r; y <= r; y++)
     {
         for (PFint x = -r; x <= r; x++)
@@ -96,9 +102,10 @@ void Rasterize_Point_NODEPTH(const PFvertex* point)
                 if (px < wDst && py < hDst)
                 {
                     PFsizei pOffset = py*wDst + px;
-                    pixelSetter(pbDst, pOffset, blendFunc
-                        ? blendFunc(color, pixelGetter(pbDst, pOffset)) : color);
+                    Pixel_Set(texDst, dstFormat, pOffset, blendFunc
+                        ? blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset)) : color);
                     zbDst[pOffset] = z;
+                    Depth_RaiseTile(fbDst, px, py, z);
                 }
             }
         }
@@ -109,13 +116,12 @@ void Rasterize_Point_DEPTH(const PFvertex* point)
 {
     PFframebuffer *fbDst = currentCtx->currentFramebuffer;
 
-    PFpixelsetter pixelSetter = fbDst->texture.pixelSetter;
-    PFpixelgetter pixelGetter = fbDst->texture.pixelGetter;
+    const PFtexture *texDst = &fbDst->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
 
     PFblendfunc blendFunc = currentCtx->state & PF_BLEND ?
         currentCtx->blendFunction : NULL;
 
-    void *pbDst = fbDst->texture.pixels;
     PFfloat *zbDst = fbDst->zbuffer;
 
     PFsizei wDst = fbDst->texture.width;
@@ -126,14 +132,20 @@ void Rasterize_Point_DEPTH(const PFvertex* point)
     PFfloat z = point->homogeneous[2];
     PFcolor color = point->color;
 
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    const PFboolean raiseDepth = !Depth_IsLessTest(depthFunc);
+
     if (currentCtx->pointSize <= 1.0f)
     {
+        Depth_ResolveTile(fbDst, cx, cy);
+
         PFsizei pOffset = cy*wDst + cx;
-        if (currentCtx->depthFunction(z, zbDst[pOffset]))
+        if (Depth_Test(depthFunc, z, zbDst[pOffset]))
         {
-            pixelSetter(pbDst, pOffset, blendFunc
-                ? blendFunc(color, pixelGetter(pbDst, pOffset)) : color);
+            Pixel_Set(texDst, dstFormat, pOffset, blendFunc
+                ? blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset)) : color);
             zbDst[pOffset] = z;
+            if (raiseDepth) Depth_RaiseTile(fbDst, cx, cy, z);
         }
 
         return;
@@ -142,6 +154,8 @@ void Rasterize_Point_DEPTH(const PFvertex* point)
     PFfloat r = currentCtx->pointSize*0.5f;
     PFfloat rSq = r*r;
 
+    Depth_ResolveTiles(fbDst, cx - (PFint)r, cy - (PFint)r, cx + (PFint)r, cy + (PFint)r);
+
     for (PFint y = -r; y <= r; y++)
     {
         for (PFint x = -r; x <= r; x++)
@@ -152,11 +166,12 @@ void Rasterize_Point_DEPTH(const PFvertex* point)
                 if (px < wDst && py < hDst)
                 {
                     PFsizei pOffset = py*wDst + px;
-                    if (currentCtx->depthFunction(z, zbDst[pOffset]))
+                    if (Depth_Test(depthFunc, z, zbDst[pOffset]))
                     {
-                        pixelSetter(pbDst, pOffset, blendFunc
-                            ? blendFunc(color, pixelGetter(pbDst, pOffset)) : color);
+                        Pixel_Set(texDst, dstFormat, pOffset, blendFunc
+                            ? blendFunc(color, Pixel_Get(texDst, dstFormat, pOffset)) : color);
                         zbDst[pOffset] = z;
+                        if (raiseDepth) Depth_RaiseTile(fbDst, px, py, z);
                     }
                 }
             }
@@ -0,0 +1,213 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you
+ *  wrote the original software. If you use this software in a product, an acknowledgment
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "./rects.h"
+#include "../../pixel.h"
+#include "../../depth.h"
+#include "../../blend.h"
+#include <string.h>
+
+/* Including internal function prototypes */
+
+extern PFsizei pfInternal_GetPixelBytes(PFpixelformat format);
+
+
+/* Internal helper function declarations */
+
+static void Helper_FillSpans(PFtexture* texture, PFpixelformat format, const PFint bounds[4], PFcolor color);
+static void Helper_BlendSpans(PFtexture* texture, PFpixelformat format, const PFint bounds[4], PFcolor color, PFblendkernel kernel);
+static void Helper_ProcessSpans(PFtexture* texture, PFpixelformat format, PFfloat* zbuffer, const PFint bounds[4], PFfloat z, PFcolor color);
+
+
+/* Rectangle rasterization function */
+
+void Rasterize_RectSpans(const PFint bounds[4], PFfloat z, PFcolor color)
+{
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    PFtexture *texDst = &fbDst->texture;
+    PFfloat *zbDst = fbDst->zbuffer;
+    PFsizei wDst = texDst->width;
+
+    PFint xMin = bounds[0], yMin = bounds[1];
+    PFint xMax = bounds[2], yMax = bounds[3];
+
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    PFblendfunc blendFunction = (currentCtx->state & PF_BLEND) ? currentCtx->blendFunction : NULL;
+    PFblendkernel blendKernel = Blend_GetKernel(blendFunction, dstFormat);
+    PFboolean depthTest = (currentCtx->state & PF_DEPTH_TEST);
+
+    Depth_ResolveTiles(fbDst, xMin, yMin, xMax, yMax);
+
+    /* Write the colors */
+
+    // NOTE: Without depth test every pixel of the rectangle is written, the rows are then
+    //       filled with copies of one converted pixel, or blended with the constant color
+
+    if (depthTest || dstFormat == PF_PIXELFORMAT_UNKNOWN)
+    {
+        Helper_ProcessSpans(texDst, dstFormat, zbDst, bounds, z, color);
+    }
+    else if (blendFunction == NULL || (blendKernel && color.a == 255))
+    {
+        Helper_FillSpans(texDst, dstFormat, bounds, color);
+    }
+    else if (blendKernel && dstFormat != PF_PIXELFORMAT_R5G6B5)
+    {
+        Helper_BlendSpans(texDst, dstFormat, bounds, color, blendKernel);
+    }
+    else
+    {
+        Helper_ProcessSpans(texDst, dstFormat, zbDst, bounds, z, color);
+    }
+
+    /* Write the depths */
+
+    // NOTE: The triangle rasterizer writes the depth of its fragments even without depth test
+
+    if (!depthTest)
+    {
+        for (PFint y = yMin; y <= yMax; y++)
+        {
+            PFfloat *zRow = zbDst + y*wDst;
+            for (PFint x = xMin; x <= xMax; x++) zRow[x] = z;
+        }
+    }
+
+    if (!depthTest || !Depth_IsLessTest(currentCtx->depthFunction))
+    {
+        Depth_RaiseTiles(fbDst, xMin, yMin, xMax, yMax, z);
+    }
+}
+
+
+/* Internal helper function definitions */
+
+// NOTE: Converts the color once, doubles it over the first row, then copies the first row
+void Helper_FillSpans(PFtexture* texture, PFpixelformat format, const PFint bounds[4], PFcolor color)
+{
+    PFsizei bpp = pfInternal_GetPixelBytes(format);
+    PFsizei pitch = texture->width*bpp;
+    PFsizei rowSize = (bounds[2] - bounds[0] + 1)*bpp;
+
+    PFubyte *firstRow = (PFubyte*)texture->pixels + bounds[1]*pitch + bounds[0]*bpp;
+
+    Pixel_Set(texture, format, bounds[1]*texture->width + bounds[0], color);
+
+    for (PFsizei filled = bpp; filled < rowSize;)
+    {
+        PFsizei copy = MIN(filled, rowSize - filled);
+        memcpy(firstRow + filled, firstRow, copy);
+        filled += copy;
+    }
+
+    PFubyte *row = firstRow + pitch;
+
+    for (PFint y = bounds[1] + 1; y <= bounds[3]; y++, row += pitch)
+    {
+        memcpy(row, firstRow, rowSize);
+    }
+}
+
+// NOTE: Same result as the blend kernels for each pixel, with the source part of the sums
+//       computed once per channel: 'scaled' is the source multiplied by its alpha (straight)
+//       and 'added' the source itself (premultiplied), the other one being zero. The result
+//       of each channel only depends on the same byte of the destination, so the inner loop
+//       has no dependency the compiler can't vectorize.
+static inline void Helper_BlendRow(PFubyte* row, PFsizei size, PFsizei bpp, const PFushort scaled[4], const PFushort added[4], PFushort invAlpha)
+{
+    for (PFsizei i = 0; i < size; i += bpp)
+    {
+        for (PFsizei c = 0; c < bpp; c++)
+        {
+            row[i + c] = (PFubyte)MIN_255(added[c] + Blend_Div255(scaled[c] + invAlpha*row[i + c]));
+        }
+    }
+}
+
+void Helper_BlendSpans(PFtexture* texture, PFpixelformat format, const PFint bounds[4], PFcolor color, PFblendkernel kernel)
+{
+    // NOTE: A transparent color leaves the pixels as they are
+    if (Blend_IsTransparent(color, kernel)) return;
+
+    PFushort invAlpha = 255 - color.a;
+
+    // Source channels in the order of the pixel bytes
+    PFubyte channels[4] = { color.r, color.g, color.b, color.a };
+
+    switch (format)
+    {
+        case PF_PIXELFORMAT_R8G8B8:
+        case PF_PIXELFORMAT_R8G8B8A8:
+            break;
+
+        case PF_PIXELFORMAT_B8G8R8:
+            channels[0] = color.b, channels[2] = color.r;
+            break;
+
+        default:
+            return;
+    }
+
+    PFushort scaled[4] = { 0 };
+    PFushort added[4] = { 0 };
+
+    for (PFint c = 0; c < 4; c++)
+    {
+        if (kernel == PF_BLEND_KERNEL_ALPHA) scaled[c] = color.a*(c < 3 ? channels[c] : 255);
+        else added[c] = channels[c];
+    }
+
+    PFsizei bpp = pfInternal_GetPixelBytes(format);
+    PFsizei pitch = texture->width*bpp;
+    PFsizei rowSize = (bounds[2] - bounds[0] + 1)*bpp;
+
+    PFubyte *row = (PFubyte*)texture->pixels + bounds[1]*pitch + bounds[0]*bpp;
+
+    for (PFint y = bounds[1]; y <= bounds[3]; y++, row += pitch)
+    {
+        // NOTE: Constant pixel sizes so that the channel loop is unrolled
+        if (bpp == 4) Helper_BlendRow(row, rowSize, 4, scaled, added, invAlpha);
+        else Helper_BlendRow(row, rowSize, 3, scaled, added, invAlpha);
+    }
+}
+
+// NOTE: Generic path, one fragment at a time, for the depth test and the other blend functions
+void Helper_ProcessSpans(PFtexture* texture, PFpixelformat format, PFfloat* zbuffer, const PFint bounds[4], PFfloat z, PFcolor color)
+{
+    PFblendfunc blendFunction = (currentCtx->state & PF_BLEND) ? currentCtx->blendFunction : NULL;
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    PFboolean noDepth = !(currentCtx->state & PF_DEPTH_TEST);
+
+    for (PFint y = bounds[1]; y <= bounds[3]; y++)
+    {
+        PFsizei yOffset = y*texture->width;
+
+        for (PFint x = bounds[0]; x <= bounds[2]; x++)
+        {
+            PFsizei xyOffset = yOffset + x;
+
+            if (noDepth || Depth_Test(depthFunc, z, zbuffer[xyOffset]))
+            {
+                PFcolor finalColor = blendFunction ? blendFunction(color, Pixel_Get(texture, format, xyOffset)) : color;
+                Pixel_Set(texture, format, xyOffset, finalColor);
+                zbuffer[xyOffset] = z;
+            }
+        }
+    }
+}
@@ -0,0 +1,31 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you
+ *  wrote the original software. If you use this software in a product, an acknowledgment
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_RECTS_H
+#define PF_RECTS_H
+
+#include "../../context.h"
+#include "../../config.h"
+
+// NOTE: Fills the rectangle of the current framebuffer given by 'bounds' (xMin, yMin, xMax, yMax,
+//       inclusive and already clipped) with a single color and depth, going through the same
+//       depth test, blending and depth writes as the fragments of the triangle rasterizer.
+void Rasterize_RectSpans(const PFint bounds[4], PFfloat z, PFcolor color);
+
+#endif //PF_RECTS_H
@@ -18,6 +18,14 @@
  */
 
 #include "./triangles.h"
+#include "../../pixel.h"
+#include "../../depth.h"
+#include "../../simd.h"
+#include "../../transform/transform.h"
+#include "../../lighting/lighting.h"
+#include "../../sampler.h"
+#include "../../blend.h"
+#include <stdlib.h>
 #include <stdint.h>
 
 /* Internal typedefs */
@@ -26,6 +34,14 @@
 typedef PFcolor (*InterpolateColorFunc)(PFcolor, PFcolor, PFfloat);
 #else //PF_BARYCENTRIC_RASTER_METHOD
 typedef PFcolor (*InterpolateColorFunc)(PFcolor, PFcolor, PFcolor, PFfloat, PFfloat, PFfloat);
+
+typedef struct {
+    PFint w1, w2, w3;                   ///< Edge functions of the origin pixel, covered if all positive
+    PFint w1XStep, w2XStep, w3XStep;    ///< Increments of the edge functions for one pixel to the right
+    PFint w1YStep, w2YStep, w3YStep;    ///< Increments of the edge functions for one pixel down
+    PFfloat wInvSum;                    ///< Inverse of the sum of the edge functions, same for every pixel
+    PFfloat w1Bias, w2Bias, w3Bias;     ///< Parts of the normalized weights lost by rounding the edge functions
+} PFedges;
 #endif //PF_RASTER_METHOD
 
 
@@ -37,6 +53,7 @@ extern void pfInternal_HomogeneousToScreen(PFvertex* v);
 /* Internal helper function declarations */
 
 static PFvertex Helper_LerpVertex(const PFvertex* start, const PFvertex* end, PFfloat t);
+static PFboolean Helper_IsInsideGuardBand(const PFvertex* polygon, int_fast8_t vertexCounter);
 
 #ifdef PF_SCANLINES_RASTER_METHOD
 
@@ -48,7 +65,11 @@ static PFcolor Helper_InterpolateColor_FLAT(PFcolor v1, PFcolor v2, PFfloat t);
 
 #else //PF_BARYCENTRIC_RASTER_METHOD
 
+static void Helper_InitEdges(PFedges* edges, PFface faceToRender, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, PFint xOrigin, PFint yOrigin);
+
+#ifndef PF_SIMD_WIDTH
 static PFcolor Helper_InterpolateColor_SMOOTH(PFcolor v1, PFcolor v2, PFcolor v3, PFfloat w1, PFfloat w2, PFfloat w3);
+#endif //PF_SIMD_WIDTH
 static PFcolor Helper_InterpolateColor_FLAT(PFcolor v1, PFcolor v2, PFcolor v3, PFfloat w1, PFfloat w2, PFfloat w3);
 
 #endif //PF_RASTER_METHOD
@@ -57,12 +78,10 @@ static PFcolor Helper_InterpolateColor_FLAT(PFcolor v1, PFcolor v2, PFcolor v3,
 /* Polygon processing functions */
 
 static PFboolean Process_ClipPolygonW(PFvertex* polygon, int_fast8_t* vertexCounter);
-static PFboolean Process_ClipPolygonXYZ(PFvertex* polygon, int_fast8_t* vertexCounter);
+static PFboolean Process_ClipPolygonAxis(PFvertex* polygon, int_fast8_t* vertexCounter, int_fast8_t iAxis);
 
 PFboolean Process_ProjectAndClipTriangle(PFvertex* polygon, int_fast8_t* vertexCounter)
 {
-    PFfloat weightSum = 0.0f;
-
     for (int_fast8_t i = 0; i < *vertexCounter; i++)
     {
         PFvertex *v = polygon + i;
@@ -70,11 +89,35 @@ PFboolean Process_ProjectAndClipTriangle(PFvertex* polygon, int_fast8_t* vertexC
         memcpy(v->homogeneous, v->position, sizeof(PFMvec4));
         pfmVec4Transform(v->homogeneous, v->homogeneous, currentCtx->matMVP);
 
-        weightSum += v->homogeneous[3];
+        v->clipCode = Transform_ClassifyVertex(v->homogeneous[0],
+            v->homogeneous[1], v->homogeneous[2], v->homogeneous[3]);
     }
 
-    if (abs(weightSum - 3.0f) < PF_CLIP_EPSILON)
+    return Process_ClipAndProjectTriangle(polygon, vertexCounter);
+}
+
+PFboolean Process_ClipAndProjectTriangle(PFvertex* polygon, int_fast8_t* vertexCounter)
+{
+    PFfloat weightSum = 0.0f;
+
+    for (int_fast8_t i = 0; i < *vertexCounter; i++)
     {
+        weightSum += polygon[i].homogeneous[3];
+    }
+
+    if (fabsf(weightSum - 3.0f) < PF_CLIP_EPSILON)
+    {
+        // NOTE: The "2D" triangles can't be behind the camera, but like the 3D ones below
+        //       they are clipped against the sides of the viewport if they leave the guard
+        //       band, otherwise the edge functions of the rasterizer could overflow
+
+        if (!Helper_IsInsideGuardBand(polygon, *vertexCounter)
+            && !(Process_ClipPolygonAxis(polygon, vertexCounter, 0)
+              && Process_ClipPolygonAxis(polygon, vertexCounter, 1)))
+        {
+            return PF_FALSE;
+        }
+
         for (int_fast8_t i = 0; i < *vertexCounter; i++)
         {
             pfInternal_HomogeneousToScreen(&polygon[i]);
@@ -83,7 +126,48 @@ PFboolean Process_ProjectAndClipTriangle(PFvertex* polygon, int_fast8_t* vertexC
         return PF_FALSE; // Is "2D"
     }
 
-    if (Process_ClipPolygonW(polygon, vertexCounter) && Process_ClipPolygonXYZ(polygon, vertexCounter))
+    // NOTE: The clipping functions would leave a triangle inside every plane unchanged,
+    //       and remove one outside of a same plane after interpolating its vertices.
+    //       Only the planes crossed by the triangle are clipped (see below for X and Y).
+
+    PFubyte clipOr = 0, clipAnd = 0xFF;
+
+    for (int_fast8_t i = 0; i < *vertexCounter; i++)
+    {
+        clipOr |= polygon[i].clipCode;
+        clipAnd &= polygon[i].clipCode;
+    }
+
+    if (clipAnd != 0)
+    {
+        *vertexCounter = 0;
+        return PF_TRUE;
+    }
+
+    PFboolean visible = PF_TRUE;
+
+    if (clipOr & PF_FRUSTUM_W)
+    {
+        visible = Process_ClipPolygonW(polygon, vertexCounter);
+    }
+
+    if (visible && (clipOr & (PF_FRUSTUM_FAR | PF_FRUSTUM_NEAR)))
+    {
+        visible = Process_ClipPolygonAxis(polygon, vertexCounter, 2);
+    }
+
+    // NOTE: Guard-band clipping, a polygon crossing the sides of the viewport is only clipped
+    //       against them if it leaves the guard band, otherwise the rasterizer discards the
+    //       pixels outside of the viewport when it clamps the bounds of the triangles
+
+    if (visible && (clipOr & (PF_FRUSTUM_RIGHT | PF_FRUSTUM_LEFT | PF_FRUSTUM_TOP | PF_FRUSTUM_BOTTOM))
+        && !Helper_IsInsideGuardBand(polygon, *vertexCounter))
+    {
+        visible = Process_ClipPolygonAxis(polygon, vertexCounter, 0)
+               && Process_ClipPolygonAxis(polygon, vertexCounter, 1);
+    }
+
+    if (visible)
     {
         for (int_fast8_t i = 0; i < *vertexCounter; i++)
         {
@@ -140,75 +224,72 @@ PFboolean Process_ClipPolygonW(PFvertex* polygon, int_fast8_t* vertexCounter)
     return *vertexCounter > 0;
 }
 
-PFboolean Process_ClipPolygonXYZ(PFvertex* polygon, int_fast8_t* vertexCounter)
+PFboolean Process_ClipPolygonAxis(PFvertex* polygon, int_fast8_t* vertexCounter, int_fast8_t iAxis)
 {
-    for (int_fast8_t iAxis = 0; iAxis < 3; iAxis++)
-    {
-        if (*vertexCounter == 0) return PF_FALSE;
-
-        PFvertex input[PF_MAX_CLIPPED_POLYGON_VERTICES];
-        int_fast8_t inputCounter;
+    if (*vertexCounter == 0) return PF_FALSE;
 
-        const PFvertex *prevVt;
-        PFbyte prevDot;
+    PFvertex input[PF_MAX_CLIPPED_POLYGON_VERTICES];
+    int_fast8_t inputCounter;
 
-        // Clip against first plane
+    const PFvertex *prevVt;
+    PFbyte prevDot;
 
-        memcpy(input, polygon, (*vertexCounter)*sizeof(PFvertex));
-        inputCounter = *vertexCounter;
-        *vertexCounter = 0;
+    // Clip against first plane
 
-        prevVt = &input[inputCounter-1];
-        prevDot = (prevVt->homogeneous[iAxis] <= prevVt->homogeneous[3]) ? 1 : -1;
+    memcpy(input, polygon, (*vertexCounter)*sizeof(PFvertex));
+    inputCounter = *vertexCounter;
+    *vertexCounter = 0;
 
-        for (int_fast8_t i = 0; i < inputCounter; i++)
-        {
-            PFbyte currDot = (input[i].homogeneous[iAxis] <= input[i].homogeneous[3]) ? 1 : -1;
+    prevVt = &input[inputCounter-1];
+    prevDot = (prevVt->homogeneous[iAxis] <= prevVt->homogeneous[3]) ? 1 : -1;
 
-            if (prevDot*currDot <= 0)
-            {
-                polygon[(*vertexCounter)++] = Helper_LerpVertex(prevVt, &input[i], (prevVt->homogeneous[3] - prevVt->homogeneous[iAxis]) /
-                    ((prevVt->homogeneous[3] - prevVt->homogeneous[iAxis]) - (input[i].homogeneous[3] - input[i].homogeneous[iAxis])));
-            }
+    for (int_fast8_t i = 0; i < inputCounter; i++)
+    {
+        PFbyte currDot = (input[i].homogeneous[iAxis] <= input[i].homogeneous[3]) ? 1 : -1;
 
-            if (currDot > 0)
-            {
-                polygon[(*vertexCounter)++] = input[i];
-            }
+        if (prevDot*currDot <= 0)
+        {
+            polygon[(*vertexCounter)++] = Helper_LerpVertex(prevVt, &input[i], (prevVt->homogeneous[3] - prevVt->homogeneous[iAxis]) /
+                ((prevVt->homogeneous[3] - prevVt->homogeneous[iAxis]) - (input[i].homogeneous[3] - input[i].homogeneous[iAxis])));
+        }
 
-            prevDot = currDot;
-            prevVt = &input[i];
+        if (currDot > 0)
+        {
+            polygon[(*vertexCounter)++] = input[i];
         }
 
-        if (*vertexCounter == 0) return PF_FALSE;
+        prevDot = currDot;
+        prevVt = &input[i];
+    }
 
-        // Clip against opposite plane
+    if (*vertexCounter == 0) return PF_FALSE;
 
-        memcpy(input, polygon, (*vertexCounter)*sizeof(PFvertex));
-        inputCounter = *vertexCounter;
-        *vertexCounter = 0;
+    // Clip against opposite plane
 
-        prevVt = &input[inputCounter-1];
-        prevDot = (-prevVt->homogeneous[iAxis] <= prevVt->homogeneous[3]) ? 1 : -1;
+    memcpy(input, polygon, (*vertexCounter)*sizeof(PFvertex));
+    inputCounter = *vertexCounter;
+    *vertexCounter = 0;
 
-        for (int_fast8_t i = 0; i < inputCounter; i++)
-        {
-            PFbyte currDot = (-input[i].homogeneous[iAxis] <= input[i].homogeneous[3]) ? 1 : -1;
+    prevVt = &input[inputCounter-1];
+    prevDot = (-prevVt->homogeneous[iAxis] <= prevVt->homogeneous[3]) ? 1 : -1;
 
-            if (prevDot*currDot <= 0)
-            {
-                polygon[(*vertexCounter)++] = Helper_LerpVertex(prevVt, &input[i], (prevVt->homogeneous[3] + prevVt->homogeneous[iAxis]) /
-                    ((prevVt->homogeneous[3] + prevVt->homogeneous[iAxis]) - (input[i].homogeneous[3] + input[i].homogeneous[iAxis])));
-            }
+    for (int_fast8_t i = 0; i < inputCounter; i++)
+    {
+        PFbyte currDot = (-input[i].homogeneous[iAxis] <= input[i].homogeneous[3]) ? 1 : -1;
 
-            if (currDot > 0)
-            {
-                polygon[(*vertexCounter)++] = input[i];
-            }
+        if (prevDot*currDot <= 0)
+        {
+            polygon[(*vertexCounter)++] = Helper_LerpVertex(prevVt, &input[i], (prevVt->homogeneous[3] + prevVt->homogeneous[iAxis]) /
+                ((prevVt->homogeneous[3] + prevVt->homogeneous[iAxis]) - (input[i].homogeneous[3] + input[i].homogeneous[iAxis])));
+        }
 
-            prevDot = currDot;
-            prevVt = &input[i];
+        if (currDot > 0)
+        {
+            polygon[(*vertexCounter)++] = input[i];
         }
+
+        prevDot = currDot;
+        prevVt = &input[i];
     }
 
     return *vertexCounter > 0;
@@ -217,8 +298,26 @@ PFboolean Process_ClipPolygonXYZ(PFvertex* polygon, int_fast8_t* vertexCounter)
 
 /* Triangle rasterization functions */
 
-static PFcolor Process_Lights(const PFlight* activeLights, const PFmaterial* material,
-    PFcolor diffuse, const PFMvec3 viewPos, const PFMvec3 fragPos, const PFMvec3 fragNormal);
+// NOTE: Uses the same signed area as the face test of 'Rasterize_Triangle' so that the returned
+//       face is always accepted by it; degenerate triangles, rejected for both faces, give PF_FRONT_AND_BACK.
+PFface Rasterize_TriangleFace(const PFvertex* v1, const PFvertex* v2, const PFvertex* v3)
+{
+#ifdef PF_SCANLINES_RASTER_METHOD
+    PFfloat signedArea = (v2->screen[0] - v1->screen[0])*(v3->screen[1] - v1->screen[1])
+                       - (v3->screen[0] - v1->screen[0])*(v2->screen[1] - v1->screen[1]);
+#else
+    PFint x1 = Rasterize_ToSubPixel(v1->screen[0]), y1 = Rasterize_ToSubPixel(v1->screen[1]);
+    PFint x2 = Rasterize_ToSubPixel(v2->screen[0]), y2 = Rasterize_ToSubPixel(v2->screen[1]);
+    PFint x3 = Rasterize_ToSubPixel(v3->screen[0]), y3 = Rasterize_ToSubPixel(v3->screen[1]);
+
+    PFint64 signedArea = (PFint64)(x2 - x1)*(y3 - y1) - (PFint64)(x3 - x1)*(y2 - y1);
+#endif //PF_SCANLINES_RASTER_METHOD
+
+    if (signedArea < 0) return PF_FRONT;
+    if (signedArea > 0) return PF_BACK;
+
+    return PF_FRONT_AND_BACK;
+}
 
 #ifdef PF_SCANLINES_RASTER_METHOD
 
@@ -227,7 +326,8 @@ static PFcolor Process_Lights(const PFlight* activeLights, const PFmaterial* mat
 void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos)
 {
     const PFboolean noDepth = !(currentCtx->state & PF_DEPTH_TEST);
-    const PFboolean lighting = (currentCtx->state & PF_LIGHTING) && currentCtx->activeLights;
+    const PFboolean lighting = (currentCtx->state & PF_LIGHTING) && currentCtx->activeLights
+        && !(currentCtx->state & PF_VERTEX_LIGHTING);
     const PFboolean texturing = (currentCtx->state & PF_TEXTURE_2D) && currentCtx->currentTexture;
 
     /* Check if the face can be rendered, if not, skip */
@@ -270,12 +370,26 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
     /* Extract framebuffer information */
 
     PFblendfunc blendFunction = currentCtx->state & PF_BLEND ? currentCtx->blendFunction : NULL;
-    PFpixelsetter pixelSetter = currentCtx->currentFramebuffer->texture.pixelSetter;
-    PFpixelgetter pixelGetter = currentCtx->currentFramebuffer->texture.pixelGetter;
+    const PFtexture *texDst = &currentCtx->currentFramebuffer->texture;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(texDst);
+    const PFblendkernel blendKernel = Blend_GetKernel(blendFunction, dstFormat);
     PFsizei widthDst = currentCtx->currentFramebuffer->texture.width;
-    void *pbDst = currentCtx->currentFramebuffer->texture.pixels;
     PFfloat *zbDst = currentCtx->currentFramebuffer->zbuffer;
-    PFtexture *texture = currentCtx->currentTexture;
+
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    const PFboolean raiseDepth = noDepth || !Depth_IsLessTest(depthFunc);
+
+    Depth_ResolveTiles(currentCtx->currentFramebuffer, MIN(x1, MIN(x2, x3)), y1, MAX(x1, MAX(x2, x3)), y3);
+
+    /* Get the texture derivatives for the level of detail */
+
+    const PFsampler *sampler = &currentCtx->sampler;
+    PFtexgradients gradients;
+
+    if (texturing && sampler->useLod)
+    {
+        Sampler_InitGradients(sampler, &gradients, is3D, v1, v2, v3);
+    }
 
     /*  */
 
@@ -287,6 +401,12 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
         yMin = CLAMP(yMin, currentCtx->vpMin[1], currentCtx->vpMax[1]);
         yMax = CLAMP(yMax, currentCtx->vpMin[1], currentCtx->vpMax[1]);
     }
+    else
+    {
+        // NOTE: Not clipped against the sides of the viewport (see 'Rasterize_TriangleBounds')
+        yMin = MAX(yMin, currentCtx->vpMin[1]);
+        yMax = MIN(yMax, MIN(currentCtx->vpMax[1], currentCtx->vpPos[1] + (PFint)currentCtx->vpDim[1]));
+    }
 
     PFsizei yOffset = yMin*widthDst;
 
@@ -308,7 +428,7 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
         PFfloat zA, zB;
         PFcolor cA, cB;
 
-        PFMvec2 uvA, uvB;
+        PFMvec2 uvA = { 0 }, uvB = { 0 };
         PFMvec3 pA, pB;
         PFMvec3 nA, nB;
 
@@ -387,6 +507,11 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
             xMin = CLAMP(xMin, currentCtx->vpMin[0], currentCtx->vpMax[0]);
             xMax = CLAMP(xMax, currentCtx->vpMin[0], currentCtx->vpMax[0]);
         }
+        else
+        {
+            xMin = MAX(xMin, currentCtx->vpMin[0]);
+            xMax = MIN(xMax, MIN(currentCtx->vpMax[0], currentCtx->vpPos[0] + (PFint)currentCtx->vpDim[0]));
+        }
 
         PFsizei xyOffset = yOffset + xMin;
 
@@ -422,7 +547,7 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
 
             /* Perform depth test */
 
-            if (noDepth || currentCtx->depthFunction(z, zbDst[xyOffset]))
+            if (noDepth || Depth_Test(depthFunc, z, zbDst[xyOffset]))
             {
                 /* Obtain fragment color */
 
@@ -444,7 +569,8 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
                         pfmVec2Scale(uv, uv, z);
                     }
 
-                    PFcolor tex = pfGetTextureSample(texture, uv[0], uv[1]);
+                    PFfloat lod = sampler->useLod ? Sampler_GetLod(&gradients, uv[0], uv[1], z) : 0.0f;
+                    PFcolor tex = Sampler_Sample(sampler, uv[0], uv[1], lod);
                     fragment = pfBlendMultiplicative(tex, fragment);
                 }
 
@@ -460,16 +586,25 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
                     pfmVec3Copy(normal, nA);
                     pfmVec3Add(nA, nA, nStep);
 
-                    fragment = Process_Lights(currentCtx->activeLights,
-                        &currentCtx->faceMaterial[faceToRender], fragment,
-                        viewPos, position, normal);
+                    fragment = Lighting_Shade(&currentCtx->lighting,
+                        faceToRender, fragment, viewPos, position, normal);
                 }
 
                 /* Apply final color and depth */
 
-                PFcolor finalColor = blendFunction ? blendFunction(fragment, pixelGetter(pbDst, xyOffset)) : fragment;
-                pixelSetter(pbDst, xyOffset, finalColor);
+                if (blendKernel)
+                {
+                    Blend_Pixel(texDst->pixels, dstFormat, xyOffset, fragment, blendKernel);
+                }
+                else
+                {
+                    PFcolor finalColor = blendFunction ? blendFunction(fragment, Pixel_Get(texDst, dstFormat, xyOffset)) : fragment;
+                    Pixel_Set(texDst, dstFormat, xyOffset, finalColor);
+                }
+
                 zbDst[xyOffset] = z;
+
+                if (raiseDepth) Depth_RaiseTile(currentCtx->currentFramebuffer, x, y, z);
             }
         }
     }
@@ -477,87 +612,329 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
 
 #else //PF_BARYCENTRIC_RASTER_METHOD
 
+static void Rasterize_TriangleRect_IMPL(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos, const PFint bounds[4]);
+
 void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos)
 {
-    /* Get integer 2D position coordinates */
+    PFint bounds[4];
+
+    if (Rasterize_TriangleBounds(faceToRender, v1, v2, v3, bounds))
+    {
+        Rasterize_TriangleRect(faceToRender, is3D, v1, v2, v3, viewPos, bounds);
+    }
+}
+
+PFboolean Rasterize_TriangleBounds(PFface faceToRender, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, PFint bounds[4])
+{
+    /* Get sub-pixel 2D position coordinates */
 
-    PFint x1 = (PFint)v1->screen[0], y1 = (PFint)v1->screen[1];
-    PFint x2 = (PFint)v2->screen[0], y2 = (PFint)v2->screen[1];
-    PFint x3 = (PFint)v3->screen[0], y3 = (PFint)v3->screen[1];
+    PFint x1 = Rasterize_ToSubPixel(v1->screen[0]), y1 = Rasterize_ToSubPixel(v1->screen[1]);
+    PFint x2 = Rasterize_ToSubPixel(v2->screen[0]), y2 = Rasterize_ToSubPixel(v2->screen[1]);
+    PFint x3 = Rasterize_ToSubPixel(v3->screen[0]), y3 = Rasterize_ToSubPixel(v3->screen[1]);
 
     /* Check if the desired face can be rendered */
 
-    PFfloat signedArea = (x2 - x1)*(y3 - y1) - (x3 - x1)*(y2 - y1);
+    PFint64 signedArea = (PFint64)(x2 - x1)*(y3 - y1) - (PFint64)(x3 - x1)*(y2 - y1);
 
     if ((faceToRender == PF_FRONT && signedArea >= 0)
      || (faceToRender == PF_BACK  && signedArea <= 0))
     {
-        return;
+        return PF_FALSE;
     }
 
-    /* Calculate the 2D bounding box of the triangle */
+    /* Calculate the pixels whose center is in the 2D bounding box of the triangle */
 
-    PFsizei xMin = (PFsizei)MIN(x1, MIN(x2, x3));
-    PFsizei yMin = (PFsizei)MIN(y1, MIN(y2, y3));
-    PFsizei xMax = (PFsizei)MAX(x1, MAX(x2, x3));
-    PFsizei yMax = (PFsizei)MAX(y1, MAX(y2, y3));
+    bounds[0] = Rasterize_FirstPixel(MIN(x1, MIN(x2, x3)));
+    bounds[1] = Rasterize_FirstPixel(MIN(y1, MIN(y2, y3)));
+    bounds[2] = Rasterize_FirstPixel(MAX(x1, MAX(x2, x3)) + 1) - 1;
+    bounds[3] = Rasterize_FirstPixel(MAX(y1, MAX(y2, y3)) + 1) - 1;
 
-    if (!is3D)
+    // NOTE: The triangles are only clipped against the sides of the viewport when they leave
+    //       the guard band, their bounds are limited to the pixels of the viewport
+
+    bounds[0] = MAX(bounds[0], currentCtx->vpMin[0]);
+    bounds[1] = MAX(bounds[1], currentCtx->vpMin[1]);
+    bounds[2] = MIN(bounds[2], MIN(currentCtx->vpMax[0], currentCtx->vpPos[0] + (PFint)currentCtx->vpDim[0]));
+    bounds[3] = MIN(bounds[3], MIN(currentCtx->vpMax[1], currentCtx->vpPos[1] + (PFint)currentCtx->vpDim[1]));
+
+    return (bounds[0] <= bounds[2] && bounds[1] <= bounds[3]);
+}
+
+// NOTE: 'bounds' can be any sub-rectangle of the one given by 'Rasterize_TriangleBounds',
+//       the edge functions are evaluated from its top-left corner so the rasterized
+//       pixels are exactly the same as if the whole triangle was drawn at once.
+//       The blocks of the coarse depth buffer in which the triangle is entirely hidden
+//       are skipped, the remaining runs of blocks are given to the rasterization loop.
+void Rasterize_TriangleRect(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos, const PFint bounds[4])
+{
+    PFframebuffer *fbDst = currentCtx->currentFramebuffer;
+    PFint wDst = fbDst->texture.width, hDst = fbDst->texture.height;
+
+    if (!fbDst->zbufferMax || bounds[0] < 0 || bounds[1] < 0 || bounds[2] >= wDst || bounds[3] >= hDst)
     {
-        xMin = (PFsizei)CLAMP((PFint)xMin, currentCtx->vpMin[0], currentCtx->vpMax[0]);
-        yMin = (PFsizei)CLAMP((PFint)yMin, currentCtx->vpMin[1], currentCtx->vpMax[1]);
-        xMax = (PFsizei)CLAMP((PFint)xMax, currentCtx->vpMin[0], currentCtx->vpMax[0]);
-        yMax = (PFsizei)CLAMP((PFint)yMax, currentCtx->vpMin[1], currentCtx->vpMax[1]);
+        Rasterize_TriangleRect_IMPL(faceToRender, is3D, v1, v2, v3, viewPos, bounds);
+        return;
+    }
 
-        if (xMin == xMax && yMin == yMax) return;
+    /* Get the depth range of the triangle */
+
+    // NOTE: The depth of a fragment is the inverse of the interpolated 'homogeneous[2]',
+    //       it stays between the inverses of the vertex values as long as they are all
+    //       positive. The margin covers the rounding of the barycentric weights.
+
+    PFfloat h1 = v1->homogeneous[2];
+    PFfloat h2 = v2->homogeneous[2];
+    PFfloat h3 = v3->homogeneous[2];
+
+    PFfloat zMin = -PF_DEPTH_UNBOUNDED;
+    PFfloat zMax = PF_DEPTH_UNBOUNDED;
+
+    if (h1 > 0 && h2 > 0 && h3 > 0)
+    {
+        zMin = (1.0f - 1e-4f)/MAX(h1, MAX(h2, h3));
+        zMax = (1.0f + 1e-4f)/MIN(h1, MIN(h2, h3));
     }
 
-    /* Barycentric interpolation */
+    /* Get the edge functions, to know which blocks are entirely covered */
 
-    PFint w1XStep = y3 - y2, w1YStep = x2 - x3;
-    PFint w2XStep = y1 - y3, w2YStep = x3 - x1;
-    PFint w3XStep = y2 - y1, w3YStep = x1 - x2;
+    PFedges edges;
+    Helper_InitEdges(&edges, faceToRender, v1, v2, v3, bounds[0], bounds[1]);
 
-    if (faceToRender == PF_BACK)
+    const PFint w1XStep = edges.w1XStep, w1YStep = edges.w1YStep;
+    const PFint w2XStep = edges.w2XStep, w2YStep = edges.w2YStep;
+    const PFint w3XStep = edges.w3XStep, w3YStep = edges.w3YStep;
+
+    const PFint tileSize = PF_DEPTH_TILE_SIZE;
+
+    const PFint w1XEnd = (tileSize - 1)*w1XStep, w1YEnd = (tileSize - 1)*w1YStep;
+    const PFint w2XEnd = (tileSize - 1)*w2XStep, w2YEnd = (tileSize - 1)*w2YStep;
+    const PFint w3XEnd = (tileSize - 1)*w3XStep, w3YEnd = (tileSize - 1)*w3YStep;
+
+    /* Get the depth test */
+
+    // NOTE: Only the 'less' tests can reject blocks and lower their depth bound,
+    //       any other write raises the bound of the blocks it can touch.
+
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+    const PFboolean lessTest = (currentCtx->state & PF_DEPTH_TEST) && Depth_IsLessTest(depthFunc);
+
+    /* Rasterize the blocks, row by row */
+
+    PFint tilesX = Depth_TilesPerRow(wDst);
+    PFint txMin = bounds[0]/tileSize, txMax = bounds[2]/tileSize;
+    PFint tyMin = bounds[1]/tileSize, tyMax = bounds[3]/tileSize;
+
+    for (PFint ty = tyMin; ty <= tyMax; ty++)
     {
-        w1XStep = -w1XStep, w1YStep = -w1YStep;
-        w2XStep = -w2XStep, w2YStep = -w2YStep;
-        w3XStep = -w3XStep, w3YStep = -w3YStep;
+        PFfloat *rowMax = fbDst->zbufferMax + ty*tilesX;
+
+        PFint yTile = ty*tileSize;
+        PFint yMin = MAX(yTile, bounds[1]);
+        PFint yMax = MIN(yTile + tileSize - 1, bounds[3]);
+
+        PFint runStart = txMin;
+
+        for (PFint tx = txMin; tx <= txMax + 1; tx++)
+        {
+            PFboolean endRun = (tx > txMax) || (lessTest && !Depth_Test(depthFunc, zMin, rowMax[tx]));
+
+            if (endRun)
+            {
+                if (tx > runStart)
+                {
+                    const PFint runBounds[4] = {
+                        MAX(runStart*tileSize, bounds[0]), yMin,
+                        MIN(tx*tileSize - 1, bounds[2]), yMax
+                    };
+
+                    Rasterize_TriangleRect_IMPL(faceToRender, is3D, v1, v2, v3, viewPos, runBounds);
+                }
+
+                runStart = tx + 1;
+            }
+        }
+
+        for (PFint tx = txMin; tx <= txMax; tx++)
+        {
+            if (!lessTest)
+            {
+                if (zMax > rowMax[tx]) rowMax[tx] = zMax;
+                continue;
+            }
+
+            PFint xTile = tx*tileSize;
+
+            if (xTile < bounds[0] || xTile + tileSize - 1 > bounds[2]
+             || yTile < bounds[1] || yTile + tileSize - 1 > bounds[3])
+            {
+                continue;
+            }
+
+            PFint w1 = edges.w1 + (xTile - bounds[0])*w1XStep + (yTile - bounds[1])*w1YStep;
+            PFint w2 = edges.w2 + (xTile - bounds[0])*w2XStep + (yTile - bounds[1])*w2YStep;
+            PFint w3 = edges.w3 + (xTile - bounds[0])*w3XStep + (yTile - bounds[1])*w3YStep;
+
+            PFint corners = (w1 | w2 | w3)
+                | ((w1 + w1XEnd) | (w2 + w2XEnd) | (w3 + w3XEnd))
+                | ((w1 + w1YEnd) | (w2 + w2YEnd) | (w3 + w3YEnd))
+                | ((w1 + w1XEnd + w1YEnd) | (w2 + w2XEnd + w2YEnd) | (w3 + w3XEnd + w3YEnd));
+
+            // NOTE: Every pixel of a covered block now holds a depth that is at most 'zMax'
+            if (corners >= 0 && zMax < rowMax[tx]) rowMax[tx] = zMax;
+        }
     }
+}
 
-    PFint w1Row = (xMin - x2)*w1XStep + w1YStep*(yMin - y2);
-    PFint w2Row = (xMin - x3)*w2XStep + w2YStep*(yMin - y3);
-    PFint w3Row = (xMin - x1)*w3XStep + w3YStep*(yMin - y1);
+void Rasterize_TriangleRect_IMPL(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos, const PFint bounds[4])
+{
+    /* Get the area to rasterize */
 
-    /*
-        Finally, we calculate the inverse of the sum of
-        the barycentric coordinates for the top-left point; this
-        sum always remains the same, regardless of the coordinate
-        within the triangle.
-    */
+    PFsizei xMin = (PFsizei)bounds[0];
+    PFsizei yMin = (PFsizei)bounds[1];
+    PFsizei xMax = (PFsizei)bounds[2];
+    PFsizei yMax = (PFsizei)bounds[3];
 
-    PFfloat wInvSum = 1.0f/(w1Row + w2Row + w3Row);
+    /* Barycentric interpolation */
 
-    /* Get some contextual values */
+    PFedges edges;
+    Helper_InitEdges(&edges, faceToRender, v1, v2, v3, xMin, yMin);
 
-    InterpolateColorFunc interpolateColor = (currentCtx->shadingMode == PF_SMOOTH)
-        ? Helper_InterpolateColor_SMOOTH : Helper_InterpolateColor_FLAT;
+    const PFint w1XStep = edges.w1XStep, w1YStep = edges.w1YStep;
+    const PFint w2XStep = edges.w2XStep, w2YStep = edges.w2YStep;
+    const PFint w3XStep = edges.w3XStep, w3YStep = edges.w3YStep;
+
+    PFint w1Row = edges.w1, w2Row = edges.w2, w3Row = edges.w3;
+    const PFfloat wInvSum = edges.wInvSum;
+
+    /* Get some contextual values */
 
     PFblendfunc blendFunction = currentCtx->state & PF_BLEND ? currentCtx->blendFunction : NULL;
+    PFpixelformat dstFormat = pfInternal_GetDirectPixelFormat(&currentCtx->currentFramebuffer->texture);
+    const PFblendkernel blendKernel = Blend_GetKernel(blendFunction, dstFormat);
     PFpixelgetter pixelGetter = currentCtx->currentFramebuffer->texture.pixelGetter;
     PFpixelsetter pixelSetter = currentCtx->currentFramebuffer->texture.pixelSetter;
     PFsizei widthDst = currentCtx->currentFramebuffer->texture.width;
     void *pbDst = currentCtx->currentFramebuffer->texture.pixels;
     PFfloat *zbDst = currentCtx->currentFramebuffer->zbuffer;
-    PFtexture *texture = currentCtx->currentTexture;
+
+    PFdepthfunc depthFunc = currentCtx->depthFunction;
+
+    Depth_ResolveTiles(currentCtx->currentFramebuffer, xMin, yMin, xMax, yMax);
+
+    const PFboolean noDepth = !(currentCtx->state & PF_DEPTH_TEST);
+    const PFboolean lighting = (currentCtx->state & PF_LIGHTING) && currentCtx->activeLights
+        && !(currentCtx->state & PF_VERTEX_LIGHTING);
+    const PFboolean texturing = (currentCtx->state & PF_TEXTURE_2D) && currentCtx->currentTexture;
+
+    /* Get the texture derivatives for the level of detail */
+
+    const PFsampler *sampler = &currentCtx->sampler;
+    PFtexgradients gradients;
+
+    if (texturing && sampler->useLod)
+    {
+        Sampler_InitGradients(sampler, &gradients, is3D, v1, v2, v3);
+    }
+
+    /* Row loop macro definition */
+
+#ifdef PF_SIMD_WIDTH
+
+    PFsimdblock block;
+    Simd_InitBlock(&block, w1XStep, w2XStep, w3XStep, wInvSum,
+        edges.w1Bias, edges.w2Bias, edges.w3Bias, v1, v2, v3,
+        currentCtx->shadingMode == PF_SMOOTH, texturing);
+
+    const PFint w1BlockStep = w1XStep*PF_SIMD_WIDTH;
+    const PFint w2BlockStep = w2XStep*PF_SIMD_WIDTH;
+    const PFint w3BlockStep = w3XStep*PF_SIMD_WIDTH;
+
+    // NOTE: The pixels are processed by blocks of 'PF_SIMD_WIDTH', the edge functions,
+    //       weights, depth, smooth colors and texture coordinates of the whole block are
+    //       computed at once, then each covered pixel goes through the depth test and the
+    //       rest of the fragment processing as before. With the blend functions that have a
+    //       kernel, the fragments are kept until the end of the block and blended together.
+#   define BEGIN_ROW() \
+        for (PFsizei x = xMin; x <= xMax; x += PF_SIMD_WIDTH) \
+        { \
+            PFsimdfragments frags; \
+            PFuint mask = Simd_RasterizeBlock(&block, w1, w2, w3, &frags); \
+            if (xMax - x < PF_SIMD_WIDTH - 1) mask &= (1u << (xMax - x + 1)) - 1; \
+            \
+            PFcolor blended[PF_SIMD_WIDTH]; \
+            PFuint blendMask = 0; \
+            \
+            for (; mask; mask &= mask - 1) \
+            { \
+                PFint lane = __builtin_ctz(mask); \
+                PFfloat aW1 = frags.aW1[lane], aW2 = frags.aW2[lane], aW3 = frags.aW3[lane]; \
+                PFfloat z = frags.z[lane]; \
+                PFsizei xyOffset = yOffset + x + lane; \
+                \
+                if (noDepth || Depth_Test(depthFunc, z, zbDst[xyOffset])) \
+                {
+
+#   define END_ROW() \
+                } \
+            } \
+            if (blendMask) Blend_Block(pbDst, dstFormat, yOffset + x, blended, blendMask, blendKernel); \
+            w1 += w1BlockStep, w2 += w2BlockStep, w3 += w3BlockStep; \
+        }
+
+#   define GET_FRAG() \
+        PFcolor fragment = block.smooth ? frags.colors[lane] \
+            : Helper_InterpolateColor_FLAT(v1->color, v2->color, v3->color, aW1, aW2, aW3);
+
+#   define GET_TEXCOORD() \
+        PFMvec2 texcoord = { frags.u[lane], frags.v[lane] };
+
+#   define BLEND_FRAG() \
+        blended[lane] = fragment, blendMask |= 1u << lane;
+
+#else
+
+    InterpolateColorFunc interpolateColor = (currentCtx->shadingMode == PF_SMOOTH)
+        ? Helper_InterpolateColor_SMOOTH : Helper_InterpolateColor_FLAT;
 
     PFfloat z1 = v1->homogeneous[2];
     PFfloat z2 = v2->homogeneous[2];
     PFfloat z3 = v3->homogeneous[2];
 
-    const PFboolean noDepth = !(currentCtx->state & PF_DEPTH_TEST);
-    const PFboolean lighting = (currentCtx->state & PF_LIGHTING) && currentCtx->activeLights;
-    const PFboolean texturing = (currentCtx->state & PF_TEXTURE_2D) && currentCtx->currentTexture;
+    const PFfloat w1Bias = edges.w1Bias;
+    const PFfloat w2Bias = edges.w2Bias;
+    const PFfloat w3Bias = edges.w3Bias;
+
+#   define BEGIN_ROW() \
+        for (PFsizei x = xMin; x <= xMax; x++) \
+        { \
+            if ((w1 | w2 | w3) >= 0) \
+            { \
+                PFfloat aW1 = w1*wInvSum + w1Bias, aW2 = w2*wInvSum + w2Bias, aW3 = w3*wInvSum + w3Bias; \
+                PFfloat z = 1.0f/(aW1*z1 + aW2*z2 + aW3*z3); \
+                PFsizei xyOffset = yOffset + x; \
+                \
+                if (noDepth || Depth_Test(depthFunc, z, zbDst[xyOffset])) \
+                {
+
+#   define END_ROW() \
+                } \
+            } \
+            w1 += w1XStep, w2 += w2XStep, w3 += w3XStep; \
+        }
+
+#   define GET_FRAG() \
+        PFcolor fragment = interpolateColor( \
+            v1->color, v2->color, v3->color, \
+            aW1, aW2, aW3);
+
+#   define GET_TEXCOORD() \
+        PFMvec2 texcoord; \
+        pfmVec2BaryInterpR(texcoord, v1->texcoord, v2->texcoord, v3->texcoord, aW1, aW2, aW3);
+
+#   define BLEND_FRAG() \
+        Blend_Pixel(pbDst, dstFormat, xyOffset, fragment, blendKernel);
+
+#endif //PF_SIMD_WIDTH
 
     /* Loop macro definition */
 
@@ -573,22 +950,10 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
         PFint w3 = w3Row + i*w3YStep; \
         const PFsizei yOffset = y*widthDst; \
         \
-        for (PFsizei x = xMin; x <= xMax; x++) \
-        { \
-            if ((w1 | w2 | w3) >= 0) \
-            { \
-                PFfloat aW1 = w1*wInvSum, aW2 = w2*wInvSum, aW3 = w3*wInvSum; \
-                PFfloat z = 1.0f/(aW1*z1 + aW2*z2 + aW3*z3); \
-                PFsizei xyOffset = yOffset + x; \
-                \
-                if (noDepth || currentCtx->depthFunction(z, zbDst[xyOffset])) \
-                {
+        BEGIN_ROW()
 
 #   define END_LOOP() \
-                } \
-            } \
-            w1 += w1XStep, w2 += w2XStep, w3 += w3XStep; \
-        } \
+        END_ROW() \
     }
 #else
 #   define BEGIN_LOOP() \
@@ -596,213 +961,106 @@ void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1,
     { \
         PFint w1 = w1Row, w2 = w2Row, w3 = w3Row; \
         \
-        for (PFsizei x = xMin; x <= xMax; x++) \
-        { \
-            if ((w1 | w2 | w3) >= 0) \
-            { \
-                PFfloat aW1 = w1*wInvSum, aW2 = w2*wInvSum, aW3 = w3*wInvSum; \
-                PFfloat z = 1.0f/(aW1*z1 + aW2*z2 + aW3*z3); \
-                PFsizei xyOffset = yOffset + x; \
-                \
-                if (noDepth || currentCtx->depthFunction(z, zbDst[xyOffset])) \
-                {
+        BEGIN_ROW()
 
 #   define END_LOOP() \
-                } \
-            } \
-            w1 += w1XStep, w2 += w2XStep, w3 += w3XStep; \
-        } \
+        END_ROW() \
         w1Row += w1YStep, w2Row += w2YStep, w3Row += w3YStep; \
     }
 #endif
 
     /* Processing macro definitions */
 
-#   define GET_FRAG() \
-    PFcolor fragment = interpolateColor( \
-        v1->color, v2->color, v3->color, \
-        aW1, aW2, aW3);
-
 #   define TEXTURING() \
-        PFMvec2 texcoord; \
-        pfmVec2BaryInterpR(texcoord, v1->texcoord, v2->texcoord, v3->texcoord, aW1, aW2, aW3); \
+        GET_TEXCOORD(); \
         if (is3D) texcoord[0] *= z, texcoord[1] *= z; /* Perspective correct */ \
-        PFcolor texel = pfGetTextureSample(texture, texcoord[0], texcoord[1]); \
+        PFfloat lod = sampler->useLod ? Sampler_GetLod(&gradients, texcoord[0], texcoord[1], z) : 0.0f; \
+        PFcolor texel = Sampler_Sample(sampler, texcoord[0], texcoord[1], lod); \
         fragment = pfBlendMultiplicative(texel, fragment);
 
 #   define LIGHTING() \
         PFMvec3 normal, position; \
         pfmVec3BaryInterpR(normal, v1->normal, v2->normal, v3->normal, aW1, aW2, aW3); \
         pfmVec3BaryInterpR(position, v1->position, v2->position, v3->position, aW1, aW2, aW3); \
-        fragment = Process_Lights(currentCtx->activeLights, &currentCtx->faceMaterial[faceToRender], fragment, viewPos, position, normal);
+        fragment = Lighting_Shade(&currentCtx->lighting, faceToRender, fragment, viewPos, position, normal);
 
-#   define SET_FRAG() \
-        PFcolor finalColor = blendFunction ? blendFunction(fragment, pixelGetter(pbDst, xyOffset)) : fragment; \
-        pixelSetter(pbDst, xyOffset, finalColor); \
+#   define SET_FRAG(GET_PIXEL, SET_PIXEL) \
+        if (blendKernel) \
+        { \
+            BLEND_FRAG(); \
+        } \
+        else \
+        { \
+            PFcolor finalColor = blendFunction ? blendFunction(fragment, GET_PIXEL(pbDst, xyOffset)) : fragment; \
+            SET_PIXEL(pbDst, xyOffset, finalColor); \
+        } \
         zbDst[xyOffset] = z;
 
     /* Loop rasterization */
 
-    if (texturing && lighting)
-    {
-        BEGIN_LOOP();
-        GET_FRAG();
-        TEXTURING();
-        LIGHTING();
-        SET_FRAG();
-        END_LOOP();
-    }
-    else if (texturing)
-    {
-        BEGIN_LOOP();
-        GET_FRAG();
-        TEXTURING();
-        SET_FRAG();
-        END_LOOP();
-    }
-    else if (lighting)
-    {
-        BEGIN_LOOP();
-        GET_FRAG();
-        LIGHTING();
-        SET_FRAG();
-        END_LOOP();
-    }
-    else
-    {
-        BEGIN_LOOP();
-        GET_FRAG();
-        SET_FRAG();
-        END_LOOP();
-    }
-}
+    // NOTE: The loops are instantiated for each directly writable framebuffer format,
+    //       so that the pixel getter and setter calls are inlined in the inner loop.
 
-#endif //PF_RASTER_METHOD
+#   define RASTERIZE_LOOPS(GET_PIXEL, SET_PIXEL) \
+    if (texturing && lighting) \
+    { \
+        BEGIN_LOOP(); \
+        GET_FRAG(); \
+        TEXTURING(); \
+        LIGHTING(); \
+        SET_FRAG(GET_PIXEL, SET_PIXEL); \
+        END_LOOP(); \
+    } \
+    else if (texturing) \
+    { \
+        BEGIN_LOOP(); \
+        GET_FRAG(); \
+        TEXTURING(); \
+        SET_FRAG(GET_PIXEL, SET_PIXEL); \
+        END_LOOP(); \
+    } \
+    else if (lighting) \
+    { \
+        BEGIN_LOOP(); \
+        GET_FRAG(); \
+        LIGHTING(); \
+        SET_FRAG(GET_PIXEL, SET_PIXEL); \
+        END_LOOP(); \
+    } \
+    else \
+    { \
+        BEGIN_LOOP(); \
+        GET_FRAG(); \
+        SET_FRAG(GET_PIXEL, SET_PIXEL); \
+        END_LOOP(); \
+    }
 
-static PFcolor Process_Lights(const PFlight* activeLights, const PFmaterial* material, PFcolor diffuse, const PFMvec3 viewPos, const PFMvec3 fragPos, const PFMvec3 fragNormal)
-{
-    // Final color
-    // Calculate the emission component of the final color
-    PFubyte R = material->emission.r;
-    PFubyte G = material->emission.g;
-    PFubyte B = material->emission.b;
-
-    // Ambient component
-    // Calculate the ambient lighting contribution
-    PFubyte aR = (material->ambient.r*diffuse.r)/255;
-    PFubyte aG = (material->ambient.g*diffuse.g)/255;
-    PFubyte aB = (material->ambient.b*diffuse.b)/255;
-
-    // Compute the view direction from fragment position
-    PFMvec3 viewDir;
-    pfmVec3DirectionR(viewDir, viewPos, fragPos);
-
-    // Specular properties
-    // Retrieve material's shininess and specular color
-    PFfloat shininess = material->shininess;
-    PFcolor specular = material->specular;
-
-    // Loop through active lights
-    for (const PFlight *light = activeLights; light != NULL; light = light->next)
+    switch (dstFormat)
     {
-        // Declare the light contribution and initialize it to zero for now.
-        PFubyte lR = 0, lG = 0, lB = 0;
-
-        // Compute light direction
-        PFMvec3 lightDir;
-        pfmVec3SubR(lightDir, light->position, fragPos);
-
-        // Compute distance from light to fragment position
-        // And also normalize the light direction if necessary.
-        PFfloat lightToFragPosDistSq =
-            lightDir[0]*lightDir[0] +
-            lightDir[1]*lightDir[1] +
-            lightDir[2]*lightDir[2];
-
-        PFfloat lightToFragPosDist = 0;
-        if (lightToFragPosDistSq != 0.0f)
-        {
-            lightToFragPosDist = sqrtf(lightToFragPosDistSq);
-            PFfloat invMag = 1.0f/lightToFragPosDist;
-            for (int_fast8_t i = 0; i < 3; i++)
-            {
-                lightDir[i] *= invMag;
-            }
-        }
+        case PF_PIXELFORMAT_R5G6B5:
+            RASTERIZE_LOOPS(Pixel_GetR5G6B5, Pixel_SetR5G6B5);
+            break;
 
-        // Spotlight (soft edges)
-        PFubyte intensity = 255;
-        if (light->innerCutOff < M_PI)
-        {
-            PFMvec3 negLightDir;
-            pfmVec3NegR(negLightDir, light->direction);
+        case PF_PIXELFORMAT_R8G8B8:
+            RASTERIZE_LOOPS(Pixel_GetR8G8B8, Pixel_SetR8G8B8);
+            break;
 
-            PFfloat theta = pfmVec3Dot(lightDir, negLightDir);
-            PFfloat epsilon = light->innerCutOff - light->outerCutOff;
-            intensity = CLAMP((PFint)(255*(theta - light->outerCutOff)/epsilon), 0, 255);
+        case PF_PIXELFORMAT_B8G8R8:
+            RASTERIZE_LOOPS(Pixel_GetB8G8R8, Pixel_SetB8G8R8);
+            break;
 
-            if (intensity == 0)
-                goto apply_light_contribution;
-        }
-
-        // Attenuation
-        PFubyte attenuation = 255;
-        if (light->attLinear || light->attQuadratic)
-        {
-            attenuation = 255/(light->attConstant +
-                light->attLinear*lightToFragPosDist +
-                light->attQuadratic*lightToFragPosDistSq);
+        case PF_PIXELFORMAT_R8G8B8A8:
+            RASTERIZE_LOOPS(Pixel_GetR8G8B8A8, Pixel_SetR8G8B8A8);
+            break;
 
-            if (attenuation == 0)
-                goto apply_light_contribution;
-        }
-
-        // Factor used to scale the final color
-        PFubyte factor = (intensity*attenuation)/255;
-
-        // Diffuse component
-        // Calculate the diffuse reflection of the light
-        PFubyte diff = MAX((PFint)(255*pfmVec3Dot(fragNormal, lightDir)), 0);
-        lR = MIN_255(lR + (diffuse.r*light->diffuse.r*diff)/(255*255));
-        lG = MIN_255(lG + (diffuse.g*light->diffuse.g*diff)/(255*255));
-        lB = MIN_255(lB + (diffuse.b*light->diffuse.b*diff)/(255*255));
-
-        // Specular component
-#       ifndef PF_PHONG_REFLECTION
-            // Blinn-Phong
-            PFMvec3 halfWayDir;
-            pfmVec3AddR(halfWayDir, lightDir, viewDir);
-            pfmVec3Normalize(halfWayDir, halfWayDir);
-            PFubyte spec = 255*powf(fmaxf(pfmVec3Dot(fragNormal, halfWayDir), 0.0f), shininess);
-#       else
-            // Phong
-            PFMvec3 reflectDir, negLightDir;
-            pfmVec3NegR(negLightDir, lightDir);
-            pfmVec3ReflectR(reflectDir, negLightDir, fragNormal);
-            PFubyte spec = 255*powf(fmaxf(pfmVec3Dot(reflectDir, viewDir), 0.0f), shininess);
-#       endif
-
-        lR = MIN_255(lR + (specular.r*light->specular.r*spec)/(255*255));
-        lG = MIN_255(lG + (specular.g*light->specular.g*spec)/(255*255));
-        lB = MIN_255(lB + (specular.b*light->specular.b*spec)/(255*255));
-
-        // Apply spotlight soft edges and distance attenuation
-        lR = (lR*factor)/255;
-        lG = (lG*factor)/255;
-        lB = (lB*factor)/255;
-
-        // Add ambient contribution of the light
-        // Then add the light's contribution to the final color
-        apply_light_contribution:
-        R = MIN_255(R + lR + (aR*light->ambient.r)/255);
-        G = MIN_255(G + lG + (aG*light->ambient.g)/255);
-        B = MIN_255(B + lB + (aB*light->ambient.b)/255);
+        default:
+            RASTERIZE_LOOPS(pixelGetter, pixelSetter);
+            break;
     }
-
-    // Return the final computed color
-    return (PFcolor) { R, G, B, diffuse.a };
 }
 
+#endif //PF_RASTER_METHOD
+
 
 /* Internal helper function definitions */
 
@@ -831,6 +1089,27 @@ PFvertex Helper_LerpVertex(const PFvertex* start, const PFvertex* end, PFfloat t
     return result;
 }
 
+// NOTE: The guard band is the range of the screen coordinates for which the integer edge
+//       functions of the rasterizer can't overflow, it's converted here to clip space
+//       for the current viewport. The vertices must have a positive 'w' (clipped by W).
+PFboolean Helper_IsInsideGuardBand(const PFvertex* polygon, int_fast8_t vertexCounter)
+{
+    PFfloat xBand = 2.0f*(PF_GUARD_BAND_SIZE - abs(currentCtx->vpPos[0]) - 1)/(currentCtx->vpDim[0] + 1) - 1.0f;
+    PFfloat yBand = 2.0f*(PF_GUARD_BAND_SIZE - abs(currentCtx->vpPos[1]) - 1)/(currentCtx->vpDim[1] + 1) - 1.0f;
+
+    for (int_fast8_t i = 0; i < vertexCounter; i++)
+    {
+        const PFfloat *h = polygon[i].homogeneous;
+
+        if (fabsf(h[0]) > xBand*h[3] || fabsf(h[1]) > yBand*h[3])
+        {
+            return PF_FALSE;
+        }
+    }
+
+    return PF_TRUE;
+}
+
 #ifdef PF_SCANLINES_RASTER_METHOD
 
 PFboolean Helper_FaceCanBeRendered(PFface faceToRender, PFfloat* area, const PFMvec2 p1, const PFMvec2 p2, const PFMvec2 p3)
@@ -872,6 +1151,66 @@ PFcolor Helper_InterpolateColor_FLAT(PFcolor v1, PFcolor v2, PFfloat t)
 
 #else //PF_BARYCENTRIC_RASTER_METHOD
 
+// NOTE: The edge functions are evaluated exactly on the sub-pixel coordinates, at the center of
+//       the pixels, then divided (rounded down) by the sub-pixel scale so that stepping from
+//       one pixel to the next only adds the sub-pixel differences of the vertex coordinates.
+//       A pixel whose center lies on an edge is only covered by the triangle on the right of
+//       the edge, or below it if it's horizontal (top-left rule), so that the pixels along
+//       an edge shared by two triangles are drawn exactly once.
+void Helper_InitEdges(PFedges* edges, PFface faceToRender, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, PFint xOrigin, PFint yOrigin)
+{
+    PFint x1 = Rasterize_ToSubPixel(v1->screen[0]), y1 = Rasterize_ToSubPixel(v1->screen[1]);
+    PFint x2 = Rasterize_ToSubPixel(v2->screen[0]), y2 = Rasterize_ToSubPixel(v2->screen[1]);
+    PFint x3 = Rasterize_ToSubPixel(v3->screen[0]), y3 = Rasterize_ToSubPixel(v3->screen[1]);
+
+    PFint w1XStep = y3 - y2, w1YStep = x2 - x3;
+    PFint w2XStep = y1 - y3, w2YStep = x3 - x1;
+    PFint w3XStep = y2 - y1, w3YStep = x1 - x2;
+
+    if (faceToRender == PF_BACK)
+    {
+        w1XStep = -w1XStep, w1YStep = -w1YStep;
+        w2XStep = -w2XStep, w2YStep = -w2YStep;
+        w3XStep = -w3XStep, w3YStep = -w3YStep;
+    }
+
+    /* Evaluate the edge functions at the center of the origin pixel */
+
+    PFint xCenter = (xOrigin << PF_SUBPIXEL_BITS) + PF_SUBPIXEL_SCALE/2;
+    PFint yCenter = (yOrigin << PF_SUBPIXEL_BITS) + PF_SUBPIXEL_SCALE/2;
+
+    const PFint64 w1 = (PFint64)(xCenter - x2)*w1XStep + (PFint64)(yCenter - y2)*w1YStep;
+    const PFint64 w2 = (PFint64)(xCenter - x3)*w2XStep + (PFint64)(yCenter - y3)*w2YStep;
+    const PFint64 w3 = (PFint64)(xCenter - x1)*w3XStep + (PFint64)(yCenter - y1)*w3YStep;
+
+    // NOTE: The sum is twice the area of the triangle, the same for every pixel
+    PFfloat wInvSum = 1.0f/(PFfloat)(w1 + w2 + w3);
+
+    /* Apply the fill rule, pixels on the other edges need a strictly positive function */
+
+#   define IS_TOP_LEFT(XSTEP, YSTEP) ((XSTEP) > 0 || ((XSTEP) == 0 && (YSTEP) > 0))
+
+    edges->w1 = (PFint)((w1 - !IS_TOP_LEFT(w1XStep, w1YStep)) >> PF_SUBPIXEL_BITS);
+    edges->w2 = (PFint)((w2 - !IS_TOP_LEFT(w2XStep, w2YStep)) >> PF_SUBPIXEL_BITS);
+    edges->w3 = (PFint)((w3 - !IS_TOP_LEFT(w3XStep, w3YStep)) >> PF_SUBPIXEL_BITS);
+
+#   undef IS_TOP_LEFT
+
+    // NOTE: What was rounded off is the same for every pixel, since the steps are integers,
+    //       it's added back to the weights so that they still sum to one
+
+    edges->wInvSum = PF_SUBPIXEL_SCALE*wInvSum;
+    edges->w1Bias = (PFfloat)(w1 - ((PFint64)edges->w1 << PF_SUBPIXEL_BITS))*wInvSum;
+    edges->w2Bias = (PFfloat)(w2 - ((PFint64)edges->w2 << PF_SUBPIXEL_BITS))*wInvSum;
+    edges->w3Bias = (PFfloat)(w3 - ((PFint64)edges->w3 << PF_SUBPIXEL_BITS))*wInvSum;
+
+    edges->w1XStep = w1XStep, edges->w1YStep = w1YStep;
+    edges->w2XStep = w2XStep, edges->w2YStep = w2YStep;
+    edges->w3XStep = w3XStep, edges->w3YStep = w3YStep;
+}
+
+// NOTE: The SIMD blocks interpolate the smooth colors themselves (see 'simd.h')
+#ifndef PF_SIMD_WIDTH
 PFcolor Helper_InterpolateColor_SMOOTH(PFcolor v1, PFcolor v2, PFcolor v3, PFfloat w1, PFfloat w2, PFfloat w3)
 {
     PFubyte uW1 = 255*w1;
@@ -885,6 +1224,7 @@ PFcolor Helper_InterpolateColor_SMOOTH(PFcolor v1, PFcolor v2, PFcolor v3, PFflo
         ((uW1*v1.a) + (uW2*v2.a) + (uW3*v3.a))/255
     };
 }
+#endif //PF_SIMD_WIDTH
 
 PFcolor Helper_InterpolateColor_FLAT(PFcolor v1, PFcolor v2, PFcolor v3, PFfloat w1, PFfloat w2, PFfloat w3)
 {
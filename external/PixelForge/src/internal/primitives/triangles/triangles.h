@@ -22,8 +22,33 @@
 
 #include "../../context.h"
 #include "../../config.h"
+#include <math.h>
+
+/* Sub-pixel coordinates */
+
+#define PF_SUBPIXEL_SCALE (1 << PF_SUBPIXEL_BITS)
+
+// NOTE: Screen coordinates are snapped to this fixed-point grid before the face test and the
+//       edge functions, the center of the pixel (x, y) is at (x + 0.5, y + 0.5) in screen space
+static inline PFint Rasterize_ToSubPixel(PFfloat coord)
+{
+    return (PFint)floorf(coord*PF_SUBPIXEL_SCALE + 0.5f);
+}
+
+// NOTE: Index of the first pixel whose center is at or after the given sub-pixel coordinate
+static inline PFint Rasterize_FirstPixel(PFint subCoord)
+{
+    return (subCoord + PF_SUBPIXEL_SCALE/2 - 1) >> PF_SUBPIXEL_BITS;
+}
 
 PFboolean Process_ProjectAndClipTriangle(PFvertex* polygon, int_fast8_t* vertexCounter);
+PFboolean Process_ClipAndProjectTriangle(PFvertex* polygon, int_fast8_t* vertexCounter);  // NOTE: Expects 'homogeneous' to be already transformed by 'matMVP' and 'clipCode' set
+PFface Rasterize_TriangleFace(const PFvertex* v1, const PFvertex* v2, const PFvertex* v3);
 void Rasterize_Triangle(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos);
 
+#ifndef PF_SCANLINES_RASTER_METHOD
+PFboolean Rasterize_TriangleBounds(PFface faceToRender, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, PFint bounds[4]);
+void Rasterize_TriangleRect(PFface faceToRender, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, const PFMvec3 viewPos, const PFint bounds[4]);
+#endif //PF_SCANLINES_RASTER_METHOD
+
 #endif //PF_TRIANGLES_H
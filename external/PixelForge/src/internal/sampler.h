@@ -0,0 +1,232 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_SAMPLER_H
+#define PF_SAMPLER_H
+
+#include "./context.h"
+#include "./config.h"
+#include "./pixel.h"
+
+/*
+    Texture sampling.
+
+    'pfBegin' prepares the bound texture once per draw with 'Sampler_Init': the address,
+    size, power-of-two mask, fixed-point scale and layout of each of its levels, the format
+    whose texels can be read directly (RGBA8, RGB8, BGR8, R5G6B5) and the filters and wrap modes.
+
+    A sample converts its texture coordinates once to fixed-point texel positions with
+    PF_SAMPLER_SUBTEXEL_BITS fractional bits for the sampled level, the wrap, the bilinear
+    weights and the texel offsets are then computed with integers.
+
+    The level of detail comes from the screen-space derivatives of the texture coordinates
+    given by 'Sampler_InitGradients' for each triangle. They are constant over the triangles
+    drawn without perspective, and corrected for each fragment of the other ones.
+*/
+
+#define PF_SAMPLER_SUBTEXEL_BITS    8
+#define PF_SAMPLER_SUBTEXEL_ONE     (1 << PF_SAMPLER_SUBTEXEL_BITS)
+
+/**
+ * @brief Screen-space derivatives of the texture coordinates of a triangle, in texels of the first level.
+ */
+typedef struct {
+    PFfloat dudx, dudy;                 ///< Derivatives of the interpolated U (U/W with perspective)
+    PFfloat dvdx, dvdy;                 ///< Derivatives of the interpolated V (V/W with perspective)
+    PFfloat dqdx, dqdy;                 ///< Derivatives of the interpolated 1/W, used with perspective
+    PFfloat width, height;              ///< Size of the first level
+    PFfloat lod;                        ///< Level of detail of the whole triangle without perspective
+    PFboolean perspective;              ///< True if the level of detail must be computed for each fragment
+} PFtexgradients;
+
+/* Implemented in 'texture.c' */
+
+void Sampler_Init(PFsampler* sampler, const PFtexture* texture);
+void Sampler_InitGradients(const PFsampler* sampler, PFtexgradients* gradients, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3);
+
+/* Helpers */
+
+// NOTE: Approximation of log2 with a linear interpolation between the powers of two, accurate
+//       enough to select mipmap levels, zero gives -127 (magnification)
+static inline PFfloat Sampler_Log2(PFfloat x)
+{
+    union { PFfloat f; PFuint i; } bits = { x };
+    return (PFfloat)(PFint)((bits.i >> 23) & 0xFF) - 127.0f + (PFfloat)(bits.i & 0x7FFFFF)*(1.0f/(1 << 23));
+}
+
+// NOTE: Floor of 'coord*scale', limited so that the texel positions of large coordinates don't overflow
+static inline PFint Sampler_ToFixed(PFfloat coord, PFfloat scale)
+{
+    PFfloat f = CLAMP(coord*scale, -1073741824.0f, 1073741824.0f);
+    PFint i = (PFint)f;
+    return i - (f < (PFfloat)i);
+}
+
+static inline PFint Sampler_Wrap(PFint i, PFint size, PFint mask, PFtexturewrap mode)
+{
+    switch (mode)
+    {
+        case PF_WRAP_CLAMP_TO_EDGE:
+            return CLAMP(i, 0, size - 1);
+
+        case PF_WRAP_MIRRORED_REPEAT:
+        {
+            PFint period = 2*size;
+            i %= period;
+            if (i < 0) i += period;
+            return (i < size) ? i : period - 1 - i;
+        }
+
+        default:
+            if (mask >= 0) return i & mask;
+            i %= size;
+            return (i < 0) ? i + size : i;
+    }
+}
+
+// NOTE: Index of a texel of a tiled level (see 'pfSetTextureLayout') with 'tilesX' blocks per row of blocks
+static inline PFsizei Sampler_TiledOffset(PFint x, PFint y, PFint tilesX)
+{
+    const PFint mask = (1 << PF_TEXTURE_TILE_BITS) - 1;
+    PFint tile = (y >> PF_TEXTURE_TILE_BITS)*tilesX + (x >> PF_TEXTURE_TILE_BITS);
+    return (PFsizei)((tile << 2*PF_TEXTURE_TILE_BITS) | ((y & mask) << PF_TEXTURE_TILE_BITS) | (x & mask));
+}
+
+static inline PFcolor Sampler_Fetch(const PFsampler* sampler, const PFsamplerlevel* level, PFint x, PFint y)
+{
+    PFsizei offset = level->tilesX
+        ? Sampler_TiledOffset(x, y, level->tilesX)
+        : (PFsizei)(y*level->width + x);
+
+    switch (sampler->format)
+    {
+        case PF_PIXELFORMAT_R5G6B5:     return Pixel_GetR5G6B5(level->pixels, offset);
+        case PF_PIXELFORMAT_R8G8B8:     return Pixel_GetR8G8B8(level->pixels, offset);
+        case PF_PIXELFORMAT_B8G8R8:     return Pixel_GetB8G8R8(level->pixels, offset);
+        case PF_PIXELFORMAT_R8G8B8A8:   return Pixel_GetR8G8B8A8(level->pixels, offset);
+        default:                        return sampler->getter(level->pixels, offset);
+    }
+}
+
+// NOTE: 't' goes from 0 (a) to PF_SAMPLER_SUBTEXEL_ONE (b)
+static inline PFcolor Sampler_Lerp(PFcolor a, PFcolor b, PFint t)
+{
+    return (PFcolor) {
+        (PFubyte)(a.r + (((b.r - a.r)*t) >> PF_SAMPLER_SUBTEXEL_BITS)),
+        (PFubyte)(a.g + (((b.g - a.g)*t) >> PF_SAMPLER_SUBTEXEL_BITS)),
+        (PFubyte)(a.b + (((b.b - a.b)*t) >> PF_SAMPLER_SUBTEXEL_BITS)),
+        (PFubyte)(a.a + (((b.a - a.a)*t) >> PF_SAMPLER_SUBTEXEL_BITS))
+    };
+}
+
+/* Sampling */
+
+static inline PFcolor Sampler_SampleLevel(const PFsampler* sampler, const PFsamplerlevel* level, PFboolean linear, PFfloat u, PFfloat v)
+{
+    PFint fx = Sampler_ToFixed(u, level->scaleX);
+    PFint fy = Sampler_ToFixed(v, level->scaleY);
+
+    if (!linear)
+    {
+        PFint x = Sampler_Wrap(fx >> PF_SAMPLER_SUBTEXEL_BITS, level->width, level->maskX, sampler->wrapS);
+        PFint y = Sampler_Wrap(fy >> PF_SAMPLER_SUBTEXEL_BITS, level->height, level->maskY, sampler->wrapT);
+        return Sampler_Fetch(sampler, level, x, y);
+    }
+
+    // NOTE: The texel centers are at half-integer positions, the weights are
+    //       the fractional parts of the position relative to the top-left one
+
+    fx -= PF_SAMPLER_SUBTEXEL_ONE/2;
+    fy -= PF_SAMPLER_SUBTEXEL_ONE/2;
+
+    PFint tx = fx & (PF_SAMPLER_SUBTEXEL_ONE - 1);
+    PFint ty = fy & (PF_SAMPLER_SUBTEXEL_ONE - 1);
+
+    PFint x0 = fx >> PF_SAMPLER_SUBTEXEL_BITS;
+    PFint y0 = fy >> PF_SAMPLER_SUBTEXEL_BITS;
+
+    PFint x1 = Sampler_Wrap(x0 + 1, level->width, level->maskX, sampler->wrapS);
+    PFint y1 = Sampler_Wrap(y0 + 1, level->height, level->maskY, sampler->wrapT);
+    x0 = Sampler_Wrap(x0, level->width, level->maskX, sampler->wrapS);
+    y0 = Sampler_Wrap(y0, level->height, level->maskY, sampler->wrapT);
+
+    PFcolor top = Sampler_Lerp(Sampler_Fetch(sampler, level, x0, y0), Sampler_Fetch(sampler, level, x1, y0), tx);
+    PFcolor bottom = Sampler_Lerp(Sampler_Fetch(sampler, level, x0, y1), Sampler_Fetch(sampler, level, x1, y1), tx);
+
+    return Sampler_Lerp(top, bottom, ty);
+}
+
+// NOTE: A level of detail less than or equal to zero magnifies the texture
+static inline PFcolor Sampler_Sample(const PFsampler* sampler, PFfloat u, PFfloat v, PFfloat lod)
+{
+    const PFsamplerlevel *levels = sampler->levels;
+
+    if (lod <= 0.0f)
+    {
+        return Sampler_SampleLevel(sampler, &levels[0], sampler->magLinear, u, v);
+    }
+
+    switch (sampler->mipmapMode)
+    {
+        case PF_MIPMAP_NEAREST:
+        {
+            PFint level = MIN((PFint)(lod + 0.5f), sampler->levelCount - 1);
+            return Sampler_SampleLevel(sampler, &levels[level], sampler->minLinear, u, v);
+        }
+
+        case PF_MIPMAP_LINEAR:
+        {
+            PFint level = (PFint)lod;
+
+            if (level >= sampler->levelCount - 1)
+            {
+                return Sampler_SampleLevel(sampler, &levels[sampler->levelCount - 1], sampler->minLinear, u, v);
+            }
+
+            PFcolor a = Sampler_SampleLevel(sampler, &levels[level], sampler->minLinear, u, v);
+            PFcolor b = Sampler_SampleLevel(sampler, &levels[level + 1], sampler->minLinear, u, v);
+
+            return Sampler_Lerp(a, b, (PFint)((lod - level)*PF_SAMPLER_SUBTEXEL_ONE));
+        }
+
+        default:
+            return Sampler_SampleLevel(sampler, &levels[0], sampler->minLinear, u, v);
+    }
+}
+
+// NOTE: 'u' and 'v' are the perspective corrected coordinates of the fragment and 'z' its depth,
+//       the interpolated U/W and 1/W being linear, dU/dx = z*(d(U/W)/dx - U*d(1/W)/dx)
+static inline PFfloat Sampler_GetLod(const PFtexgradients* gradients, PFfloat u, PFfloat v, PFfloat z)
+{
+    if (!gradients->perspective) return gradients->lod;
+
+    PFfloat uTexel = u*gradients->width;
+    PFfloat vTexel = v*gradients->height;
+
+    PFfloat dudx = z*(gradients->dudx - uTexel*gradients->dqdx);
+    PFfloat dvdx = z*(gradients->dvdx - vTexel*gradients->dqdx);
+    PFfloat dudy = z*(gradients->dudy - uTexel*gradients->dqdy);
+    PFfloat dvdy = z*(gradients->dvdy - vTexel*gradients->dqdy);
+
+    PFfloat rhoSq = MAX(dudx*dudx + dvdx*dvdx, dudy*dudy + dvdy*dvdy);
+
+    return 0.5f*Sampler_Log2(rhoSq);
+}
+
+#endif //PF_SAMPLER_H
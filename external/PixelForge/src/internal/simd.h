@@ -0,0 +1,272 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_SIMD_H
+#define PF_SIMD_H
+
+#include "./config.h"
+#include "./context.h"
+
+/*
+    Block kernel used by the barycentric rasterizer to evaluate the edge
+    functions, the coverage, the barycentric weights, the depth and the
+    interpolants (smooth color, texture coordinates) of 'PF_SIMD_WIDTH'
+    consecutive pixels of a row at once.
+
+    The operations are done in the same order and with the same precision
+    as the scalar loop, so both paths produce exactly the same pixels.
+    'PF_SIMD_WIDTH' stays undefined when the target has no supported
+    instruction set (or with PF_NO_SIMD), the scalar loop is used then.
+
+    The vector operations are also used by the bulk vertex transform of
+    'pfDrawArrays' (see 'internal/transform'), with the same guarantee.
+*/
+
+#if !defined(PF_NO_SIMD) && !defined(PF_SCANLINES_RASTER_METHOD)
+#   if defined(__AVX2__)
+#       include <immintrin.h>
+#       define PF_SIMD_AVX2
+#       define PF_SIMD_WIDTH 8
+#   elif defined(__SSE2__)
+#       include <emmintrin.h>
+#       define PF_SIMD_SSE2
+#       define PF_SIMD_WIDTH 4
+#   elif defined(__ARM_NEON) && defined(__aarch64__)
+#       include <arm_neon.h>
+#       define PF_SIMD_NEON
+#       define PF_SIMD_WIDTH 4
+#   endif
+#endif //PF_NO_SIMD
+
+#ifdef PF_SIMD_WIDTH
+
+/* Vector types and operations */
+
+#if defined(PF_SIMD_AVX2)
+
+typedef __m256i PFsimdi;
+typedef __m256 PFsimdf;
+
+#   define Simd_LoadI(p)            _mm256_loadu_si256((const __m256i*)(p))
+#   define Simd_SetI(x)             _mm256_set1_epi32(x)
+#   define Simd_AddI(a, b)          _mm256_add_epi32(a, b)
+#   define Simd_OrI(a, b)           _mm256_or_si256(a, b)
+#   define Simd_ShlI(a, n)          _mm256_slli_epi32(a, n)
+#   define Simd_StoreI(p, a)        _mm256_storeu_si256((__m256i*)(p), a)
+#   define Simd_SignMask(a)         ((PFuint)_mm256_movemask_ps(_mm256_castsi256_ps(a)))
+#   define Simd_LoadF(p)            _mm256_loadu_ps(p)
+#   define Simd_SetF(x)             _mm256_set1_ps(x)
+#   define Simd_AddF(a, b)          _mm256_add_ps(a, b)
+#   define Simd_MulF(a, b)          _mm256_mul_ps(a, b)
+#   define Simd_DivF(a, b)          _mm256_div_ps(a, b)
+#   define Simd_StoreF(p, a)        _mm256_storeu_ps(p, a)
+#   define Simd_IntToFloat(a)       _mm256_cvtepi32_ps(a)
+#   define Simd_TruncToInt(a)       _mm256_cvttps_epi32(a)
+
+#elif defined(PF_SIMD_SSE2)
+
+typedef __m128i PFsimdi;
+typedef __m128 PFsimdf;
+
+#   define Simd_LoadI(p)            _mm_loadu_si128((const __m128i*)(p))
+#   define Simd_SetI(x)             _mm_set1_epi32(x)
+#   define Simd_AddI(a, b)          _mm_add_epi32(a, b)
+#   define Simd_OrI(a, b)           _mm_or_si128(a, b)
+#   define Simd_ShlI(a, n)          _mm_slli_epi32(a, n)
+#   define Simd_StoreI(p, a)        _mm_storeu_si128((__m128i*)(p), a)
+#   define Simd_SignMask(a)         ((PFuint)_mm_movemask_ps(_mm_castsi128_ps(a)))
+#   define Simd_LoadF(p)            _mm_loadu_ps(p)
+#   define Simd_SetF(x)             _mm_set1_ps(x)
+#   define Simd_AddF(a, b)          _mm_add_ps(a, b)
+#   define Simd_MulF(a, b)          _mm_mul_ps(a, b)
+#   define Simd_DivF(a, b)          _mm_div_ps(a, b)
+#   define Simd_StoreF(p, a)        _mm_storeu_ps(p, a)
+#   define Simd_IntToFloat(a)       _mm_cvtepi32_ps(a)
+#   define Simd_TruncToInt(a)       _mm_cvttps_epi32(a)
+
+#elif defined(PF_SIMD_NEON)
+
+typedef int32x4_t PFsimdi;
+typedef float32x4_t PFsimdf;
+
+static inline PFuint Simd_NeonSignMask(int32x4_t a)
+{
+    static const int32_t shifts[4] = { 0, 1, 2, 3 };
+    uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_s32(a), 31);
+    return vaddvq_u32(vshlq_u32(signs, vld1q_s32(shifts)));
+}
+
+#   define Simd_LoadI(p)            vld1q_s32((const int32_t*)(p))
+#   define Simd_SetI(x)             vdupq_n_s32(x)
+#   define Simd_AddI(a, b)          vaddq_s32(a, b)
+#   define Simd_OrI(a, b)           vorrq_s32(a, b)
+#   define Simd_ShlI(a, n)          vshlq_n_s32(a, n)
+#   define Simd_StoreI(p, a)        vst1q_s32((int32_t*)(p), a)
+#   define Simd_SignMask(a)         Simd_NeonSignMask(a)
+#   define Simd_LoadF(p)            vld1q_f32(p)
+#   define Simd_SetF(x)             vdupq_n_f32(x)
+#   define Simd_AddF(a, b)          vaddq_f32(a, b)
+#   define Simd_MulF(a, b)          vmulq_f32(a, b)
+#   define Simd_DivF(a, b)          vdivq_f32(a, b)
+#   define Simd_StoreF(p, a)        vst1q_f32(p, a)
+#   define Simd_IntToFloat(a)       vcvtq_f32_s32(a)
+#   define Simd_TruncToInt(a)       vcvtq_s32_f32(a)
+
+#endif
+
+/* Block kernel */
+
+/**
+ * @brief Per-triangle constants of the block kernel.
+ */
+typedef struct {
+    PFsimdi w1Offsets;                  ///< { 0, w1XStep, 2*w1XStep, ... }
+    PFsimdi w2Offsets;                  ///< { 0, w2XStep, 2*w2XStep, ... }
+    PFsimdi w3Offsets;                  ///< { 0, w3XStep, 2*w3XStep, ... }
+    PFsimdf wInvSum;                    ///< Inverse of the sum of the edge functions
+    PFsimdf w1Bias, w2Bias, w3Bias;     ///< Added to the normalized weights (see 'Helper_InitEdges')
+    PFsimdf z1, z2, z3;                 ///< Depth (reciprocal) of each vertex
+    PFsimdf c1[4], c2[4], c3[4];        ///< Color channels of each vertex (if 'smooth')
+    PFsimdf uv1[2], uv2[2], uv3[2];     ///< Texture coordinates of each vertex (if 'texturing')
+    PFboolean smooth;                   ///< Interpolate the colors as 'Helper_InterpolateColor_SMOOTH'
+    PFboolean texturing;                ///< Interpolate the texture coordinates
+} PFsimdblock;
+
+/**
+ * @brief Values computed for each pixel of a block.
+ */
+typedef struct {
+    PFfloat aW1[PF_SIMD_WIDTH];         ///< Normalized barycentric weights
+    PFfloat aW2[PF_SIMD_WIDTH];
+    PFfloat aW3[PF_SIMD_WIDTH];
+    PFfloat z[PF_SIMD_WIDTH];           ///< Depth (reciprocal of the interpolated 'z')
+    PFfloat u[PF_SIMD_WIDTH];           ///< Interpolated texture coordinates, before the perspective correction
+    PFfloat v[PF_SIMD_WIDTH];
+    PFcolor colors[PF_SIMD_WIDTH];      ///< Interpolated colors
+} PFsimdfragments;
+
+static inline void Simd_InitBlock(PFsimdblock* block, PFint w1XStep, PFint w2XStep, PFint w3XStep, PFfloat wInvSum,
+    PFfloat w1Bias, PFfloat w2Bias, PFfloat w3Bias, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3, PFboolean smooth, PFboolean texturing)
+{
+    PFint o1[PF_SIMD_WIDTH], o2[PF_SIMD_WIDTH], o3[PF_SIMD_WIDTH];
+
+    for (PFint i = 0; i < PF_SIMD_WIDTH; i++)
+    {
+        o1[i] = i*w1XStep, o2[i] = i*w2XStep, o3[i] = i*w3XStep;
+    }
+
+    block->w1Offsets = Simd_LoadI(o1);
+    block->w2Offsets = Simd_LoadI(o2);
+    block->w3Offsets = Simd_LoadI(o3);
+
+    block->wInvSum = Simd_SetF(wInvSum);
+    block->w1Bias = Simd_SetF(w1Bias);
+    block->w2Bias = Simd_SetF(w2Bias);
+    block->w3Bias = Simd_SetF(w3Bias);
+
+    block->z1 = Simd_SetF(v1->homogeneous[2]);
+    block->z2 = Simd_SetF(v2->homogeneous[2]);
+    block->z3 = Simd_SetF(v3->homogeneous[2]);
+
+    block->smooth = smooth;
+    block->texturing = texturing;
+
+    if (smooth)
+    {
+        const PFubyte *c1 = (const PFubyte*)&v1->color;
+        const PFubyte *c2 = (const PFubyte*)&v2->color;
+        const PFubyte *c3 = (const PFubyte*)&v3->color;
+
+        for (int_fast8_t i = 0; i < 4; i++)
+        {
+            block->c1[i] = Simd_SetF(c1[i]);
+            block->c2[i] = Simd_SetF(c2[i]);
+            block->c3[i] = Simd_SetF(c3[i]);
+        }
+    }
+
+    if (texturing)
+    {
+        for (int_fast8_t i = 0; i < 2; i++)
+        {
+            block->uv1[i] = Simd_SetF(v1->texcoord[i]);
+            block->uv2[i] = Simd_SetF(v2->texcoord[i]);
+            block->uv3[i] = Simd_SetF(v3->texcoord[i]);
+        }
+    }
+}
+
+// NOTE: Returns the coverage mask of the block (bit 'i' set if pixel 'i' is inside the triangle),
+//       the fragments are only written when at least one pixel is covered.
+static inline PFuint Simd_RasterizeBlock(const PFsimdblock* block, PFint w1, PFint w2, PFint w3, PFsimdfragments* frags)
+{
+    PFsimdi v1 = Simd_AddI(Simd_SetI(w1), block->w1Offsets);
+    PFsimdi v2 = Simd_AddI(Simd_SetI(w2), block->w2Offsets);
+    PFsimdi v3 = Simd_AddI(Simd_SetI(w3), block->w3Offsets);
+
+    PFuint mask = ~Simd_SignMask(Simd_OrI(Simd_OrI(v1, v2), v3)) & ((1u << PF_SIMD_WIDTH) - 1);
+    if (!mask) return 0;
+
+    PFsimdf f1 = Simd_AddF(Simd_MulF(Simd_IntToFloat(v1), block->wInvSum), block->w1Bias);
+    PFsimdf f2 = Simd_AddF(Simd_MulF(Simd_IntToFloat(v2), block->wInvSum), block->w2Bias);
+    PFsimdf f3 = Simd_AddF(Simd_MulF(Simd_IntToFloat(v3), block->wInvSum), block->w3Bias);
+
+    // NOTE: Separate multiplies and adds, a fused multiply-add would round differently than the scalar loop
+    PFsimdf zSum = Simd_AddF(Simd_AddF(Simd_MulF(f1, block->z1), Simd_MulF(f2, block->z2)), Simd_MulF(f3, block->z3));
+
+    Simd_StoreF(frags->aW1, f1);
+    Simd_StoreF(frags->aW2, f2);
+    Simd_StoreF(frags->aW3, f3);
+    Simd_StoreF(frags->z, Simd_DivF(Simd_SetF(1.0f), zSum));
+
+    if (block->smooth)
+    {
+        // NOTE: The weights are truncated to integers like in 'Helper_InterpolateColor_SMOOTH',
+        //       the products and sums stay below 2^24 so they are exact in single precision,
+        //       and the truncated division by 255 gives the same result as the integer one.
+
+        PFsimdf u1 = Simd_IntToFloat(Simd_TruncToInt(Simd_MulF(Simd_SetF(255), f1)));
+        PFsimdf u2 = Simd_IntToFloat(Simd_TruncToInt(Simd_MulF(Simd_SetF(255), f2)));
+        PFsimdf u3 = Simd_IntToFloat(Simd_TruncToInt(Simd_MulF(Simd_SetF(255), f3)));
+
+        PFsimdi packed = Simd_SetI(0);
+
+        for (int_fast8_t i = 0; i < 4; i++)
+        {
+            PFsimdf sum = Simd_AddF(Simd_AddF(Simd_MulF(u1, block->c1[i]), Simd_MulF(u2, block->c2[i])), Simd_MulF(u3, block->c3[i]));
+            PFsimdi channel = Simd_TruncToInt(Simd_DivF(sum, Simd_SetF(255)));
+            packed = Simd_OrI(packed, Simd_ShlI(channel, 8*i));
+        }
+
+        // NOTE: Little endian, the red channel is the first byte of 'PFcolor'
+        Simd_StoreI(frags->colors, packed);
+    }
+
+    if (block->texturing)
+    {
+        Simd_StoreF(frags->u, Simd_AddF(Simd_AddF(Simd_MulF(f1, block->uv1[0]), Simd_MulF(f2, block->uv2[0])), Simd_MulF(f3, block->uv3[0])));
+        Simd_StoreF(frags->v, Simd_AddF(Simd_AddF(Simd_MulF(f1, block->uv1[1]), Simd_MulF(f2, block->uv2[1])), Simd_MulF(f3, block->uv3[1])));
+    }
+
+    return mask;
+}
+
+#endif //PF_SIMD_WIDTH
+
+#endif //PF_SIMD_H
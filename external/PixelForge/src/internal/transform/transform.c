@@ -0,0 +1,159 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "./transform.h"
+#include "../simd.h"
+#include <stdint.h>
+
+/* Fetching of the vertex arrays */
+
+// NOTE: Same indexing as the other attributes of 'pfDrawArrays' (the stride is not used)
+#define FETCH_POSITIONS(type) \
+    { \
+        const type *src = (const type*)positions->buffer + i*positions->size; \
+        for (; i < end; i++, src += positions->size) \
+        { \
+            PFMvec4 p = { 0.0f, 0.0f, 0.0f, 1.0f }; \
+            for (int_fast8_t j = 0; j < positions->size; j++) p[j] = src[j]; \
+            batch->px[i - first] = p[0], batch->py[i - first] = p[1]; \
+            batch->pz[i - first] = p[2], batch->pw[i - first] = p[3]; \
+        } \
+    }
+
+#define FETCH_NORMALS(type) \
+    { \
+        const type *src = (const type*)normals->buffer + i*3; \
+        for (; i < end; i++, src += 3) \
+        { \
+            batch->nx[i - first] = src[0]; \
+            batch->ny[i - first] = src[1]; \
+            batch->nz[i - first] = src[2]; \
+        } \
+    }
+
+void Transform_FetchBatch(PFvertexbatch* batch, const PFvertexattribs* attribs, PFboolean useNormalArray, PFsizei first, PFsizei count)
+{
+    const PFvertexattribbuffer *positions = &attribs->positions;
+    const PFvertexattribbuffer *normals = &attribs->normals;
+
+    PFsizei i = first, end = first + count;
+
+    switch (positions->type)
+    {
+        case PF_SHORT:  FETCH_POSITIONS(PFshort);  break;
+        case PF_INT:    FETCH_POSITIONS(PFint);    break;
+        case PF_FLOAT:  FETCH_POSITIONS(PFfloat);  break;
+        case PF_DOUBLE: FETCH_POSITIONS(PFdouble); break;
+
+        default:
+        {
+            for (; i < end; i++)
+            {
+                batch->px[i - first] = batch->py[i - first] = batch->pz[i - first] = 0.0f;
+                batch->pw[i - first] = 1.0f;
+            }
+        }
+        break;
+    }
+
+    i = first;
+
+    if (useNormalArray && (normals->type == PF_FLOAT || normals->type == PF_DOUBLE))
+    {
+        if (normals->type == PF_FLOAT) FETCH_NORMALS(PFfloat)
+        else FETCH_NORMALS(PFdouble)
+    }
+    else
+    {
+        memset(batch->nx, 0, count*sizeof(PFfloat));
+        memset(batch->ny, 0, count*sizeof(PFfloat));
+        memset(batch->nz, 0, count*sizeof(PFfloat));
+    }
+}
+
+#undef FETCH_POSITIONS
+#undef FETCH_NORMALS
+
+
+/* Transformation and classification */
+
+void Transform_ProcessBatch(PFvertexbatch* batch, PFsizei count, const PFMmat4 matMVP, const PFMmat4 matNormal)
+{
+    PFsizei i = 0;
+
+    // NOTE: The vector kernel does the operations of 'pfmVec4Transform' in the same order,
+    //       each lane gives exactly the same result as the scalar loop used for the rest
+
+#ifdef PF_SIMD_WIDTH
+
+    PFsimdf m[16];
+
+    for (int_fast8_t j = 0; j < 16; j++)
+    {
+        m[j] = Simd_SetF(matMVP[j]);
+    }
+
+    for (; i + PF_SIMD_WIDTH <= count; i += PF_SIMD_WIDTH)
+    {
+        PFsimdf x = Simd_LoadF(batch->px + i);
+        PFsimdf y = Simd_LoadF(batch->py + i);
+        PFsimdf z = Simd_LoadF(batch->pz + i);
+        PFsimdf w = Simd_LoadF(batch->pw + i);
+
+        Simd_StoreF(batch->hx + i, Simd_AddF(Simd_AddF(Simd_AddF(Simd_MulF(m[0], x), Simd_MulF(m[4], y)), Simd_MulF(m[8], z)), Simd_MulF(m[12], w)));
+        Simd_StoreF(batch->hy + i, Simd_AddF(Simd_AddF(Simd_AddF(Simd_MulF(m[1], x), Simd_MulF(m[5], y)), Simd_MulF(m[9], z)), Simd_MulF(m[13], w)));
+        Simd_StoreF(batch->hz + i, Simd_AddF(Simd_AddF(Simd_AddF(Simd_MulF(m[2], x), Simd_MulF(m[6], y)), Simd_MulF(m[10], z)), Simd_MulF(m[14], w)));
+        Simd_StoreF(batch->hw + i, Simd_AddF(Simd_AddF(Simd_AddF(Simd_MulF(m[3], x), Simd_MulF(m[7], y)), Simd_MulF(m[11], z)), Simd_MulF(m[15], w)));
+    }
+
+#endif //PF_SIMD_WIDTH
+
+    for (; i < count; i++)
+    {
+        PFfloat x = batch->px[i], y = batch->py[i], z = batch->pz[i], w = batch->pw[i];
+
+        batch->hx[i] = matMVP[0]*x + matMVP[4]*y + matMVP[8]*z + matMVP[12]*w;
+        batch->hy[i] = matMVP[1]*x + matMVP[5]*y + matMVP[9]*z + matMVP[13]*w;
+        batch->hz[i] = matMVP[2]*x + matMVP[6]*y + matMVP[10]*z + matMVP[14]*w;
+        batch->hw[i] = matMVP[3]*x + matMVP[7]*y + matMVP[11]*z + matMVP[15]*w;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        batch->clipCodes[i] = Transform_ClassifyVertex(batch->hx[i], batch->hy[i], batch->hz[i], batch->hw[i]);
+    }
+
+    // NOTE: The normals keep the scalar 'pfmVec3Normalize', its approximated reciprocal
+    //       square root has no vector equivalent giving the same results on every target
+
+    if (matNormal != NULL)
+    {
+        for (i = 0; i < count; i++)
+        {
+            PFMvec3 normal = { batch->nx[i], batch->ny[i], batch->nz[i] };
+
+            pfmVec3Transform(normal, normal, matNormal);
+            pfmVec3Normalize(normal, normal);
+
+            batch->nx[i] = normal[0];
+            batch->ny[i] = normal[1];
+            batch->nz[i] = normal[2];
+        }
+    }
+}
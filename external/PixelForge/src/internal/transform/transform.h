@@ -0,0 +1,68 @@
+/**
+ *  Copyright (c) 2024 Le Juez Victor
+ *
+ *  This software is provided "as-is", without any express or implied warranty. In no event 
+ *  will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial 
+ *  applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you 
+ *  wrote the original software. If you use this software in a product, an acknowledgment 
+ *  in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *  as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PF_TRANSFORM_H
+#define PF_TRANSFORM_H
+
+#include "../context.h"
+#include "../config.h"
+
+/*
+    Bulk vertex transform.
+
+    'pfDrawArrays' fetches the vertices of its array by batches of PF_VERTEX_BATCH_SIZE
+    into the structure-of-arrays buffers of 'PFvertexbatch', transforms all of them at
+    once and classifies them against the view frustum in a single pass, before assembling
+    the primitives. A triangle whose vertices are all inside the frustum then skips the
+    polygon clipping, and one whose vertices are all outside of the same plane is rejected
+    without being clipped (see 'Process_ClipAndProjectTriangle').
+*/
+
+/**
+ * @brief Planes of the view frustum in clip space, in the same order as the polygon clipping.
+ */
+typedef enum {
+    PF_FRUSTUM_W        = 0x01,         ///< w < PF_CLIP_EPSILON
+    PF_FRUSTUM_RIGHT    = 0x02,         ///< x > w
+    PF_FRUSTUM_LEFT     = 0x04,         ///< -x > w
+    PF_FRUSTUM_TOP      = 0x08,         ///< y > w
+    PF_FRUSTUM_BOTTOM   = 0x10,         ///< -y > w
+    PF_FRUSTUM_FAR      = 0x20,         ///< z > w
+    PF_FRUSTUM_NEAR     = 0x40,         ///< -z > w
+} PFfrustumplane;
+
+// NOTE: Uses the same comparisons as 'Process_ClipPolygonW' and 'Process_ClipPolygonXYZ',
+//       so a polygon without any bit set in the codes of its vertices is left unchanged by them
+static inline PFubyte Transform_ClassifyVertex(PFfloat x, PFfloat y, PFfloat z, PFfloat w)
+{
+    return (w < PF_CLIP_EPSILON ? PF_FRUSTUM_W : 0)
+         | (x > w ? PF_FRUSTUM_RIGHT : 0) | (-x > w ? PF_FRUSTUM_LEFT : 0)
+         | (y > w ? PF_FRUSTUM_TOP : 0) | (-y > w ? PF_FRUSTUM_BOTTOM : 0)
+         | (z > w ? PF_FRUSTUM_FAR : 0) | (-z > w ? PF_FRUSTUM_NEAR : 0);
+}
+
+// NOTE: Fills the positions and normals of 'batch' with 'count' vertices of the arrays, starting at 'first'.
+//       Missing position components default to (0, 0, 0, 1) and normals to zero without normal array.
+void Transform_FetchBatch(PFvertexbatch* batch, const PFvertexattribs* attribs, PFboolean useNormalArray, PFsizei first, PFsizei count);
+
+// NOTE: Computes the homogeneous coordinates and the clip codes of the vertices of 'batch',
+//       the normals are also transformed by 'matNormal' and normalized if it's not NULL.
+void Transform_ProcessBatch(PFvertexbatch* batch, PFsizei count, const PFMmat4 matMVP, const PFMmat4 matNormal);
+
+#endif //PF_TRANSFORM_H
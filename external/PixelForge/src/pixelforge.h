@@ -43,6 +43,8 @@
     #define PF_API
 #endif //PF_API
 
+// NOTE: PF_CTX_THREAD_LOCAL tells that each thread has its own current context,
+//       it must be defined along with a custom thread-local PF_CTX_DECL
 #ifndef PF_CTX_DECL
 #   if defined(__GNUC__) || defined(__clang__)
 #       if defined(PF_SUPPORT_OPENMP) && defined(__GNUC__)
@@ -51,9 +53,11 @@
 #           define PF_CTX_DECL
 #       else
 #           define PF_CTX_DECL __thread
+#           define PF_CTX_THREAD_LOCAL
 #       endif
 #   elif defined(_MSC_VER)
 #       define PF_CTX_DECL __declspec(thread)
+#       define PF_CTX_THREAD_LOCAL
 #   endif
 #endif //PF_CTX_DECL
 
@@ -164,6 +168,9 @@ typedef enum {
     PF_NORMAL_ARRAY         = 0x0200,
     PF_COLOR_ARRAY          = 0x0400,
     PF_TEXTURE_COORD_ARRAY  = 0x0800,
+    PF_LINE_SMOOTH          = 0x1000,
+    PF_VERTEX_LIGHTING      = 0x2000,   // Lighting computed per vertex (Gouraud) instead of per fragment
+    PF_PIXELS_OVERLAY       = 0x4000,   // 'pfDrawPixels' neither tests nor writes the depth buffer (2D overlays)
 } PFstate;
 
 typedef enum {
@@ -327,7 +334,8 @@ typedef enum {
     PF_SPOT_OUTER_CUTOFF        = 11,
     PF_CONSTANT_ATTENUATION     = 12,
     PF_LINEAR_ATTENUATION       = 13,
-    PF_QUADRATIC_ATTENUATION    = 14
+    PF_QUADRATIC_ATTENUATION    = 14,
+    PF_DIRECTION                = 15
 } PFlightparam;
 
 typedef enum {
@@ -377,8 +385,31 @@ typedef enum {
     PF_PIXELFORMAT_R16,
     PF_PIXELFORMAT_R16G16B16,
     PF_PIXELFORMAT_R16G16B16A16,
+    PF_PIXELFORMAT_B8G8R8,          // Same as R8G8B8 with the red and blue bytes swapped (e.g. Plan 9 RGB24)
 } PFpixelformat;
 
+typedef enum {
+    PF_FILTER_NEAREST = 0,
+    PF_FILTER_LINEAR,
+    PF_FILTER_NEAREST_MIPMAP_NEAREST,
+    PF_FILTER_LINEAR_MIPMAP_NEAREST,
+    PF_FILTER_NEAREST_MIPMAP_LINEAR,
+    PF_FILTER_LINEAR_MIPMAP_LINEAR,
+} PFtexturefilter;
+
+typedef enum {
+    PF_WRAP_REPEAT = 0,
+    PF_WRAP_CLAMP_TO_EDGE,
+    PF_WRAP_MIRRORED_REPEAT,
+} PFtexturewrap;
+
+typedef enum {
+    PF_LAYOUT_LINEAR = 0,           // Rows of texels one after the other
+    PF_LAYOUT_TILED,                // Blocks of 4x4 texels one after the other (see 'pfSetTextureLayout')
+} PFtexturelayout;
+
+// NOTE: The fields after 'format' are zero for the textures created by 'pfGenTexture' and others,
+//       which gives a texture without mipmaps sampled from the nearest texel with repeat wrap.
 struct PFtexture {
     PFpixelsetter pixelSetter;
     PFpixelgetter pixelGetter;
@@ -386,15 +417,37 @@ struct PFtexture {
     PFsizei width;
     PFsizei height;
     PFpixelformat format;
+    PFsizei mipmaps;                // Number of levels stored one after the other in 'pixels' (0 or 1 without mipmaps)
+    PFtexturefilter minFilter;      // Filter used when the texture is minified
+    PFtexturefilter magFilter;      // Filter used when the texture is magnified (nearest or linear)
+    PFtexturewrap wrapS;            // Wrap mode of the U coordinates
+    PFtexturewrap wrapT;            // Wrap mode of the V coordinates
+    PFtexturelayout layout;         // Order of the texels in 'pixels'
 };
 
 /* Framebuffer defintions */
 
+// NOTE: 'zbufferMax' keeps an upper bound of the depths of each block of 'zbuffer' to skip hidden blocks,
+//       if you write to 'zbuffer' yourself, raise the value of the block or set 'zbufferMax' to NULL.
+//       'zbufferPending' flags the blocks cleared by 'pfClear' whose depths haven't been written yet,
+//       they all equal the 'zbufferMax' value of the block. If you access 'zbuffer' yourself, write
+//       them first ('pfGetFramebufferDepth' and 'pfSetFramebufferPixelDepth*' handle it).
 typedef struct {
     PFtexture texture;
     PFfloat *zbuffer;
+    PFfloat *zbufferMax;
+    PFubyte *zbufferPending;
 } PFframebuffer;
 
+/* Damage region definitions */
+
+typedef struct {
+    PFint x;
+    PFint y;
+    PFsizei width;
+    PFsizei height;
+} PFrect;
+
 #if defined(__cplusplus)
 extern "C" {
 #endif //__cplusplus
@@ -413,6 +466,9 @@ extern "C" {
  * @param height       Height of the target buffer.
  * @param pixelFormat  Pixel format of the target buffer.
  *
+ * @note With PF_PIXELFORMAT_R5G6B5, PF_PIXELFORMAT_R8G8B8, PF_PIXELFORMAT_B8G8R8 and PF_PIXELFORMAT_R8G8B8A8
+ *       the rasterizers write the target buffer directly, other formats go through the pixel getter/setter.
+ *
  * @return Pointer to the created rendering context.
  */
 PF_API PFcontext pfCreateContext(void* targetBuffer, PFsizei width, PFsizei height, PFpixelformat pixelFormat);
@@ -455,6 +511,9 @@ PF_API void pfSetAuxBuffer(void *auxFramebuffer);
 /**
  * @brief Swaps the front and back buffers.
  *
+ * The damage region (see 'pfGetDamage') stays relative to the last presented frame: the region
+ * emptied by the last 'pfResetDamage' is added back, since the new back buffer doesn't have it.
+ *
  * @warning This function needs a context to be defined.
  */
 PF_API void pfSwapBuffers(void);
@@ -506,6 +565,44 @@ PF_API void pfEnable(PFstate state);
  */
 PF_API void pfDisable(PFstate state);
 
+/**
+ * @brief Rasterizes all the triangles deferred by the binned rasterizer.
+ *
+ * Triangles are only deferred when PixelForge is built with 'PF_SUPPORT_BINNED_RASTER',
+ * otherwise this function does nothing. The flush is also done implicitly by 'pfSwapBuffers',
+ * 'pfClear', 'pfReadPixels' and any state change that affects rasterization.
+ *
+ * @warning This function needs a context to be defined.
+ *
+ * @note Call it before accessing the pixels of the framebuffer yourself,
+ *       or before modifying a texture that has been used since the last flush.
+ */
+PF_API void pfFlush(void);
+
+/**
+ * @brief Retrieves the regions of the main framebuffer modified since the last call to 'pfResetDamage'.
+ *
+ * The region is a conservative union of the bounds of every primitive and clear that wrote to the
+ * main framebuffer, as up to PF_MAX_DAMAGE_RECTS rectangles that never overlap. It describes what
+ * differs from the frame presented at the last 'pfResetDamage', even across 'pfSwapBuffers'.
+ * A color clear with the same color as that frame's only damages what was drawn over it.
+ *
+ * @warning This function needs a context to be defined.
+ *
+ * @param rects Receives a pointer to the rectangles, valid until the next drawing call.
+ * @return The number of rectangles, 0 if nothing has changed.
+ *
+ * @note Writes done outside of the API (e.g. directly to the buffer) are not tracked.
+ */
+PF_API PFsizei pfGetDamage(const PFrect** rects);
+
+/**
+ * @brief Empties the damage region, to call once the modified regions have been presented.
+ *
+ * @warning This function needs a context to be defined.
+ */
+PF_API void pfResetDamage(void);
+
 
 
 /* Getter API functions */
@@ -696,6 +793,8 @@ PF_API void pfViewport(PFint x, PFint y, PFsizei width, PFsizei height);
  * @warning This function needs a context to be defined.
  *
  * @param func Pointer to the pixel getter function.
+ *
+ * @note Setting a custom getter disables the direct pixel access of the main framebuffer format.
  */
 PF_API void pfSetDefaultPixelGetter(PFpixelgetter func);
 
@@ -705,6 +804,8 @@ PF_API void pfSetDefaultPixelGetter(PFpixelgetter func);
  * @warning This function needs a context to be defined.
  *
  * @param func Pointer to the pixel setter function.
+ *
+ * @note Setting a custom setter disables the direct pixel access of the main framebuffer format.
  */
 PF_API void pfSetDefaultPixelSetter(PFpixelsetter func);
 
@@ -883,6 +984,9 @@ PF_API void pfLightf(PFsizei light, PFenum param, PFfloat value);
  *
  * @warning This function needs a context to be defined.
  *
+ * @note Setting PF_DIRECTION makes the light directional (infinitely far and never attenuated),
+ *       setting PF_POSITION makes it a point light again.
+ *
  * @param light Index of the light source.
  * @param param Parameter to set (e.g., PF_LIGHT_POSITION, PF_LIGHT_DIFFUSE).
  * @param value Pointer to the value array to set for the parameter.
@@ -1365,6 +1469,10 @@ PF_API void pfRectfv(const PFfloat* v1, const PFfloat* v2);
 /**
  * @brief Draws pixels on the screen.
  *
+ * The pixels are copied row by row when they have the same format as the framebuffer and
+ * neither depth test nor blending is enabled, scaled by 'pfPixelZoom' with nearest sampling.
+ * With PF_PIXELS_OVERLAY enabled, the depth buffer is neither tested nor written.
+ *
  * @warning This function needs a context to be defined.
  *
  * @param width Width of the pixel data.
@@ -1755,6 +1863,79 @@ PF_API void pfDeleteTexture(PFtexture* texture);
  */
 PF_API PFboolean pfIsValidTexture(PFtexture* texture);
 
+/**
+ * @brief Generates the mipmaps of a texture from its first level.
+ *
+ * Each level is half the size of the previous one (at least one pixel) and is obtained by
+ * averaging blocks of 2x2 texels. The levels are stored after the first one in 'texture->pixels',
+ * which is reallocated, and 'texture->mipmaps' is set to their number.
+ *
+ * @note The pixels must have been allocated with PF_MALLOC (the texture owns them, as for 'pfDeleteTexture').
+ *       Call 'pfFlush' before if the texture has been used since the last flush.
+ *
+ * @param texture Pointer to the texture object.
+ * @return PFboolean False if the pixels could not be reallocated, the texture is then left unchanged.
+ */
+PF_API PFboolean pfGenTextureMipmaps(PFtexture* texture);
+
+/**
+ * @brief Sets the filters used when sampling a texture.
+ *
+ * The mipmap filters of 'minFilter' only select other levels than the first one if the texture
+ * has mipmaps (see 'pfGenTextureMipmaps'). The level of detail is computed for each fragment
+ * from the screen-space derivatives of the texture coordinates.
+ *
+ * @note Call 'pfFlush' before if the texture has been used since the last flush.
+ *
+ * @param texture Pointer to the texture object.
+ * @param minFilter Filter used when the texture is minified.
+ * @param magFilter Filter used when the texture is magnified (PF_FILTER_NEAREST or PF_FILTER_LINEAR).
+ */
+PF_API void pfSetTextureFilter(PFtexture* texture, PFtexturefilter minFilter, PFtexturefilter magFilter);
+
+/**
+ * @brief Sets how the texture coordinates outside of [0..1] are wrapped.
+ *
+ * @note Call 'pfFlush' before if the texture has been used since the last flush.
+ *
+ * @param texture Pointer to the texture object.
+ * @param wrapS Wrap mode of the U coordinates.
+ * @param wrapT Wrap mode of the V coordinates.
+ */
+PF_API void pfSetTextureWrap(PFtexture* texture, PFtexturewrap wrapS, PFtexturewrap wrapT);
+
+/**
+ * @brief Reorders the texels of a texture, mipmaps included.
+ *
+ * With PF_LAYOUT_TILED, the texels are stored by blocks of 4x4 texels (PF_TEXTURE_TILE_BITS in
+ * 'internal/config.h'), the blocks in rows and the texels in rows within a block, each level being
+ * padded to a whole number of blocks. Neighboring texels of a column are then close in memory, which keeps the sampling of
+ * rotated or perspective-mapped textures in the cache.
+ *
+ * The functions of the API taking coordinates ('pfSetTexturePixel', 'pfGetTextureSample', ...) handle
+ * both layouts, only the code reading 'texture->pixels' directly must take the layout into account
+ * (see 'pfGetTextureOffset').
+ *
+ * @note The pixels must have been allocated with PF_MALLOC (the texture owns them, as for 'pfDeleteTexture').
+ *       A tiled texture must not be used as the texture of a framebuffer.
+ *       Call 'pfFlush' before if the texture has been used since the last flush.
+ *
+ * @param texture Pointer to the texture object.
+ * @param layout New layout of the texels.
+ * @return PFboolean False if the new pixels could not be allocated, the texture is then left unchanged.
+ */
+PF_API PFboolean pfSetTextureLayout(PFtexture* texture, PFtexturelayout layout);
+
+/**
+ * @brief Returns the index of a texel of the first level in 'texture->pixels', for its layout.
+ *
+ * @param texture Pointer to the texture object.
+ * @param x X coordinate of the texel.
+ * @param y Y coordinate of the texel.
+ * @return PFsizei Index of the texel, to be given to the pixel getter or setter of the texture.
+ */
+PF_API PFsizei pfGetTextureOffset(const PFtexture* texture, PFsizei x, PFsizei y);
+
 /**
  * @brief Sets the color value of a pixel in the texture.
  *
@@ -1787,11 +1968,8 @@ PF_API PFcolor pfGetTexturePixel(const PFtexture* texture, PFsizei x, PFsizei y)
  * This function sets the color value of a specific texture coordinate (u, v) in the texture.
  * The texture coordinates (u, v) and the color value are provided.
  *
- * @note: To use this function correctly, textures must be power-of-two (POT).
- *        If you absolutely need support for non-POT textures, you can define
- *        `PF_SUPPORT_NO_POT_TEXTURE`. Just be aware that sample retrieval
- *        will be slower as it will perform two modulo operations per call
- *        instead of two bit-wise AND operations.
+ * @note: Coordinates are wrapped with the wrap modes of the texture and the nearest texel
+ *        of the first level is written.
  *
  * @param texture Pointer to the texture object.
  * @param u The U coordinate of the texture.
@@ -1806,11 +1984,9 @@ PF_API void pfSetTextureSample(PFtexture* texture, PFfloat u, PFfloat v, PFcolor
  * This function retrieves the color value of a specific texture coordinate (u, v) from the texture.
  * The texture coordinates (u, v) are provided.
  *
- * @note: To use this function correctly, textures must be power-of-two (POT).
- *        If you absolutely need support for non-POT textures, you can define
- *        `PF_SUPPORT_NO_POT_TEXTURE`. Just be aware that sample retrieval
- *        will be slower as it will perform two modulo operations per call
- *        instead of two bit-wise AND operations.
+ * @note: Coordinates are wrapped with the wrap modes of the texture and the first level
+ *        is sampled with its magnification filter. Power-of-two sizes are wrapped with
+ *        bit-wise AND operations, the other ones with modulo operations.
  *
  * @param texture Pointer to the texture object.
  * @param u The U coordinate of the texture.
@@ -1819,6 +1995,23 @@ PF_API void pfSetTextureSample(PFtexture* texture, PFfloat u, PFfloat v, PFcolor
  */
 PF_API PFcolor pfGetTextureSample(const PFtexture* texture, PFfloat u, PFfloat v);
 
+/**
+ * @brief Converts a row of pixels from one format to another.
+ *
+ * The grayscale, R5G6B5, R8G8B8, B8G8R8 and R8G8B8A8 formats are converted by loops
+ * specialized for each of them, with SSE2 where it is available, the other formats
+ * through their pixel getter and setter. Every conversion goes through 8 bit channels,
+ * giving the same pixels as the getters and setters of the textures.
+ *
+ * @param dst Pointer to the converted pixels.
+ * @param dstFormat The pixel format of 'dst'.
+ * @param src Pointer to the pixels to convert, must not overlap 'dst'.
+ * @param srcFormat The pixel format of 'src'.
+ * @param count Number of pixels to convert.
+ * @return PFboolean PF_FALSE if one of the formats is unknown, nothing is converted then.
+ */
+PF_API PFboolean pfConvertPixels(void* dst, PFpixelformat dstFormat, const void* src, PFpixelformat srcFormat, PFsizei count);
+
 
 /*
  *  Blending functions
@@ -1829,6 +2022,7 @@ PF_API PFcolor pfGetTextureSample(const PFtexture* texture, PFfloat u, PFfloat v
 
 PF_API PFcolor pfBlend(PFcolor source, PFcolor destination);
 PF_API PFcolor pfBlendAlpha(PFcolor source, PFcolor destination);
+PF_API PFcolor pfBlendPremultiplied(PFcolor source, PFcolor destination);
 PF_API PFcolor pfBlendAdditive(PFcolor source, PFcolor destination);
 PF_API PFcolor pfBlendSubtractive(PFcolor source, PFcolor destination);
 PF_API PFcolor pfBlendMultiplicative(PFcolor source, PFcolor destination);
@@ -1847,8 +2041,59 @@ PF_API PFboolean pfDepthGreater(PFfloat source, PFfloat destination);
 PF_API PFboolean pfDepthNotequal(PFfloat source, PFfloat destination);
 PF_API PFboolean pfDepthGequal(PFfloat source, PFfloat destination);
 
-PF_API unsigned int pfStoreTexture(PFtexture *p);
-PF_API PFtexture * pfGetTexture(unsigned int id);
+/*
+ *  Texture registry
+ *
+ *  Textures stored here are referenced by ids (never zero) that stay valid until released,
+ *  released slots are reused and the ids of released textures no longer resolve.
+ *  The registry is shared by all contexts.
+ */
+
+/**
+ * @brief Stores a copy of the texture in the registry and returns its id.
+ *
+ * The registry takes ownership of the texture pixels, they are freed with 'pfDeleteTexture'
+ * when the texture is released.
+ *
+ * @param texture Pointer to the texture to store.
+ * @return PFuint The id of the texture, or zero if the registry could not grow.
+ */
+PF_API PFuint pfStoreTexture(const PFtexture* texture);
+
+/**
+ * @brief Retrieves a stored texture from its id.
+ *
+ * @note The returned pointer stays the same until the texture is released.
+ *
+ * @param id The id returned by 'pfStoreTexture'.
+ * @return PFtexture* The stored texture, or NULL if the id is zero or has been released.
+ */
+PF_API PFtexture* pfGetTexture(PFuint id);
+
+/**
+ * @brief Frees a stored texture and its pixels, and makes its id invalid.
+ *
+ * Triangles deferred by the current context are rasterized first and the texture
+ * is unbound from it if needed.
+ *
+ * @warning The texture must not be used by pending draws of other contexts.
+ *
+ * @param id The id returned by 'pfStoreTexture', invalid ids are ignored.
+ */
+PF_API void pfReleaseTexture(PFuint id);
+
+/**
+ * @brief Returns the number of textures currently stored in the registry.
+ */
+PF_API PFsizei pfGetStoredTextureCount(void);
+
+/**
+ * @brief Returns the size in bytes of the pixels of all the textures currently stored in the registry.
+ *
+ * @note All the levels are counted, with the padding of the tiled textures, and the size
+ *       of a stored texture is updated by 'pfGenTextureMipmaps' and 'pfSetTextureLayout'.
+ */
+PF_API PFsizei pfGetStoredTextureBytes(void);
 
 #if defined(__cplusplus)
 }
@@ -22,6 +22,8 @@
  */
 
 #include "internal/context.h"
+#include "internal/sampler.h"
+#include "internal/pixel.h"
 #include "internal/config.h"
 #include "pixelforge.h"
 #include "pfm.h"
@@ -31,6 +33,11 @@
 #include <string.h>
 #include <math.h>
 
+/* Including internal function prototypes */
+
+extern void pfInternal_UpdateStoredTexture(const PFtexture* texture);
+extern void pfInternal_FlushBins(void);
+
 /* Internal convert functions */
 
 #if defined(__GNUC__) && !defined(__clang__)
@@ -65,39 +72,28 @@ static PFfloat HalfToFloat(PFushort x)
 
 static void SetGrayscale(void* pixels, PFsizei offset, PFcolor color)
 {
-    // NOTE: Calculate grayscale equivalent color
-    PFMvec3 nCol = { (PFfloat)color.r*INV_255, (PFfloat)color.g*INV_255, (PFfloat)color.b*INV_255 };
-    PFubyte gray = (PFubyte)((nCol[0]*0.299f + nCol[1]*0.587f + nCol[2]*0.114f)*255.0f);
-
-    ((PFubyte*)pixels)[offset] = gray;
+    ((PFubyte*)pixels)[offset] = Pixel_Gray(color.r, color.g, color.b);
 }
 
 static void SetGrayAlpha(void* pixels, PFsizei offset, PFcolor color)
 {
-    // NOTE: Calculate grayscale equivalent color
-    PFMvec3 nCol = { (PFfloat)color.r*INV_255, (PFfloat)color.g*INV_255, (PFfloat)color.b*INV_255 };
-    PFubyte gray = (PFubyte)((nCol[0]*0.299f + nCol[1]*0.587f + nCol[2]*0.114f)*255.0f);
-
     PFubyte *pixel = (PFubyte*)pixels + offset*2;
-    pixel[0] = gray, pixel[1] = color.a;
+    pixel[0] = Pixel_Gray(color.r, color.g, color.b), pixel[1] = color.a;
 }
 
 static void SetR5G6B5(void* pixels, PFsizei offset, PFcolor color)
 {
-    // NOTE: Calculate R5G6B5 equivalent color
-    PFMvec3 nCol = { (PFfloat)color.r*INV_255, (PFfloat)color.g*INV_255, (PFfloat)color.b*INV_255 };
-
-    PFubyte r = (PFubyte)(roundf(nCol[0]*31.0f));
-    PFubyte g = (PFubyte)(roundf(nCol[1]*63.0f));
-    PFubyte b = (PFubyte)(roundf(nCol[2]*31.0f));
-
-    ((PFushort*)pixels)[offset] = (PFushort)r << 11 | (PFushort)g << 5 | (PFushort)b;
+    Pixel_SetR5G6B5(pixels, offset, color);
 }
 
 static void SetR8G8B8(void* pixels, PFsizei offset, PFcolor color)
 {
-    PFubyte* pixel = (PFubyte*)pixels + offset*3;
-    pixel[0] = color.r, pixel[1] = color.g, pixel[2] = color.b;
+    Pixel_SetR8G8B8(pixels, offset, color);
+}
+
+static void SetB8G8R8(void* pixels, PFsizei offset, PFcolor color)
+{
+    Pixel_SetB8G8R8(pixels, offset, color);
 }
 
 static void SetR5G5B5A1(void* pixels, PFsizei offset, PFcolor color)
@@ -128,7 +124,7 @@ static void SetR4G4B4A4(void* pixels, PFsizei offset, PFcolor color)
 
 static void SetR8G8B8A8(void* pixels, PFsizei offset, PFcolor color)
 {
-    ((PFuint*)pixels)[offset] = *(PFuint*)(&color);
+    Pixel_SetR8G8B8A8(pixels, offset, color);
 }
 
 static void SetR32(void* pixels, PFsizei offset, PFcolor color)
@@ -203,20 +199,17 @@ static PFcolor GetGrayAlpha(const void* pixels, PFsizei offset)
 
 static PFcolor GetR5G6B5(const void* pixels, PFsizei offset)
 {
-    PFushort pixel = ((PFushort*)pixels)[offset];
-
-    return (PFcolor) {
-        (PFubyte)((PFfloat)((pixel & 0xF800) >> 11)*(255/31)),              // 0b1111100000000000
-        (PFubyte)((PFfloat)((pixel & 0x7E0) >> 5)*(255/63)),                // 0b0000011111100000
-        (PFubyte)((PFfloat)(pixel & 0x1F)*(255/31)),                        // 0b0000000000011111
-        255
-    };
+    return Pixel_GetR5G6B5(pixels, offset);
 }
 
 static PFcolor GetR8G8B8(const void* pixels, PFsizei offset)
 {
-    const PFubyte* vs = pixels;
-    return (PFcolor) { vs[(offset*3)+0], vs[(offset*3)+1], vs[(offset*3)+2], 255 };
+    return Pixel_GetR8G8B8(pixels, offset);
+}
+
+static PFcolor GetB8G8R8(const void* pixels, PFsizei offset)
+{
+    return Pixel_GetB8G8R8(pixels, offset);
 }
 
 static PFcolor GetR5G5B5A1(const void* pixels, PFsizei offset)
@@ -224,9 +217,9 @@ static PFcolor GetR5G5B5A1(const void* pixels, PFsizei offset)
     PFushort pixel = ((PFushort*)pixels)[offset];
 
     return (PFcolor) {
-        (PFubyte)((PFfloat)((pixel & 0xF800) >> 11)*(255/31)),              // 0b1111100000000000
-        (PFubyte)((PFfloat)((pixel & 0x7C0) >> 6)*(255/31)),                // 0b0000011111000000
-        (PFubyte)((PFfloat)((pixel & 0x3E) >> 1)*(255/31)),                 // 0b0000000000111110
+        Pixel_Expand5((pixel & 0xF800) >> 11),                              // 0b1111100000000000
+        Pixel_Expand5((pixel & 0x7C0) >> 6),                                // 0b0000011111000000
+        Pixel_Expand5((pixel & 0x3E) >> 1),                                 // 0b0000000000111110
         (PFubyte)((pixel & 0x1)*255)                                        // 0b0000000000000001
     };
 }
@@ -245,9 +238,7 @@ static PFcolor GetR4G4B4A4(const void* pixels, PFsizei offset)
 
 static PFcolor GetR8G8B8A8(const void* pixels, PFsizei offset)
 {
-    // 6c was aligning PFcolor to 8 bytes
-    PFubyte *c = ((PFubyte*)pixels) + (offset*4);
-    return (PFcolor){c[0], c[1], c[2], c[3]};
+    return Pixel_GetR8G8B8A8(pixels, offset);
 }
 
 static PFcolor GetR32(const void* pixels, PFsizei offset)
@@ -351,6 +342,11 @@ void pfInternal_GetPixelGetterSetter(PFpixelgetter* getter, PFpixelsetter* sette
             if (setter) *setter = SetR8G8B8;
             break;
 
+        case PF_PIXELFORMAT_B8G8R8:
+            if (getter) *getter = GetB8G8R8;
+            if (setter) *setter = SetB8G8R8;
+            break;
+
         case PF_PIXELFORMAT_R8G8B8A8:
             if (getter) *getter = GetR8G8B8A8;
             if (setter) *setter = SetR8G8B8A8;
@@ -408,7 +404,8 @@ PFsizei pfInternal_GetPixelBytes(PFpixelformat format)
         case PF_PIXELFORMAT_R5G5B5A1:
         case PF_PIXELFORMAT_R4G4B4A4:       return 2;
         case PF_PIXELFORMAT_R8G8B8A8:       return 4;
-        case PF_PIXELFORMAT_R8G8B8:         return 3;
+        case PF_PIXELFORMAT_R8G8B8:
+        case PF_PIXELFORMAT_B8G8R8:         return 3;
         case PF_PIXELFORMAT_R32:            return 4;
         case PF_PIXELFORMAT_R32G32B32:      return 4*3;
         case PF_PIXELFORMAT_R32G32B32A32:   return 4*4;
@@ -427,6 +424,104 @@ PFsizei pfInternal_GetPixelBytes(PFpixelformat format)
     return 0;
 }
 
+PFpixelformat pfInternal_GetDirectPixelFormat(const PFtexture* texture)
+{
+    switch (texture->format)
+    {
+        case PF_PIXELFORMAT_R5G6B5:
+        case PF_PIXELFORMAT_R8G8B8:
+        case PF_PIXELFORMAT_B8G8R8:
+        case PF_PIXELFORMAT_R8G8B8A8:
+            break;
+
+        default:
+            return PF_PIXELFORMAT_UNKNOWN;
+    }
+
+    // NOTE: A getter or setter set with 'pfSetDefaultPixelGetter/Setter' must still be called
+    PFpixelgetter getter = NULL;
+    PFpixelsetter setter = NULL;
+    pfInternal_GetPixelGetterSetter(&getter, &setter, texture->format);
+
+    return (texture->pixelGetter == getter && texture->pixelSetter == setter)
+        ? texture->format : PF_PIXELFORMAT_UNKNOWN;
+}
+
+// NOTE: Fills the pixels of any format written by its built-in setter by converting the color
+//       once. A pixel made of identical bytes (black, white, grays of 8 bit channels...) is
+//       filled with 'memset', the others are copied over the buffer, doubling the copied area
+//       at each step. Returns false if the texture has its own setter, called for each pixel.
+PFboolean pfInternal_FillPixels(PFtexture* texture, PFsizei size, PFcolor color)
+{
+    PFpixelsetter setter = NULL;
+    pfInternal_GetPixelGetterSetter(NULL, &setter, texture->format);
+
+    if (setter == NULL || texture->pixelSetter != setter) return PF_FALSE;
+    if (size == 0) return PF_TRUE;
+
+    setter(texture->pixels, 0, color);
+
+    PFubyte *pixels = (PFubyte*)texture->pixels;
+    PFsizei bpp = pfInternal_GetPixelBytes(texture->format);
+    PFsizei total = size*bpp;
+
+    PFboolean uniform = PF_TRUE;
+
+    for (PFsizei i = 1; i < bpp; i++)
+    {
+        uniform &= (pixels[i] == pixels[0]);
+    }
+
+    if (uniform)
+    {
+        memset(pixels, pixels[0], total);
+        return PF_TRUE;
+    }
+
+    for (PFsizei filled = bpp; filled < total;)
+    {
+        PFsizei copy = MIN(filled, total - filled);
+        memcpy(pixels + filled, pixels, copy);
+        filled += copy;
+    }
+
+    return PF_TRUE;
+}
+
+// NOTE: Number of blocks of a tiled texture along a side of 'size' texels
+static inline PFsizei pfInternal_GetTileCount(PFsizei size)
+{
+    return (size + (1 << PF_TEXTURE_TILE_BITS) - 1) >> PF_TEXTURE_TILE_BITS;
+}
+
+// NOTE: Number of texels of a level in the pixels of a texture, the tiled levels being padded to whole blocks
+static PFsizei pfInternal_GetLevelTexels(PFsizei width, PFsizei height, PFtexturelayout layout)
+{
+    if (layout == PF_LAYOUT_LINEAR) return width*height;
+    return (pfInternal_GetTileCount(width)*pfInternal_GetTileCount(height)) << (2*PF_TEXTURE_TILE_BITS);
+}
+
+// NOTE: Size of the pixels of all the levels of a texture, with the padding of the tiled levels
+PFsizei pfInternal_GetTextureBytes(const PFtexture* texture)
+{
+    PFsizei levelCount = MAX(texture->mipmaps, 1);
+    PFsizei size = 0;
+
+    for (PFsizei i = 0, w = texture->width, h = texture->height; i < levelCount; i++)
+    {
+        size += pfInternal_GetLevelTexels(w, h, texture->layout);
+        w = MAX(w/2, 1), h = MAX(h/2, 1);
+    }
+
+    return size*pfInternal_GetPixelBytes(texture->format);
+}
+
+static inline PFsizei pfInternal_GetTexelOffset(PFtexturelayout layout, PFsizei width, PFsizei x, PFsizei y)
+{
+    if (layout == PF_LAYOUT_LINEAR) return y*width + x;
+    return Sampler_TiledOffset((PFint)x, (PFint)y, (PFint)pfInternal_GetTileCount(width));
+}
+
 
 /* Texture functions */
 
@@ -495,6 +590,8 @@ PFtexture pfGenTextureBufferColor(PFsizei width, PFsizei height, PFcolor color,
 
 void pfDeleteTexture(PFtexture* texture)
 {
+    pfInternal_FlushBins();
+
     if (texture)
     {
         if (texture->pixels)
@@ -515,36 +612,325 @@ PFboolean pfIsValidTexture(PFtexture* texture)
 
 void pfSetTexturePixel(PFtexture* texture, PFsizei x, PFsizei y, PFcolor color)
 {
-    texture->pixelSetter(texture->pixels, y*texture->width + x, color);
+    pfInternal_FlushBins();
+    texture->pixelSetter(texture->pixels, pfInternal_GetTexelOffset(texture->layout, texture->width, x, y), color);
 }
 
 PFcolor pfGetTexturePixel(const PFtexture* texture, PFsizei x, PFsizei y)
 {
-    return texture->pixelGetter(texture->pixels, y*texture->width + x);
+    return texture->pixelGetter(texture->pixels, pfInternal_GetTexelOffset(texture->layout, texture->width, x, y));
 }
 
 void pfSetTextureSample(PFtexture* texture, PFfloat u, PFfloat v, PFcolor color)
 {
-#ifdef PF_SUPPORT_NO_POT_TEXTURE
-    PFsizei x = (PFsizei)((u - (PFint)u)*(texture->width - 1)) % texture->width;
-    PFsizei y = (PFsizei)((v - (PFint)v)*(texture->height - 1)) % texture->height;
-#else
-    PFsizei x = (PFsizei)((u - (PFint)u)*(texture->width - 1)) & (texture->width - 1);
-    PFsizei y = (PFsizei)((v - (PFint)v)*(texture->height - 1)) & (texture->height - 1);
-#endif //PF_SUPPORT_NO_POT_TEXTURE
+    pfInternal_FlushBins();
+
+    PFint width = (PFint)texture->width, height = (PFint)texture->height;
+
+    PFint x = Sampler_ToFixed(u, (PFfloat)width);
+    PFint y = Sampler_ToFixed(v, (PFfloat)height);
 
-    texture->pixelSetter(texture->pixels, y*texture->width + x, color);
+    x = Sampler_Wrap(x, width, (width & (width - 1)) ? -1 : width - 1, texture->wrapS);
+    y = Sampler_Wrap(y, height, (height & (height - 1)) ? -1 : height - 1, texture->wrapT);
+
+    texture->pixelSetter(texture->pixels, pfInternal_GetTexelOffset(texture->layout, width, x, y), color);
 }
 
 PFcolor pfGetTextureSample(const PFtexture* texture, PFfloat u, PFfloat v)
 {
-#ifdef PF_SUPPORT_NO_POT_TEXTURE
-    PFsizei x = (PFsizei)((u - (PFint)u)*(texture->width - 1)) % texture->width;
-    PFsizei y = (PFsizei)((v - (PFint)v)*(texture->height - 1)) % texture->height;
-#else
-    PFsizei x = (PFsizei)((u - (PFint)u)*(texture->width - 1)) & (texture->width - 1);
-    PFsizei y = (PFsizei)((v - (PFint)v)*(texture->height - 1)) & (texture->height - 1);
-#endif //PF_SUPPORT_NO_POT_TEXTURE
+    PFsampler sampler;
+    Sampler_Init(&sampler, texture);
+
+    return Sampler_Sample(&sampler, u, v, 0.0f);
+}
+
+PFboolean pfGenTextureMipmaps(PFtexture* texture)
+{
+    PFsizei bpp = pfInternal_GetPixelBytes(texture->format);
+    if (!texture->pixels || bpp == 0) return PF_FALSE;
+
+    /* Count the levels and reallocate the pixels for all of them */
+
+    PFtexturelayout layout = texture->layout;
+
+    PFsizei levelCount = 1;
+    PFsizei size = pfInternal_GetLevelTexels(texture->width, texture->height, layout);
+
+    for (PFsizei w = texture->width, h = texture->height; (w > 1 || h > 1) && levelCount < PF_MAX_TEXTURE_LEVELS; levelCount++)
+    {
+        w = MAX(w/2, 1), h = MAX(h/2, 1);
+        size += pfInternal_GetLevelTexels(w, h, layout);
+    }
+
+    pfInternal_FlushBins();
+
+    PFubyte *pixels = (PFubyte*)PF_REALLOC(texture->pixels, size*bpp);
+
+    if (!pixels)
+    {
+        if (currentCtx) currentCtx->errCode = PF_ERROR_OUT_OF_MEMORY;
+        return PF_FALSE;
+    }
+
+    texture->pixels = pixels;
+
+    /* Average each block of 2x2 texels of a level into one texel of the next one */
+
+    PFsizei wSrc = texture->width, hSrc = texture->height;
+    PFubyte *src = pixels;
+
+    for (PFsizei level = 1; level < levelCount; level++)
+    {
+        PFsizei wDst = MAX(wSrc/2, 1), hDst = MAX(hSrc/2, 1);
+        PFubyte *dst = src + pfInternal_GetLevelTexels(wSrc, hSrc, layout)*bpp;
+
+        for (PFsizei y = 0; y < hDst; y++)
+        {
+            PFsizei y0 = MIN(2*y, hSrc - 1);
+            PFsizei y1 = MIN(2*y + 1, hSrc - 1);
+
+            for (PFsizei x = 0; x < wDst; x++)
+            {
+                PFsizei x0 = MIN(2*x, wSrc - 1);
+                PFsizei x1 = MIN(2*x + 1, wSrc - 1);
+
+                PFcolor c00 = texture->pixelGetter(src, pfInternal_GetTexelOffset(layout, wSrc, x0, y0));
+                PFcolor c10 = texture->pixelGetter(src, pfInternal_GetTexelOffset(layout, wSrc, x1, y0));
+                PFcolor c01 = texture->pixelGetter(src, pfInternal_GetTexelOffset(layout, wSrc, x0, y1));
+                PFcolor c11 = texture->pixelGetter(src, pfInternal_GetTexelOffset(layout, wSrc, x1, y1));
+
+                texture->pixelSetter(dst, pfInternal_GetTexelOffset(layout, wDst, x, y), (PFcolor) {
+                    (PFubyte)((c00.r + c10.r + c01.r + c11.r + 2) >> 2),
+                    (PFubyte)((c00.g + c10.g + c01.g + c11.g + 2) >> 2),
+                    (PFubyte)((c00.b + c10.b + c01.b + c11.b + 2) >> 2),
+                    (PFubyte)((c00.a + c10.a + c01.a + c11.a + 2) >> 2)
+                });
+            }
+        }
+
+        src = dst, wSrc = wDst, hSrc = hDst;
+    }
+
+    texture->mipmaps = levelCount;
+
+    pfInternal_UpdateStoredTexture(texture);
+
+    return PF_TRUE;
+}
+
+void pfSetTextureFilter(PFtexture* texture, PFtexturefilter minFilter, PFtexturefilter magFilter)
+{
+    if (minFilter > PF_FILTER_LINEAR_MIPMAP_LINEAR || magFilter > PF_FILTER_LINEAR)
+    {
+        if (currentCtx) currentCtx->errCode = PF_INVALID_ENUM;
+        return;
+    }
+
+    pfInternal_FlushBins();
+
+    texture->minFilter = minFilter;
+    texture->magFilter = magFilter;
+}
+
+void pfSetTextureWrap(PFtexture* texture, PFtexturewrap wrapS, PFtexturewrap wrapT)
+{
+    if (wrapS > PF_WRAP_MIRRORED_REPEAT || wrapT > PF_WRAP_MIRRORED_REPEAT)
+    {
+        if (currentCtx) currentCtx->errCode = PF_INVALID_ENUM;
+        return;
+    }
+
+    pfInternal_FlushBins();
+
+    texture->wrapS = wrapS;
+    texture->wrapT = wrapT;
+}
+
+PFboolean pfSetTextureLayout(PFtexture* texture, PFtexturelayout layout)
+{
+    if (layout > PF_LAYOUT_TILED)
+    {
+        if (currentCtx) currentCtx->errCode = PF_INVALID_ENUM;
+        return PF_FALSE;
+    }
+
+    if (texture->layout == layout) return PF_TRUE;
+
+    pfInternal_FlushBins();
+
+    PFsizei bpp = pfInternal_GetPixelBytes(texture->format);
+    if (!texture->pixels || bpp == 0) return PF_FALSE;
+
+    /* Allocate the pixels of all the levels in the new layout */
+
+    PFsizei levelCount = MAX(texture->mipmaps, 1);
+    PFsizei size = 0;
+
+    for (PFsizei i = 0, w = texture->width, h = texture->height; i < levelCount; i++)
+    {
+        size += pfInternal_GetLevelTexels(w, h, layout);
+        w = MAX(w/2, 1), h = MAX(h/2, 1);
+    }
+
+    PFubyte *pixels = (PFubyte*)PF_MALLOC(size*bpp);
+
+    if (!pixels)
+    {
+        if (currentCtx) currentCtx->errCode = PF_ERROR_OUT_OF_MEMORY;
+        return PF_FALSE;
+    }
+
+    /* Move each texel of each level to its new place */
+
+    const PFubyte *src = (const PFubyte*)texture->pixels;
+    PFubyte *dst = pixels;
+
+    for (PFsizei i = 0, w = texture->width, h = texture->height; i < levelCount; i++)
+    {
+        for (PFsizei y = 0; y < h; y++)
+        {
+            for (PFsizei x = 0; x < w; x++)
+            {
+                memcpy(dst + pfInternal_GetTexelOffset(layout, w, x, y)*bpp,
+                       src + pfInternal_GetTexelOffset(texture->layout, w, x, y)*bpp, bpp);
+            }
+        }
+
+        src += pfInternal_GetLevelTexels(w, h, texture->layout)*bpp;
+        dst += pfInternal_GetLevelTexels(w, h, layout)*bpp;
+        w = MAX(w/2, 1), h = MAX(h/2, 1);
+    }
+
+    PF_FREE(texture->pixels);
+
+    texture->pixels = pixels;
+    texture->layout = layout;
+
+    pfInternal_UpdateStoredTexture(texture);
+
+    return PF_TRUE;
+}
+
+PFsizei pfGetTextureOffset(const PFtexture* texture, PFsizei x, PFsizei y)
+{
+    return pfInternal_GetTexelOffset(texture->layout, texture->width, x, y);
+}
+
+
+/* Texture sampling */
+
+void Sampler_Init(PFsampler* sampler, const PFtexture* texture)
+{
+    /* Get the levels of the texture */
+
+    PFsizei bpp = pfInternal_GetPixelBytes(texture->format);
+    PFint levelCount = CLAMP((PFint)texture->mipmaps, 1, PF_MAX_TEXTURE_LEVELS);
+
+    const PFubyte *pixels = (const PFubyte*)texture->pixels;
+    PFint width = (PFint)texture->width, height = (PFint)texture->height;
+
+    for (PFint i = 0; i < levelCount; i++)
+    {
+        PFsamplerlevel *level = &sampler->levels[i];
+
+        level->pixels = pixels;
+        level->width = width, level->height = height;
+        level->maskX = (width & (width - 1)) ? -1 : width - 1;
+        level->maskY = (height & (height - 1)) ? -1 : height - 1;
+        level->scaleX = (PFfloat)width*PF_SAMPLER_SUBTEXEL_ONE;
+        level->scaleY = (PFfloat)height*PF_SAMPLER_SUBTEXEL_ONE;
+        level->tilesX = (texture->layout == PF_LAYOUT_TILED) ? (PFint)pfInternal_GetTileCount(width) : 0;
+
+        pixels += pfInternal_GetLevelTexels(width, height, texture->layout)*bpp;
+        width = MAX(width/2, 1), height = MAX(height/2, 1);
+    }
+
+    sampler->levelCount = levelCount;
+    sampler->format = pfInternal_GetDirectPixelFormat(texture);
+    sampler->getter = texture->pixelGetter;
+
+    /* Get the filters */
+
+    sampler->magLinear = (texture->magFilter == PF_FILTER_LINEAR);
+
+    switch (texture->minFilter)
+    {
+        case PF_FILTER_LINEAR:
+            sampler->minLinear = PF_TRUE, sampler->mipmapMode = PF_MIPMAP_NONE;
+            break;
+
+        case PF_FILTER_NEAREST_MIPMAP_NEAREST:
+            sampler->minLinear = PF_FALSE, sampler->mipmapMode = PF_MIPMAP_NEAREST;
+            break;
+
+        case PF_FILTER_LINEAR_MIPMAP_NEAREST:
+            sampler->minLinear = PF_TRUE, sampler->mipmapMode = PF_MIPMAP_NEAREST;
+            break;
+
+        case PF_FILTER_NEAREST_MIPMAP_LINEAR:
+            sampler->minLinear = PF_FALSE, sampler->mipmapMode = PF_MIPMAP_LINEAR;
+            break;
+
+        case PF_FILTER_LINEAR_MIPMAP_LINEAR:
+            sampler->minLinear = PF_TRUE, sampler->mipmapMode = PF_MIPMAP_LINEAR;
+            break;
+
+        default:
+            sampler->minLinear = PF_FALSE, sampler->mipmapMode = PF_MIPMAP_NONE;
+            break;
+    }
+
+    if (levelCount == 1)
+    {
+        sampler->mipmapMode = PF_MIPMAP_NONE;
+    }
+
+    sampler->useLod = (sampler->minLinear != sampler->magLinear) || (sampler->mipmapMode != PF_MIPMAP_NONE);
+
+    sampler->wrapS = texture->wrapS;
+    sampler->wrapT = texture->wrapT;
+}
+
+// NOTE: The gradients of the attributes are those of the planes passing through the three vertices,
+//       in screen space. The texture coordinates of the 3D triangles are already divided by W.
+void Sampler_InitGradients(const PFsampler* sampler, PFtexgradients* gradients, PFboolean is3D, const PFvertex* v1, const PFvertex* v2, const PFvertex* v3)
+{
+    PFfloat width = (PFfloat)sampler->levels[0].width;
+    PFfloat height = (PFfloat)sampler->levels[0].height;
+
+    PFfloat dx2 = v2->screen[0] - v1->screen[0], dy2 = v2->screen[1] - v1->screen[1];
+    PFfloat dx3 = v3->screen[0] - v1->screen[0], dy3 = v3->screen[1] - v1->screen[1];
+
+    PFfloat det = dx2*dy3 - dx3*dy2;
+    PFfloat invDet = (det != 0.0f) ? 1.0f/det : 0.0f;
+
+#   define GRADIENT(A1, A2, A3, DX, DY) \
+    { \
+        PFfloat da2 = (A2) - (A1), da3 = (A3) - (A1); \
+        DX = (da2*dy3 - da3*dy2)*invDet; \
+        DY = (da3*dx2 - da2*dx3)*invDet; \
+    }
+
+    GRADIENT(v1->texcoord[0]*width, v2->texcoord[0]*width, v3->texcoord[0]*width, gradients->dudx, gradients->dudy);
+    GRADIENT(v1->texcoord[1]*height, v2->texcoord[1]*height, v3->texcoord[1]*height, gradients->dvdx, gradients->dvdy);
+
+    if (is3D)
+    {
+        GRADIENT(v1->homogeneous[2], v2->homogeneous[2], v3->homogeneous[2], gradients->dqdx, gradients->dqdy);
+    }
+    else
+    {
+        gradients->dqdx = gradients->dqdy = 0.0f;
+    }
+
+#   undef GRADIENT
+
+    gradients->width = width;
+    gradients->height = height;
+    gradients->perspective = is3D;
+
+    PFfloat rhoSq = MAX(gradients->dudx*gradients->dudx + gradients->dvdx*gradients->dvdx,
+                        gradients->dudy*gradients->dudy + gradients->dvdy*gradients->dvdy);
 
-    return texture->pixelGetter(texture->pixels, y*texture->width + x);
+    gradients->lod = 0.5f*Sampler_Log2(rhoSq);
 }
@@ -6,14 +6,31 @@
 #include <sys/times.h>
 
 #include <ctype.h>
+#include <lock.h>
+#include <unistd.h>
 
 static uint xr, yr;
 
 typedef struct {
-  uchar *rgbuf;
+  uchar *rgbuf[2]; // pixelforge renders into one while the other is presented
+  uchar *back;     // buffer pixelforge renders into
+  uchar *front;    // last buffer handed to the presenter
+  uchar *stage;    // rows of a damaged rectangle, packed for loadimage
   PFcontext pctx;
   int wctlfd;
   Image *img;
+
+  // presenter proc, uploads a finished frame while the next one renders.
+  // the queue holds a single frame, the one being presented: a frame
+  // finished before the presenter is done is dropped and its damage
+  // carried over to the next one.
+  // it shares our memory (RFMEM) and waits for each frame in a rendezvous
+  // on &pdata.pending, the only point where it can be woken up
+  Lock lk;         // protects pending and quit
+  uchar *pending;  // frame being presented, nil when the presenter is idle
+  PFrect *rects;   // its damaged rectangles
+  int nrects, maxrects;
+  int quit;
 } PlatformData;
 
 extern CoreData CORE;
@@ -28,27 +45,6 @@ wresize(int x, int y, int w, int h)
   fprint(pdata.wctlfd, "resize -r %d %d %d %d\n", x, y, w+x, h+y);
 }
 
-static void
-set_pixel(void *buf_, PFsizei index, PFcolor color)
-{
-  uchar* buf = buf_;
-  buf[index*3]     = color.b;
-  buf[(index*3)+1] = color.g;
-  buf[(index*3)+2] = color.r;
-}
-
-static PFcolor
-get_pixel(void *buf_, PFsizei index)
-{
-  uchar* buf = buf_;
-  return (PFcolor) {
-    buf[(index*3)+2],
-    buf[(index*3)+1],
-    buf[(index*3)],
-    0xff
-  };
-}
-
 bool
 WindowShouldClose(void)
 {
@@ -331,7 +327,7 @@ redraw(void)
     }
   }
 
-  if (loadimage(pdata.img, pdata.img->r, (void*)pdata.rgbuf, w*h*3) < 0) {
+  if (loadimage(pdata.img, pdata.img->r, (void*)pdata.front, w*h*3) < 0) {
     printf("loadimage err\n");
     abort();
   }
@@ -341,6 +337,68 @@ redraw(void)
   flushimage(display, 1);
 }
 
+// upload and draw only the damaged rectangles of a frame, display must be locked
+static void
+redrawrects(uchar *buf, const PFrect *rects, int n)
+{
+  int w = CORE.Window.screen.width;
+
+  for (int i = 0; i < n; i++) {
+    int rw = rects[i].width, rh = rects[i].height;
+    uchar *src = buf + (rects[i].y*w + rects[i].x)*3;
+    uchar *data = src;
+
+    // full width rows are already contiguous
+    if (rw != w) {
+      data = pdata.stage;
+      for (int y = 0; y < rh; y++)
+        memcpy(data + y*rw*3, src + y*w*3, rw*3);
+    }
+
+    Rectangle r = Rect(rects[i].x, rects[i].y, rects[i].x+rw, rects[i].y+rh);
+    if (loadimage(pdata.img, r, data, rw*rh*3) < 0) {
+      printf("loadimage err\n");
+      abort();
+    }
+
+    draw(screen, rectaddpt(r, Pt(xr, yr)), pdata.img, nil, r.min);
+  }
+
+  if (n > 0)
+    flushimage(display, 1);
+}
+
+// wake the presenter, it is idle or about to be once pending is nil
+static void
+wakepresenter(void)
+{
+  rendezvous(&pdata.pending, nil);
+}
+
+static void
+presentproc(void)
+{
+  for (;;) {
+    rendezvous(&pdata.pending, nil);
+
+    lock(&pdata.lk);
+    int quit = pdata.quit;
+    unlock(&pdata.lk);
+    if (quit)
+      break;
+
+    // the frame and its rectangles are left alone until pending is cleared
+    lockdisplay(display);
+    redrawrects(pdata.pending, pdata.rects, pdata.nrects);
+    unlockdisplay(display);
+
+    lock(&pdata.lk);
+    pdata.pending = nil;
+    unlock(&pdata.lk);
+  }
+}
+
+// called by event() in PollInputEvents(), with the display locked
 void
 eresized(int new)
 {
@@ -356,7 +414,37 @@ eresized(int new)
 void
 SwapScreenBuffer(void)
 {
-  redraw();
+  const PFrect *rects;
+
+  pfFlush(); // draw whatever is still binned before the buffer goes to the screen
+
+  lock(&pdata.lk);
+  uchar *pending = pdata.pending;
+  unlock(&pdata.lk);
+
+  // nothing changed, or still presenting the previous frame: drop this one,
+  // pixelforge keeps its damage and the next frame is rendered over it
+  int n = pfGetDamage(&rects);
+  if (n == 0 || pending != nil)
+    return;
+
+  if (n > pdata.maxrects) {
+    pdata.rects = realloc(pdata.rects, n*sizeof(PFrect));
+    pdata.maxrects = n;
+  }
+  memcpy(pdata.rects, rects, n*sizeof(PFrect));
+  pdata.nrects = n;
+  pfResetDamage();
+
+  // the damage stays relative to the presented frame across the swap
+  pfSwapBuffers();
+  pdata.front = pdata.back;
+  pdata.back = pdata.back == pdata.rgbuf[0] ? pdata.rgbuf[1] : pdata.rgbuf[0];
+
+  lock(&pdata.lk);
+  pdata.pending = pdata.front;
+  unlock(&pdata.lk);
+  wakepresenter();
 }
 
 vlong
@@ -449,6 +537,9 @@ PollInputEvents(void)
 
   Event e;
   int key;
+
+  // the presenter proc draws meanwhile, and event() may call eresized()
+  lockdisplay(display);
   while (ecanread(Emouse|Ekeyboard)) {
     key = event(&e);
     Mouse m = e.mouse;
@@ -495,6 +586,7 @@ PollInputEvents(void)
         CORE.Window.shouldClose = 1;
     }
   }
+  unlockdisplay(display);
 }
 
 
@@ -509,17 +601,34 @@ InitPlatform(void)
 
   pdata.img = nil;
   pdata.wctlfd = open("/dev/wctl", O_RDWR);
-  pdata.rgbuf = malloc(w*h*3);
-  pdata.pctx = pfCreateContext(pdata.rgbuf, CORE.Window.screen.width, CORE.Window.screen.height, PF_PIXELFORMAT_R8G8B8);
+  pdata.rgbuf[0] = calloc(w*h, 3);
+  pdata.rgbuf[1] = calloc(w*h, 3);
+  pdata.back = pdata.rgbuf[0];
+  pdata.front = pdata.rgbuf[1];
+  pdata.stage = malloc(w*h*3);
+  // RGB24 is stored blue first, pixelforge writes it directly
+  pdata.pctx = pfCreateContext(pdata.back, CORE.Window.screen.width, CORE.Window.screen.height, PF_PIXELFORMAT_B8G8R8);
   pfMakeCurrent(pdata.pctx);
-
-  pfSetDefaultPixelGetter(get_pixel);
-  pfSetDefaultPixelSetter(set_pixel);
+  pfSetAuxBuffer(pdata.front);
 
   initdraw(nil, nil, argv0);
-  einit(Emouse|Ekeyboard);
 
+  // the presenter proc draws too
+  display->locking = 1;
+
+  lockdisplay(display);
+  einit(Emouse|Ekeyboard);
   redraw();
+  unlockdisplay(display);
+
+  switch (rfork(RFPROC|RFMEM|RFNOWAIT)) {
+  case -1:
+    TRACELOG(LOG_FATAL, "PLATFORM: plan9: can't start the presenter");
+    return -1;
+  case 0:
+    presentproc();
+    _exit(0);
+  }
 
   CORE.Window.ready = true;
 
@@ -550,4 +659,11 @@ InitPlatform(void)
 void
 ClosePlatform(void)
 {
+  lock(&pdata.lk);
+  pdata.quit = 1;
+  unlock(&pdata.lk);
+
+  // returns once the presenter is done with its last frame, it exits
+  // without touching the buffers again
+  wakepresenter();
 }
@@ -0,0 +1,649 @@
+/**********************************************************************************************
+*
+*   rcore_headless - Functions to manage window, graphics device and inputs
+*
+*   PLATFORM: HEADLESS
+*       - Linux and other POSIX systems, no display required
+*
+*   LIMITATIONS:
+*       - No window, monitor, cursor or clipboard: those functions are stubs
+*       - No gamepad or touch input
+*       - Inputs only come from the events pushed with PushHeadless*Event()
+*
+*   ADDITIONAL NOTES:
+*       - TRACELOG() function is located in raylib [utils] module
+*       - Frames are rendered by PixelForge into a malloc'd R8G8B8A8 buffer,
+*         read it with GetHeadlessFramebuffer() after EndDrawing()
+*       - Events pushed between two frames are applied by the next PollInputEvents()
+*
+*   CONFIGURATION:
+*       #define MAX_HEADLESS_EVENTS
+*           Maximum number of input events waiting for the next PollInputEvents()
+*
+*   DEPENDENCIES:
+*       - PixelForge: software renderer (GRAPHICS_API_OPENGL_11 bridge)
+*       - gestures: Gestures system for touch-ready devices (or simulated from mouse inputs)
+*
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2013-2024 Ramon Santamaria (@raysan5) and contributors
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+#include <time.h>               // Required for: clock_gettime()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#ifndef MAX_HEADLESS_EVENTS
+    #define MAX_HEADLESS_EVENTS      256        // Maximum number of queued input events
+#endif
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef enum {
+    HEADLESS_EVENT_KEY_UP = 0,          // param[0]: key
+    HEADLESS_EVENT_KEY_DOWN,            // param[0]: key
+    HEADLESS_EVENT_CHAR,                // param[0]: codepoint
+    HEADLESS_EVENT_MOUSE_BUTTON_UP,     // param[0]: button
+    HEADLESS_EVENT_MOUSE_BUTTON_DOWN,   // param[0]: button
+    HEADLESS_EVENT_MOUSE_POSITION,      // value: position
+    HEADLESS_EVENT_MOUSE_WHEEL,         // value: wheel move
+    HEADLESS_EVENT_CLOSE                // no params
+} HeadlessEventType;
+
+typedef struct {
+    HeadlessEventType type;             // Event type
+    int param;                          // Key, codepoint or button
+    GETS(Vector2) value;                // Mouse position or wheel move
+} HeadlessEvent;
+
+typedef struct {
+    unsigned char *pixels;              // Main framebuffer, R8G8B8A8
+    PFcontext context;                  // PixelForge context rendering into 'pixels'
+
+    HeadlessEvent events[MAX_HEADLESS_EVENTS];  // Events waiting for the next PollInputEvents()
+    int eventCount;                     // Number of queued events
+} PlatformData;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+extern CoreData CORE;                   // Global CORE state context
+
+static PlatformData platform = { 0 };   // Platform specific data
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions Declaration
+//----------------------------------------------------------------------------------
+int InitPlatform(void);          // Initialize platform (graphics, inputs and more)
+void ClosePlatform(void);        // Close platform
+
+static void PushHeadlessEvent(HeadlessEventType type, int param, GETS(Vector2) value);  // Queue an input event
+static void ProcessHeadlessEvent(const HeadlessEvent *event);                           // Apply an input event to CORE.Input
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// NOTE: Functions declaration is provided by raylib.h
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition: Window and Graphics Device
+//----------------------------------------------------------------------------------
+
+// Check if application should close
+bool WindowShouldClose(void)
+{
+    if (CORE.Window.ready) return CORE.Window.shouldClose;
+    else return true;
+}
+
+// Toggle fullscreen mode
+void ToggleFullscreen(void)
+{
+    TRACELOG(LOG_WARNING, "ToggleFullscreen() not available on target platform");
+}
+
+// Toggle borderless windowed mode
+void ToggleBorderlessWindowed(void)
+{
+    TRACELOG(LOG_WARNING, "ToggleBorderlessWindowed() not available on target platform");
+}
+
+// Set window state: maximized, if resizable
+void MaximizeWindow(void)
+{
+    TRACELOG(LOG_WARNING, "MaximizeWindow() not available on target platform");
+}
+
+// Set window state: minimized
+void MinimizeWindow(void)
+{
+    TRACELOG(LOG_WARNING, "MinimizeWindow() not available on target platform");
+}
+
+// Set window state: not minimized/maximized
+void RestoreWindow(void)
+{
+    TRACELOG(LOG_WARNING, "RestoreWindow() not available on target platform");
+}
+
+// Set window configuration state using flags
+void SetWindowState(unsigned int flags)
+{
+    TRACELOG(LOG_WARNING, "SetWindowState() not available on target platform");
+}
+
+// Clear window configuration state flags
+void ClearWindowState(unsigned int flags)
+{
+    TRACELOG(LOG_WARNING, "ClearWindowState() not available on target platform");
+}
+
+// Set icon for window
+void SetWindowIcon(GETS(Image) image)
+{
+    TRACELOG(LOG_WARNING, "SetWindowIcon() not available on target platform");
+}
+
+// Set icon for window
+void SetWindowIcons(GETS(Image) *images, int count)
+{
+    TRACELOG(LOG_WARNING, "SetWindowIcons() not available on target platform");
+}
+
+// Set title for window
+void SetWindowTitle(const char *title)
+{
+    CORE.Window.title = title;
+}
+
+// Set window position on screen (windowed mode)
+void SetWindowPosition(int x, int y)
+{
+    CORE.Window.position.x = x;
+    CORE.Window.position.y = y;
+}
+
+// Set monitor for the current window
+void SetWindowMonitor(int monitor)
+{
+    TRACELOG(LOG_WARNING, "SetWindowMonitor() not available on target platform");
+}
+
+// Set window minimum dimensions (FLAG_WINDOW_RESIZABLE)
+void SetWindowMinSize(int width, int height)
+{
+    CORE.Window.screenMin.width = width;
+    CORE.Window.screenMin.height = height;
+}
+
+// Set window maximum dimensions (FLAG_WINDOW_RESIZABLE)
+void SetWindowMaxSize(int width, int height)
+{
+    CORE.Window.screenMax.width = width;
+    CORE.Window.screenMax.height = height;
+}
+
+// Set window dimensions
+// NOTE: The framebuffer is reallocated, its content is lost
+void SetWindowSize(int width, int height)
+{
+    if ((width <= 0) || (height <= 0)) return;
+
+    unsigned char *pixels = (unsigned char *)RL_REALLOC(platform.pixels, width*height*4);
+
+    if (pixels == NULL)
+    {
+        TRACELOG(LOG_WARNING, "DISPLAY: Failed to resize framebuffer to %i x %i", width, height);
+        return;
+    }
+
+    platform.pixels = pixels;
+    pfSetMainBuffer(platform.pixels, width, height, PF_PIXELFORMAT_R8G8B8A8);
+
+    // Reset viewport and projection matrix for new size
+    SetupViewport(width, height);
+
+    CORE.Window.screen.width = width;
+    CORE.Window.screen.height = height;
+    CORE.Window.render.width = width;
+    CORE.Window.render.height = height;
+    CORE.Window.currentFbo.width = width;
+    CORE.Window.currentFbo.height = height;
+    CORE.Window.resizedLastFrame = true;
+}
+
+// Set window opacity, value opacity is between 0.0 and 1.0
+void SetWindowOpacity(float opacity)
+{
+    TRACELOG(LOG_WARNING, "SetWindowOpacity() not available on target platform");
+}
+
+// Set window focused
+void SetWindowFocused(void)
+{
+    TRACELOG(LOG_WARNING, "SetWindowFocused() not available on target platform");
+}
+
+// Get native window handle
+void *GetWindowHandle(void)
+{
+    TRACELOG(LOG_WARNING, "GetWindowHandle() not implemented on target platform");
+    return NULL;
+}
+
+// Get number of monitors
+int GetMonitorCount(void)
+{
+    return 1;
+}
+
+// Get current monitor index
+int GetCurrentMonitor(void)
+{
+    return 0;
+}
+
+// Get selected monitor position
+GETS(Vector2) GetMonitorPosition(int monitor)
+{
+    return (GETS(Vector2)){ 0, 0 };
+}
+
+// Get selected monitor width (currently used by monitor)
+// NOTE: The framebuffer is the whole "monitor"
+int GetMonitorWidth(int monitor)
+{
+    return CORE.Window.screen.width;
+}
+
+// Get selected monitor height (currently used by monitor)
+int GetMonitorHeight(int monitor)
+{
+    return CORE.Window.screen.height;
+}
+
+// Get selected monitor physical width in millimetres
+int GetMonitorPhysicalWidth(int monitor)
+{
+    TRACELOG(LOG_WARNING, "GetMonitorPhysicalWidth() not implemented on target platform");
+    return 0;
+}
+
+// Get selected monitor physical height in millimetres
+int GetMonitorPhysicalHeight(int monitor)
+{
+    TRACELOG(LOG_WARNING, "GetMonitorPhysicalHeight() not implemented on target platform");
+    return 0;
+}
+
+// Get selected monitor refresh rate
+int GetMonitorRefreshRate(int monitor)
+{
+    TRACELOG(LOG_WARNING, "GetMonitorRefreshRate() not implemented on target platform");
+    return 0;
+}
+
+// Get the human-readable, UTF-8 encoded name of the selected monitor
+const char *GetMonitorName(int monitor)
+{
+    return "headless";
+}
+
+// Get window position XY on monitor
+GETS(Vector2) GetWindowPosition(void)
+{
+    return (GETS(Vector2)){ (float)CORE.Window.position.x, (float)CORE.Window.position.y };
+}
+
+// Get window scale DPI factor for current monitor
+GETS(Vector2) GetWindowScaleDPI(void)
+{
+    return (GETS(Vector2)){ 1.0f, 1.0f };
+}
+
+// Set clipboard text content
+void SetClipboardText(const char *text)
+{
+    TRACELOG(LOG_WARNING, "SetClipboardText() not implemented on target platform");
+}
+
+// Get clipboard text content
+const char *GetClipboardText(void)
+{
+    TRACELOG(LOG_WARNING, "GetClipboardText() not implemented on target platform");
+    return NULL;
+}
+
+// Show mouse cursor
+void ShowCursor(void)
+{
+    CORE.Input.Mouse.cursorHidden = false;
+}
+
+// Hides mouse cursor
+void HideCursor(void)
+{
+    CORE.Input.Mouse.cursorHidden = true;
+}
+
+// Enables cursor (unlock cursor)
+void EnableCursor(void)
+{
+    // Set cursor position in the middle
+    SetMousePosition(CORE.Window.screen.width/2, CORE.Window.screen.height/2);
+
+    CORE.Input.Mouse.cursorHidden = false;
+}
+
+// Disables cursor (lock cursor)
+void DisableCursor(void)
+{
+    // Set cursor position in the middle
+    SetMousePosition(CORE.Window.screen.width/2, CORE.Window.screen.height/2);
+
+    CORE.Input.Mouse.cursorHidden = true;
+}
+
+// Swap back buffer with front buffer (screen drawing)
+// NOTE: There is no screen, the frame just has to be complete in the framebuffer
+void SwapScreenBuffer(void)
+{
+    pfFlush();
+}
+
+// Get the pixels of the last frame, R8G8B8A8, GetScreenWidth()*GetScreenHeight()
+// NOTE: The pointer is valid until the next SetWindowSize() or CloseWindow()
+const unsigned char *GetHeadlessFramebuffer(void)
+{
+    return platform.pixels;
+}
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition: Misc
+//----------------------------------------------------------------------------------
+
+// Get elapsed time measure in seconds since InitTimer()
+double GetTime(void)
+{
+    double time = 0.0;
+    struct timespec ts = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    unsigned long long int nanoSeconds = (unsigned long long int)ts.tv_sec*1000000000LLU + (unsigned long long int)ts.tv_nsec;
+
+    time = (double)(nanoSeconds - CORE.Time.base)*1e-9;  // Elapsed time since InitTimer()
+
+    return time;
+}
+
+// Open URL with default system browser (if available)
+// NOTE: This function is only safe to use if you control the URL given.
+// A user could craft a malicious string performing another action.
+// Only call this function yourself not with user input or make sure to check the string yourself.
+// Ref: https://github.com/raysan5/raylib/issues/686
+void OpenURL(const char *url)
+{
+    TRACELOG(LOG_WARNING, "OpenURL() not available on target platform");
+}
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition: Inputs
+//----------------------------------------------------------------------------------
+
+// Set internal gamepad mappings
+int SetGamepadMappings(const char *mappings)
+{
+    TRACELOG(LOG_WARNING, "SetGamepadMappings() not implemented on target platform");
+    return 0;
+}
+
+// Set mouse position XY
+void SetMousePosition(int x, int y)
+{
+    CORE.Input.Mouse.currentPosition = (GETS(Vector2)){ (float)x, (float)y };
+    CORE.Input.Mouse.previousPosition = CORE.Input.Mouse.currentPosition;
+}
+
+// Set mouse cursor
+void SetMouseCursor(int cursor)
+{
+    CORE.Input.Mouse.cursor = cursor;
+}
+
+// Queue a key event, applied on next PollInputEvents()
+void PushHeadlessKeyEvent(int key, bool down)
+{
+    PushHeadlessEvent(down? HEADLESS_EVENT_KEY_DOWN : HEADLESS_EVENT_KEY_UP, key, (GETS(Vector2)){ 0 });
+}
+
+// Queue a char (unicode codepoint) event, applied on next PollInputEvents()
+void PushHeadlessCharEvent(int codepoint)
+{
+    PushHeadlessEvent(HEADLESS_EVENT_CHAR, codepoint, (GETS(Vector2)){ 0 });
+}
+
+// Queue a mouse button event, applied on next PollInputEvents()
+void PushHeadlessMouseButtonEvent(int button, bool down)
+{
+    PushHeadlessEvent(down? HEADLESS_EVENT_MOUSE_BUTTON_DOWN : HEADLESS_EVENT_MOUSE_BUTTON_UP, button, (GETS(Vector2)){ 0 });
+}
+
+// Queue a mouse move event, applied on next PollInputEvents()
+void PushHeadlessMouseMoveEvent(float x, float y)
+{
+    PushHeadlessEvent(HEADLESS_EVENT_MOUSE_POSITION, 0, (GETS(Vector2)){ x, y });
+}
+
+// Queue a mouse wheel event, applied on next PollInputEvents()
+void PushHeadlessMouseWheelEvent(float x, float y)
+{
+    PushHeadlessEvent(HEADLESS_EVENT_MOUSE_WHEEL, 0, (GETS(Vector2)){ x, y });
+}
+
+// Queue a window close request, applied on next PollInputEvents()
+void PushHeadlessCloseEvent(void)
+{
+    PushHeadlessEvent(HEADLESS_EVENT_CLOSE, 0, (GETS(Vector2)){ 0 });
+}
+
+// Register all input events
+void PollInputEvents(void)
+{
+#if defined(SUPPORT_GESTURES_SYSTEM)
+    // NOTE: Gestures update must be called every frame to reset gestures correctly
+    // because ProcessGestureEvent() is just called on an event, not every frame
+    UpdateGestures();
+#endif
+
+    // Reset keys/chars pressed registered
+    CORE.Input.Keyboard.keyPressedQueueCount = 0;
+    CORE.Input.Keyboard.charPressedQueueCount = 0;
+
+    // Register previous keys states
+    for (int i = 0; i < MAX_KEYBOARD_KEYS; i++)
+    {
+        CORE.Input.Keyboard.previousKeyState[i] = CORE.Input.Keyboard.currentKeyState[i];
+        CORE.Input.Keyboard.keyRepeatInFrame[i] = 0;
+    }
+
+    // Register previous mouse states
+    for (int i = 0; i < MAX_MOUSE_BUTTONS; i++) CORE.Input.Mouse.previousButtonState[i] = CORE.Input.Mouse.currentButtonState[i];
+
+    // Register previous mouse wheel state
+    CORE.Input.Mouse.previousWheelMove = CORE.Input.Mouse.currentWheelMove;
+    CORE.Input.Mouse.currentWheelMove = (GETS(Vector2)){ 0.0f, 0.0f };
+
+    // Register previous mouse position
+    CORE.Input.Mouse.previousPosition = CORE.Input.Mouse.currentPosition;
+
+    // Apply the queued events, in the order they were pushed
+    for (int i = 0; i < platform.eventCount; i++) ProcessHeadlessEvent(&platform.events[i]);
+    platform.eventCount = 0;
+
+    // Map mouse position to touch position for convenience
+    CORE.Input.Touch.position[0] = CORE.Input.Mouse.currentPosition;
+}
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------
+
+// Initialize platform: graphics, inputs and more
+int InitPlatform(void)
+{
+    int width = CORE.Window.screen.width;
+    int height = CORE.Window.screen.height;
+
+    // Initialize graphic device: a PixelForge context rendering into system memory
+    //----------------------------------------------------------------------------
+    platform.pixels = (unsigned char *)RL_CALLOC(width*height*4, 1);
+    if (platform.pixels == NULL)
+    {
+        TRACELOG(LOG_FATAL, "PLATFORM: Failed to allocate framebuffer");
+        return -1;
+    }
+
+    platform.context = pfCreateContext(platform.pixels, width, height, PF_PIXELFORMAT_R8G8B8A8);
+    if (platform.context == NULL)
+    {
+        RL_FREE(platform.pixels);
+        platform.pixels = NULL;
+
+        TRACELOG(LOG_FATAL, "PLATFORM: Failed to initialize graphics device");
+        return -1;
+    }
+
+    pfMakeCurrent(platform.context);
+
+    CORE.Window.fullscreen = false;
+    CORE.Window.ready = true;
+
+    CORE.Window.display.width = width;
+    CORE.Window.display.height = height;
+    CORE.Window.render.width = width;
+    CORE.Window.render.height = height;
+    CORE.Window.currentFbo.width = width;
+    CORE.Window.currentFbo.height = height;
+
+    TRACELOG(LOG_INFO, "DISPLAY: Device initialized successfully");
+    TRACELOG(LOG_INFO, "    > Display size: %i x %i", CORE.Window.display.width, CORE.Window.display.height);
+    TRACELOG(LOG_INFO, "    > Screen size:  %i x %i", CORE.Window.screen.width, CORE.Window.screen.height);
+    TRACELOG(LOG_INFO, "    > Render size:  %i x %i", CORE.Window.render.width, CORE.Window.render.height);
+    //----------------------------------------------------------------------------
+
+    // Initialize input events system: events are pushed by the application
+    //----------------------------------------------------------------------------
+    platform.eventCount = 0;
+
+    CORE.Input.Mouse.offset = (GETS(Vector2)){ 0.0f, 0.0f };
+    CORE.Input.Mouse.scale = (GETS(Vector2)){ 1.0f, 1.0f };
+    //----------------------------------------------------------------------------
+
+    // Initialize timing system
+    //----------------------------------------------------------------------------
+    InitTimer();
+    //----------------------------------------------------------------------------
+
+    // Initialize storage system
+    //----------------------------------------------------------------------------
+    CORE.Storage.basePath = GetWorkingDirectory();
+    //----------------------------------------------------------------------------
+
+    TRACELOG(LOG_INFO, "PLATFORM: HEADLESS: Initialized successfully");
+
+    return 0;
+}
+
+// Close platform
+void ClosePlatform(void)
+{
+    if (platform.context != NULL) pfDeleteContext(platform.context);
+    platform.context = NULL;
+
+    RL_FREE(platform.pixels);
+    platform.pixels = NULL;
+}
+
+// Queue an input event
+static void PushHeadlessEvent(HeadlessEventType type, int param, GETS(Vector2) value)
+{
+    if (platform.eventCount >= MAX_HEADLESS_EVENTS)
+    {
+        TRACELOG(LOG_WARNING, "INPUT: Headless event queue is full, event discarded");
+        return;
+    }
+
+    platform.events[platform.eventCount++] = (HeadlessEvent){ type, param, value };
+}
+
+// Apply an input event to CORE.Input
+// NOTE: Same effects as the GLFW callbacks of PLATFORM_DESKTOP
+static void ProcessHeadlessEvent(const HeadlessEvent *event)
+{
+    switch (event->type)
+    {
+        case HEADLESS_EVENT_KEY_UP:
+        case HEADLESS_EVENT_KEY_DOWN:
+        {
+            int key = event->param;
+            if ((key <= 0) || (key >= MAX_KEYBOARD_KEYS)) break;
+
+            CORE.Input.Keyboard.currentKeyState[key] = (event->type == HEADLESS_EVENT_KEY_DOWN);
+
+            if (event->type == HEADLESS_EVENT_KEY_DOWN)
+            {
+                // Check if there is space available in the key queue
+                if (CORE.Input.Keyboard.keyPressedQueueCount < MAX_KEY_PRESSED_QUEUE)
+                {
+                    CORE.Input.Keyboard.keyPressedQueue[CORE.Input.Keyboard.keyPressedQueueCount] = key;
+                    CORE.Input.Keyboard.keyPressedQueueCount++;
+                }
+
+                // Check the exit key to set close window
+                if (key == CORE.Input.Keyboard.exitKey) CORE.Window.shouldClose = true;
+            }
+        } break;
+        case HEADLESS_EVENT_CHAR:
+        {
+            // Check if there is space available in the queue
+            if (CORE.Input.Keyboard.charPressedQueueCount < MAX_CHAR_PRESSED_QUEUE)
+            {
+                CORE.Input.Keyboard.charPressedQueue[CORE.Input.Keyboard.charPressedQueueCount] = event->param;
+                CORE.Input.Keyboard.charPressedQueueCount++;
+            }
+        } break;
+        case HEADLESS_EVENT_MOUSE_BUTTON_UP:
+        case HEADLESS_EVENT_MOUSE_BUTTON_DOWN:
+        {
+            int button = event->param;
+            if ((button < 0) || (button >= MAX_MOUSE_BUTTONS)) break;
+
+            CORE.Input.Mouse.currentButtonState[button] = (event->type == HEADLESS_EVENT_MOUSE_BUTTON_DOWN);
+            CORE.Input.Touch.currentTouchState[button] = CORE.Input.Mouse.currentButtonState[button];
+        } break;
+        case HEADLESS_EVENT_MOUSE_POSITION: CORE.Input.Mouse.currentPosition = event->value; break;
+        case HEADLESS_EVENT_MOUSE_WHEEL: CORE.Input.Mouse.currentWheelMove = event->value; break;
+        case HEADLESS_EVENT_CLOSE: CORE.Window.shouldClose = true; break;
+        default: break;
+    }
+}
+
+// EOF
@@ -190,9 +190,14 @@ static inline GETS(Color) RAYWHITE   = { 245, 245, 245, 255 }   ; // My own Whit
 // Structures Definition
 //----------------------------------------------------------------------------------
 // Boolean type
+// NOTE: Same choice as rlgl.h and pixelforge.h, which include <stdbool.h> on C99 compilers
+#if (defined(__STDC__) && __STDC_VERSION__ >= 199901L) || (defined(_MSC_VER) && _MSC_VER >= 1800)
+#include <stdbool.h>
+#else
 #define true 1
 #define false 0
 #define bool short
+#endif
 
 // GETS(Vector2), 2 components
 MKSTRUCT(Vector2, {
@@ -1140,6 +1145,17 @@ RLAPI void StartAutomationEventRecording(void);
 RLAPI void StopAutomationEventRecording(void);                                          // Stop recording automation events
 RLAPI void PlayAutomationEvent(GETS(AutomationEvent) event);                                  // Play a recorded automation event
 
+#if defined(PLATFORM_HEADLESS)
+// Headless platform functionality
+RLAPI const unsigned char *GetHeadlessFramebuffer(void);                                // Get pixels of the last frame (R8G8B8A8, screen size)
+RLAPI void PushHeadlessKeyEvent(int key, bool down);                                    // Queue a key event, applied on next PollInputEvents()
+RLAPI void PushHeadlessCharEvent(int codepoint);                                        // Queue a char (unicode codepoint) event
+RLAPI void PushHeadlessMouseButtonEvent(int button, bool down);                         // Queue a mouse button event
+RLAPI void PushHeadlessMouseMoveEvent(float x, float y);                                // Queue a mouse move event
+RLAPI void PushHeadlessMouseWheelEvent(float x, float y);                               // Queue a mouse wheel event
+RLAPI void PushHeadlessCloseEvent(void);                                                // Queue a window close request
+#endif
+
 //------------------------------------------------------------------------------------
 // Input Handling Functions (Module: core)
 //------------------------------------------------------------------------------------
@@ -19,6 +19,8 @@
 *           - Linux DRM subsystem (KMS mode)
 *       > PLATFORM_ANDROID:
 *           - Android (ARM, ARM64)
+*       > PLATFORM_HEADLESS (PixelForge backend):
+*           - Linux and other POSIX systems, offscreen rendering (no display)
 *
 *   CONFIGURATION:
 *       #define SUPPORT_DEFAULT_FONT (default)
@@ -512,6 +514,8 @@ const char *TextFormat(const char *text, ...);              // Formatting of tex
     #include "platforms/rcore_android.c"
 #elif defined(PLATFORM_9)
     #include "platforms/rcore_9.c"
+#elif defined(PLATFORM_HEADLESS)
+    #include "platforms/rcore_headless.c"
 #else
     // TODO: Include your custom platform backend!
     // i.e software rendering backend or console backend!
@@ -583,6 +587,8 @@ void InitWindow(int width, int height, const char *title)
     tracelog(log_info, "platform backend: android");
 #elif defined(PLATFORM_9)
     TRACELOG(LOG_INFO, "platform backend: plan9");
+#elif defined(PLATFORM_HEADLESS)
+    TRACELOG(LOG_INFO, "Platform backend: HEADLESS (PixelForge)");
 #else
     // TODO: Include your custom platform backend!
     // i.e software rendering backend or console backend!
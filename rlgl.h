@@ -58,6 +58,8 @@
 *       #define RL_MAX_SHADER_LOCATIONS              32    // Maximum number of shader locations supported
 *       #define RL_CULL_DISTANCE_NEAR              0.01    // Default projection matrix near cull distance
 *       #define RL_CULL_DISTANCE_FAR             1000.0    // Default projection matrix far cull distance
+*       #define RL_TEXTURE_TILED_MIN_SIZE            64    // Minimum width and height of the textures stored in tiles by PixelForge (0 to disable)
+*       #define RL_PREMULTIPLIED_ALPHA                0    // Premultiply textures and colors by their alpha, blended with pfBlendPremultiplied() (1 to enable)
 *
 *       When loading a shader, the following vertex attributes and uniform
 *       location names are tried to be set automatically:
@@ -250,6 +252,21 @@
 #define RL_CULL_DISTANCE_FAR                1000.0      // Default far cull distance
 #endif
 
+// Texture memory layout (OpenGL 1.1, PixelForge)
+// NOTE: Rotated or perspective-mapped textures are sampled across rows, which stay in the
+// cache when the texels are stored in tiles, small textures fit in the cache anyway
+#ifndef RL_TEXTURE_TILED_MIN_SIZE
+#define RL_TEXTURE_TILED_MIN_SIZE               64      // Minimum width and height of the tiled textures (0 to disable)
+#endif
+
+// Alpha mode (OpenGL 1.1, PixelForge)
+// NOTE: Premultiplied textures and colors are blended with one multiplication less per channel,
+// bilinear filtering and mipmaps don't bleed the color of the transparent texels, and the tint
+// color is premultiplied too, so that RL_BLEND_ALPHA keeps giving the expected results
+#ifndef RL_PREMULTIPLIED_ALPHA
+#define RL_PREMULTIPLIED_ALPHA                  0       // Premultiply textures and colors by their alpha (1 to enable)
+#endif
+
 // Texture parameters (equivalent to OpenGL defines)
 #define RL_TEXTURE_WRAP_S                       0x2802      // PF_TEXTURE_WRAP_S
 #define RL_TEXTURE_WRAP_T                       0x2803      // PF_TEXTURE_WRAP_T
@@ -1097,15 +1114,33 @@ typedef void *(*rlglLoadProc)(const char *name);   // OpenGL extension functions
 
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
+#if defined(GRAPHICS_API_OPENGL_11)
+// NOTE: Vertex data is recorded in the render batch and submitted to PixelForge
+// with vertex arrays, one pfDrawArrays() per draw call, when the batch is drawn
+typedef struct rlglData {
+  rlRenderBatch *currentBatch;            // Current render batch
+  rlRenderBatch defaultBatch;             // Default internal render batch
+
+  struct {
+    int vertexCounter;                  // Current active render batch vertex counter (generic, used for all batches)
+    float texcoordx, texcoordy;         // Current active texture coordinate (added on rlVertex*())
+    float normalx, normaly, normalz;    // Current active normal (added on rlVertex*())
+    unsigned char colorr, colorg, colorb, colora;   // Current active color (added on rlVertex*())
+
+    unsigned int currentTextureId;      // Current texture id, recorded with the draws (0 for no texture)
+  } State;            // Renderer state
+} rlglData;
+#endif  // GRAPHICS_API_OPENGL_11
+
 //----------------------------------------------------------------------------------
 // pfobal Variables Definition
 //----------------------------------------------------------------------------------
 static double rlCullDistanceNear = RL_CULL_DISTANCE_NEAR;
 static double rlCullDistanceFar = RL_CULL_DISTANCE_FAR;
 
-#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+#if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
 static rlglData RLGL = { 0 };
-#endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
+#endif  // GRAPHICS_API_OPENGL_11 || GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
 #if defined(GRAPHICS_API_OPENGL_ES2) && !defined(GRAPHICS_API_OPENGL_ES3)
 // NOTE: VAO functionality is exposed through extensions (OES)
@@ -1130,6 +1165,11 @@ static const char *rlGetCompressedFormatName(int format); // Get compressed form
 #endif  // RLGL_SHOW_PF_DETAILS_INFO
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
+#if defined(GRAPHICS_API_OPENGL_11)
+static void rlSetDrawCall(int mode, unsigned int textureId);   // Start a new draw call if mode or texture changes
+static void rlPremultiplyAlpha(void *data, int count, int format);   // Multiply the color of the pixels by their alpha (RL_PREMULTIPLIED_ALPHA)
+#endif
+
 static int rlGetPixelDataSize(int width, int height, int format);   // Get pixel data size in bytes (image or texture)
 
 // Auxiliar matrix math functions
@@ -1150,6 +1190,8 @@ static GETS(Matrix) rlMatrixInvert(GETS(Matrix) mat);                   // Inver
 #if defined(GRAPHICS_API_OPENGL_11)
 // Fallback to OpenGL 1.1 function calls
 //---------------------------------------
+// NOTE: The recorded vertices are transformed when the batch is drawn,
+// so it is drawn before the current matrix changes
 void
 rlMatrixMode(int mode)
 {
@@ -1171,12 +1213,14 @@ rlMatrixMode(int mode)
 void
 rlFrustum(double left, double right, double bottom, double top, double znear, double zfar)
 {
+  rlDrawRenderBatchActive();
   pfFrustum(left, right, bottom, top, znear, zfar);
 }
 
 void
 rlOrtho(double left, double right, double bottom, double top, double znear, double zfar)
 {
+  rlDrawRenderBatchActive();
   pfOrtho(left, right, bottom, top, znear, zfar);
 }
 
@@ -1188,31 +1232,37 @@ rlPushMatrix(void)
 void
 rlPopMatrix(void)
 {
+  rlDrawRenderBatchActive();
   pfPopMatrix();
 }
 void
 rlLoadIdentity(void)
 {
+  rlDrawRenderBatchActive();
   pfLoadIdentity();
 }
 void
 rlTranslatef(float x, float y, float z)
 {
+  rlDrawRenderBatchActive();
   pfTranslatef(x, y, z);
 }
 void
 rlRotatef(float angle, float x, float y, float z)
 {
+  rlDrawRenderBatchActive();
   pfRotatef(angle, x, y, z);
 }
 void
 rlScalef(float x, float y, float z)
 {
+  rlDrawRenderBatchActive();
   pfScalef(x, y, z);
 }
 void
 rlMultMatrixf(const float *matf)
 {
+  rlDrawRenderBatchActive();
   pfMultMatrixf(matf);
 }
 #endif
@@ -1426,6 +1476,7 @@ rlOrtho(double left, double right, double bottom, double top, double znear, doub
 void
 rlViewport(int x, int y, int width, int height)
 {
+  rlDrawRenderBatchActive();
   pfViewport(x, y, width, height);
 }
 
@@ -1455,70 +1506,145 @@ rlGetCullDistanceFar(void)
 // Module Functions Definition - Vertex level operations
 //----------------------------------------------------------------------------------
 #if defined(GRAPHICS_API_OPENGL_11)
-// Fallback to OpenGL 1.1 function calls
+// Vertex data is recorded in the default render batch, as for OpenGL 3.3+
 //---------------------------------------
+// Initialize drawing mode (how to organize vertex)
 void
 rlBegin(int mode)
 {
-  switch (mode) {
-  case RL_LINES:
-    pfBegin(PF_LINES);
-    break;
-  case RL_TRIANGLES:
-    pfBegin(PF_TRIANGLES);
-    break;
-  case RL_QUADS:
-    pfBegin(PF_QUADS);
-    break;
-  default:
-    break;
-  }
+  rlSetDrawCall(mode, RLGL.State.currentTextureId);
 }
 
+// Finish vertex providing
 void
-rlEnd()
+rlEnd(void)
 {
-  pfEnd();
+  // NOTE: Primitives are only sent to PixelForge when the batch is drawn
 }
+
+// Define one vertex (position)
 void
-rlVertex2i(int x, int y)
+rlVertex3f(float x, float y, float z)
 {
-  pfVertex2i(x, y);
+  rlVertexBuffer *buffer = &RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer];
+  rlDrawCall *draw = &RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1];
+
+  // WARNING: We can't break primitives when launching a new batch, see OpenGL 3.3+ rlVertex3f()
+  if (RLGL.State.vertexCounter > (buffer->elementCount*4 - 4)) {
+    if ((draw->mode == RL_LINES) && (draw->vertexCount%2 == 0)) rlCheckRenderBatchLimit(2 + 1);
+    else if ((draw->mode == RL_TRIANGLES) && (draw->vertexCount%3 == 0)) rlCheckRenderBatchLimit(3 + 1);
+    else if ((draw->mode == RL_QUADS) && (draw->vertexCount%4 == 0)) rlCheckRenderBatchLimit(4 + 1);
+
+    draw = &RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1];
+  }
+
+  int i = RLGL.State.vertexCounter;
+
+  buffer->vertices[3*i] = x;
+  buffer->vertices[3*i + 1] = y;
+  buffer->vertices[3*i + 2] = z;
+
+  buffer->texcoords[2*i] = RLGL.State.texcoordx;
+  buffer->texcoords[2*i + 1] = RLGL.State.texcoordy;
+
+  buffer->normals[3*i] = RLGL.State.normalx;
+  buffer->normals[3*i + 1] = RLGL.State.normaly;
+  buffer->normals[3*i + 2] = RLGL.State.normalz;
+
+  buffer->colors[4*i] = RLGL.State.colorr;
+  buffer->colors[4*i + 1] = RLGL.State.colorg;
+  buffer->colors[4*i + 2] = RLGL.State.colorb;
+  buffer->colors[4*i + 3] = RLGL.State.colora;
+
+  RLGL.State.vertexCounter++;
+  draw->vertexCount++;
 }
+
+// Define one vertex (position)
+// NOTE: 2D vertices are kept on z = 0, like pfVertex2f()
 void
 rlVertex2f(float x, float y)
 {
-  pfVertex2f(x, y);
+  rlVertex3f(x, y, 0.0f);
 }
+
+// Define one vertex (position)
 void
-rlVertex3f(float x, float y, float z)
+rlVertex2i(int x, int y)
 {
-  pfVertex3f(x, y, z);
+  rlVertex3f((float)x, (float)y, 0.0f);
 }
+
+// Define one vertex (texture coordinate)
 void
 rlTexCoord2f(float x, float y)
 {
-  pfTexCoord2f(x, y);
+  RLGL.State.texcoordx = x;
+  RLGL.State.texcoordy = y;
 }
+
+// Define one vertex (normal)
+// NOTE: Normals are transformed by PixelForge with the modelview matrix
 void
 rlNormal3f(float x, float y, float z)
 {
-  pfNormal3f(x, y, z);
+  RLGL.State.normalx = x;
+  RLGL.State.normaly = y;
+  RLGL.State.normalz = z;
 }
+
+// Define one vertex (color)
+// NOTE: With RL_PREMULTIPLIED_ALPHA the color is premultiplied like the textures it tints
 void
 rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
 {
-  pfColor4ub(r, g, b, a);
+  if (RL_PREMULTIPLIED_ALPHA && (a < 255)) {
+    r = (r*a + 127)/255;
+    g = (g*a + 127)/255;
+    b = (b*a + 127)/255;
+  }
+
+  RLGL.State.colorr = r;
+  RLGL.State.colorg = g;
+  RLGL.State.colorb = b;
+  RLGL.State.colora = a;
 }
+
+// Define one vertex (color)
 void
 rlColor3f(float x, float y, float z)
 {
-  pfColor3f(x, y, z);
+  rlColor4ub((unsigned char)(x*255), (unsigned char)(y*255), (unsigned char)(z*255), 255);
 }
+
+// Define one vertex (color)
 void
 rlColor4f(float x, float y, float z, float w)
 {
-  pfColor4f(x, y, z, w);
+  rlColor4ub((unsigned char)(x*255), (unsigned char)(y*255), (unsigned char)(z*255), (unsigned char)(w*255));
+}
+
+// Start a new draw call if the drawing mode or the texture changes
+static void
+rlSetDrawCall(int mode, unsigned int textureId)
+{
+  rlDrawCall *draw = &RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1];
+
+  if ((draw->mode == mode) && (draw->textureId == textureId)) return;
+
+  // NOTE: Draws are submitted with pfDrawArrays() from their first vertex,
+  // no vertex alignment is required between them
+  if (draw->vertexCount > 0) {
+    if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS) rlDrawRenderBatch(RLGL.currentBatch);
+    else RLGL.currentBatch->drawCounter++;
+
+    draw = &RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1];
+  }
+
+  draw->mode = mode;
+  draw->vertexCount = 0;
+  draw->vertexAlignment = 0;
+  draw->textureId = textureId;
 }
 #endif
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
@@ -1704,20 +1830,18 @@ rlColor3f(float x, float y, float z)
 void
 rlSetTexture(unsigned int id)
 {
-  if (id == 0) {
 #if defined(GRAPHICS_API_OPENGL_11)
-    rlDisableTexture();
+  // NOTE: The texture is bound when the batch is drawn, the following vertices go to a draw using it
+  RLGL.State.currentTextureId = id;
+  rlSetDrawCall(RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].mode, id);
 #else
+  if (id == 0) {
     // NOTE: If quads batch limit is reached, we force a draw call and next batch starts
     if (RLGL.State.vertexCounter >=
         RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].elementCount*4) {
       rlDrawRenderBatch(RLGL.currentBatch);
     }
-#endif
   } else {
-#if defined(GRAPHICS_API_OPENGL_11)
-    rlEnableTexture(id);
-#else
     if (RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].textureId != id) {
       if (RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount > 0) {
         // Make sure current RLGL.currentBatch->draws[i].vertexCount is aligned a multiple of 4,
@@ -1741,8 +1865,8 @@ rlSetTexture(unsigned int id)
       RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].textureId = id;
       RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount = 0;
     }
-#endif
   }
+#endif
 }
 
 // Select and active a texture slot
@@ -1758,6 +1882,10 @@ rlActiveTextureSlot(int slot)
 void
 rlEnableTexture(unsigned int id)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  rlDrawRenderBatchActive();
+  RLGL.State.currentTextureId = id;
+#endif
   pfEnable(PF_TEXTURE_2D);
   pfBindTexture(pfGetTexture(id));
 }
@@ -1766,6 +1894,10 @@ rlEnableTexture(unsigned int id)
 void
 rlDisableTexture(void)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  rlDrawRenderBatchActive();
+  RLGL.State.currentTextureId = 0;
+#endif
   pfBindTexture(NULL);
   pfDisable(PF_TEXTURE_2D);
 }
@@ -1792,6 +1924,55 @@ rlDisableTextureCubemap(void)
 void
 rlTextureParameters(unsigned int id, int param, int value)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  PFtexture *texture = pfGetTexture(id);
+  if (texture == NULL) return;
+
+  // NOTE: The batched and binned draws must be done with the previous parameters
+  rlDrawRenderBatchActive();
+  pfFlush();
+
+  PFtexturefilter filter = PF_FILTER_NEAREST;
+  PFtexturewrap wrap = PF_WRAP_REPEAT;
+
+  switch (value) {
+  case RL_TEXTURE_FILTER_LINEAR: filter = PF_FILTER_LINEAR; break;
+  case RL_TEXTURE_FILTER_MIP_NEAREST: filter = PF_FILTER_NEAREST_MIPMAP_NEAREST; break;
+  case RL_TEXTURE_FILTER_LINEAR_MIP_NEAREST: filter = PF_FILTER_LINEAR_MIPMAP_NEAREST; break;
+  case RL_TEXTURE_FILTER_NEAREST_MIP_LINEAR: filter = PF_FILTER_NEAREST_MIPMAP_LINEAR; break;
+  case RL_TEXTURE_FILTER_MIP_LINEAR: filter = PF_FILTER_LINEAR_MIPMAP_LINEAR; break;
+  default: break;
+  }
+
+  switch (value) {
+  case RL_TEXTURE_WRAP_CLAMP: wrap = PF_WRAP_CLAMP_TO_EDGE; break;
+  case RL_TEXTURE_WRAP_MIRROR_REPEAT: wrap = PF_WRAP_MIRRORED_REPEAT; break;
+  case RL_TEXTURE_WRAP_MIRROR_CLAMP:
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Clamp mirror wrap mode not supported, clamp to edge is used", id);
+    wrap = PF_WRAP_CLAMP_TO_EDGE;
+    break;
+  default: break;
+  }
+
+  switch (param) {
+  case RL_TEXTURE_WRAP_S: pfSetTextureWrap(texture, wrap, texture->wrapT); break;
+  case RL_TEXTURE_WRAP_T: pfSetTextureWrap(texture, texture->wrapS, wrap); break;
+  case RL_TEXTURE_MIN_FILTER: pfSetTextureFilter(texture, filter, texture->magFilter); break;
+  case RL_TEXTURE_MAG_FILTER:
+    // NOTE: Only the nearest and linear filters magnify a texture
+    if (filter != PF_FILTER_NEAREST) filter = PF_FILTER_LINEAR;
+    pfSetTextureFilter(texture, texture->minFilter, filter);
+    break;
+  case RL_TEXTURE_FILTER_ANISOTROPIC:
+    // NOTE: Approximated with trilinear filtering
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Anisotropic filtering not supported, trilinear filtering is used", id);
+    pfSetTextureFilter(texture, (texture->mipmaps > 1) ? PF_FILTER_LINEAR_MIPMAP_LINEAR : PF_FILTER_LINEAR, PF_FILTER_LINEAR);
+    break;
+  default:
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Texture parameter (%i) not supported", id, param);
+    break;
+  }
+#else
   pfBindTexture(pfGetTexture(id));
 
 #if !defined(GRAPHICS_API_OPENGL_11)
@@ -1834,6 +2015,7 @@ rlTextureParameters(unsigned int id, int param, int value)
   }
 
   pfBindTexture(NULL);
+#endif
 }
 
 // Set cubemap parameters (wrap mode/filter mode)
@@ -1994,11 +2176,14 @@ rlActiveDrawBuffers(int count)
 //----------------------------------------------------------------------------------
 // General render state configuration
 //----------------------------------------------------------------------------------
+// NOTE: The render batch is drawn before any state change, so the recorded
+// vertices are rasterized with the state they were defined with
 
 // Enable color blending
 void
 rlEnableColorBlend(void)
 {
+  rlDrawRenderBatchActive();
   pfEnable(PF_BLEND);
 }
 
@@ -2006,6 +2191,7 @@ rlEnableColorBlend(void)
 void
 rlDisableColorBlend(void)
 {
+  rlDrawRenderBatchActive();
   pfDisable(PF_BLEND);
 }
 
@@ -2013,6 +2199,7 @@ rlDisableColorBlend(void)
 void
 rlEnableDepthTest(void)
 {
+  rlDrawRenderBatchActive();
   pfEnable(PF_DEPTH_TEST);
 }
 
@@ -2020,6 +2207,7 @@ rlEnableDepthTest(void)
 void
 rlDisableDepthTest(void)
 {
+  rlDrawRenderBatchActive();
   pfDisable(PF_DEPTH_TEST);
 }
 
@@ -2027,6 +2215,7 @@ rlDisableDepthTest(void)
 void
 rlEnableDepthMask(void)
 {
+  rlDrawRenderBatchActive();
   _pfDepthMask(PF_TRUE);
 }
 
@@ -2034,6 +2223,7 @@ rlEnableDepthMask(void)
 void
 rlDisableDepthMask(void)
 {
+  rlDrawRenderBatchActive();
   _pfDepthMask(PF_FALSE);
 }
 
@@ -2041,6 +2231,7 @@ rlDisableDepthMask(void)
 void
 rlEnableBackfaceCulling(void)
 {
+  rlDrawRenderBatchActive();
   pfEnable(PF_CULL_FACE);
 }
 
@@ -2048,6 +2239,7 @@ rlEnableBackfaceCulling(void)
 void
 rlDisableBackfaceCulling(void)
 {
+  rlDrawRenderBatchActive();
   pfDisable(PF_CULL_FACE);
 }
 
@@ -2055,6 +2247,7 @@ rlDisableBackfaceCulling(void)
 void
 rlColorMask(bool r, bool g, bool b, bool a)
 {
+  rlDrawRenderBatchActive();
   _pfColorMask(r, g, b, a);
 }
 
@@ -2062,6 +2255,7 @@ rlColorMask(bool r, bool g, bool b, bool a)
 void
 rlSetCullFace(int mode)
 {
+  rlDrawRenderBatchActive();
   switch (mode) {
   case RL_CULL_FACE_BACK:
     pfCullFace(PF_BACK);
@@ -2078,6 +2272,7 @@ rlSetCullFace(int mode)
 void
 rlEnableScissorTest(void)
 {
+  rlDrawRenderBatchActive();
   pfEnable(PF_SCISSOR_TEST);
 }
 
@@ -2085,6 +2280,7 @@ rlEnableScissorTest(void)
 void
 rlDisableScissorTest(void)
 {
+  rlDrawRenderBatchActive();
   pfDisable(PF_SCISSOR_TEST);
 }
 
@@ -2092,6 +2288,7 @@ rlDisableScissorTest(void)
 void
 rlScissor(int x, int y, int width, int height)
 {
+  rlDrawRenderBatchActive();
   _pfScissor(x, y, width, height);
 }
 
@@ -2099,6 +2296,7 @@ rlScissor(int x, int y, int width, int height)
 void
 rlEnableWireMode(void)
 {
+  rlDrawRenderBatchActive();
 #if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33)
   // NOTE: pfPolygonMode() not available on OpenGL ES
   pfPolygonMode(PF_FRONT_AND_BACK, PF_LINE);
@@ -2108,6 +2306,7 @@ rlEnableWireMode(void)
 void
 rlEnablePointMode(void)
 {
+  rlDrawRenderBatchActive();
 #if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33)
   // NOTE: pfPolygonMode() not available on OpenGL ES
   pfPolygonMode(PF_FRONT_AND_BACK, PF_POINT);
@@ -2118,6 +2317,7 @@ rlEnablePointMode(void)
 void
 rlDisableWireMode(void)
 {
+  rlDrawRenderBatchActive();
 #if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33)
   // NOTE: pfPolygonMode() not available on OpenGL ES
   pfPolygonMode(PF_FRONT_AND_BACK, PF_FILL);
@@ -2128,6 +2328,7 @@ rlDisableWireMode(void)
 void
 rlSetLineWidth(float width)
 {
+  rlDrawRenderBatchActive();
   pfLineWidth(width);
 }
 
@@ -2144,6 +2345,7 @@ rlGetLineWidth(void)
 void
 rlEnableSmoothLines(void)
 {
+  rlDrawRenderBatchActive();
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_11)
   pfEnable(PF_LINE_SMOOTH);
 #endif
@@ -2153,6 +2355,7 @@ rlEnableSmoothLines(void)
 void
 rlDisableSmoothLines(void)
 {
+  rlDrawRenderBatchActive();
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_11)
   pfDisable(PF_LINE_SMOOTH);
 #endif
@@ -2197,6 +2400,11 @@ rlClearColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
   float cb = (float)b/255;
   float ca = (float)a/255;
 
+#if defined(GRAPHICS_API_OPENGL_11)
+  // NOTE: The framebuffer holds premultiplied colors with RL_PREMULTIPLIED_ALPHA
+  if (RL_PREMULTIPLIED_ALPHA) cr *= ca, cg *= ca, cb *= ca;
+#endif
+
   pfClearColor(cr, cg, cb, ca);
 }
 
@@ -2204,6 +2412,7 @@ rlClearColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
 void
 rlClearScreenBuffers(void)
 {
+  rlDrawRenderBatchActive();
   pfClear(PF_COLOR_BUFFER_BIT | PF_DEPTH_BUFFER_BIT);     // Clear used buffers: Color and Depth (Depth is used for 3D)
   //pfClear(PF_COLOR_BUFFER_BIT | PF_DEPTH_BUFFER_BIT | PF_STENCIL_BUFFER_BIT);     // Stencil buffer not used...
 }
@@ -2253,9 +2462,10 @@ rlCheckErrors(void)
 void
 rlSetBlendMode(int mode)
 {
+  rlDrawRenderBatchActive();
   switch (mode) {
   case RL_BLEND_ALPHA:
-    pfBlendFunc(pfBlendAlpha);
+    pfBlendFunc(RL_PREMULTIPLIED_ALPHA ? pfBlendPremultiplied : pfBlendAlpha);
     break;
   case RL_BLEND_ADDITIVE:
     pfBlendFunc(pfBlendAdditive);
@@ -2266,6 +2476,9 @@ rlSetBlendMode(int mode)
   case RL_BLEND_MULTIPLIED:
     pfBlendFunc(pfBlendMultiplicative);
     break;
+  case RL_BLEND_ALPHA_PREMULTIPLY:
+    pfBlendFunc(pfBlendPremultiplied);
+    break;
   default:
     pfBlendFunc(pfBlend);
     break;
@@ -2464,6 +2677,18 @@ rlglInit(int width, int height)
   RLGL.State.currentMatrix = &RLGL.State.modelview;
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
+#if defined(GRAPHICS_API_OPENGL_11)
+  // Init default vertex arrays buffers, drawn with PixelForge vertex arrays
+  RLGL.defaultBatch = rlLoadRenderBatch(RL_DEFAULT_BATCH_BUFFERS, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+  RLGL.currentBatch = &RLGL.defaultBatch;
+
+  // Init current vertex color (white, as PixelForge default)
+  rlColor4ub(255, 255, 255, 255);
+
+  // Init blending of the premultiplied textures and colors (see rlLoadTexture())
+  if (RL_PREMULTIPLIED_ALPHA) pfBlendFunc(pfBlendPremultiplied);
+#endif
+
   // Initialize OpenGL default states
   //----------------------------------------------------------
   // Init state: Depth test
@@ -2493,6 +2718,9 @@ rlglInit(int width, int height)
 void
 rlglClose(void)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  rlUnloadRenderBatch(RLGL.defaultBatch);
+#endif
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   rlUnloadRenderBatch(RLGL.defaultBatch);
 
@@ -2871,6 +3099,37 @@ rlLoadRenderBatch(int numBuffers, int bufferElements)
 {
   rlRenderBatch batch = { 0 };
 
+#if defined(GRAPHICS_API_OPENGL_11)
+  // Initialize CPU (RAM) vertex buffers (position, texcoord, normal and color data)
+  // NOTE: PixelForge reads them directly with vertex arrays, no indices or GPU buffers are required
+  //--------------------------------------------------------------------------------------------
+  batch.vertexBuffer = (rlVertexBuffer *)RL_CALLOC(numBuffers, sizeof(rlVertexBuffer));
+
+  for (int i = 0; i < numBuffers; i++) {
+    batch.vertexBuffer[i].elementCount = bufferElements;
+
+    batch.vertexBuffer[i].vertices = (float *)RL_CALLOC(bufferElements*3*4, sizeof(float));        // 3 float by vertex, 4 vertex by quad
+    batch.vertexBuffer[i].texcoords = (float *)RL_CALLOC(bufferElements*2*4, sizeof(float));       // 2 float by texcoord, 4 texcoord by quad
+    batch.vertexBuffer[i].normals = (float *)RL_CALLOC(bufferElements*3*4, sizeof(float));         // 3 float by vertex, 4 vertex by quad
+    batch.vertexBuffer[i].colors = (unsigned char *)RL_CALLOC(bufferElements*4*4, sizeof(unsigned char));   // 4 bytes by color, 4 colors by quad
+  }
+
+  RLGL.State.vertexCounter = 0;
+
+  TRACELOG(RL_LOG_INFO, "RLGL: Render batch vertex buffers loaded successfully in RAM (CPU)");
+  //--------------------------------------------------------------------------------------------
+
+  // Init draw calls tracking system
+  //--------------------------------------------------------------------------------------------
+  batch.draws = (rlDrawCall *)RL_CALLOC(RL_DEFAULT_BATCH_DRAWCALLS, sizeof(rlDrawCall));
+
+  for (int i = 0; i < RL_DEFAULT_BATCH_DRAWCALLS; i++) batch.draws[i].mode = RL_QUADS;
+
+  batch.bufferCount = numBuffers;    // Record buffer count
+  batch.drawCounter = 1;             // Reset draws counter
+  batch.currentDepth = -1.0f;        // Reset depth value
+  //--------------------------------------------------------------------------------------------
+#endif
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   // Initialize CPU (RAM) vertex buffers (position, texcoord, color data and indexes)
   //--------------------------------------------------------------------------------------------
@@ -2998,6 +3257,19 @@ rlLoadRenderBatch(int numBuffers, int bufferElements)
 void
 rlUnloadRenderBatch(rlRenderBatch batch)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  // Free vertex arrays memory from CPU (RAM)
+  for (int i = 0; i < batch.bufferCount; i++) {
+    RL_FREE(batch.vertexBuffer[i].vertices);
+    RL_FREE(batch.vertexBuffer[i].texcoords);
+    RL_FREE(batch.vertexBuffer[i].normals);
+    RL_FREE(batch.vertexBuffer[i].colors);
+  }
+
+  // Unload arrays
+  RL_FREE(batch.vertexBuffer);
+  RL_FREE(batch.draws);
+#endif
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   // Unbind everything
   pfBindBuffer(PF_ARRAY_BUFFER, 0);
@@ -3044,6 +3316,95 @@ rlUnloadRenderBatch(rlRenderBatch batch)
 void
 rlDrawRenderBatch(rlRenderBatch *batch)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  // Draw batch vertex arrays, one pfDrawArrays() by draw call
+  //------------------------------------------------------------------------------------------------------------
+  if (RLGL.State.vertexCounter > 0) {
+    rlVertexBuffer *buffer = &batch->vertexBuffer[batch->currentBuffer];
+
+    pfEnable(PF_VERTEX_ARRAY);
+    pfEnable(PF_TEXTURE_COORD_ARRAY);
+    pfEnable(PF_NORMAL_ARRAY);
+    pfEnable(PF_COLOR_ARRAY);
+
+    pfVertexPointer(3, PF_FLOAT, 0, buffer->vertices);
+    pfTexCoordPointer(PF_FLOAT, 0, buffer->texcoords);
+    pfNormalPointer(PF_FLOAT, 0, buffer->normals);
+    pfColorPointer(4, PF_UNSIGNED_BYTE, 0, buffer->colors);
+
+    for (int i = 0, vertexOffset = 0; i < batch->drawCounter; i++) {
+      rlDrawCall *draw = &batch->draws[i];
+
+      if (draw->vertexCount > 0) {
+        if (draw->textureId != 0) {
+          pfEnable(PF_TEXTURE_2D);
+          pfBindTexture(pfGetTexture(draw->textureId));
+        } else {
+          pfBindTexture(NULL);
+          pfDisable(PF_TEXTURE_2D);
+        }
+
+        switch (draw->mode) {
+        case RL_LINES:
+          pfDrawArrays(PF_LINES, vertexOffset, draw->vertexCount);
+          break;
+        case RL_TRIANGLES:
+          pfDrawArrays(PF_TRIANGLES, vertexOffset, draw->vertexCount);
+          break;
+        case RL_QUADS:
+          pfDrawArrays(PF_QUADS, vertexOffset, draw->vertexCount);
+          break;
+        default:
+          break;
+        }
+      }
+
+      vertexOffset += draw->vertexCount;
+    }
+
+    pfDisable(PF_VERTEX_ARRAY);
+    pfDisable(PF_TEXTURE_COORD_ARRAY);
+    pfDisable(PF_NORMAL_ARRAY);
+    pfDisable(PF_COLOR_ARRAY);
+
+    // NOTE: The pointers must not outlive the draw, a mesh drawn later
+    // would otherwise read the batch buffers for its missing attributes
+    pfVertexPointer(3, PF_FLOAT, 0, NULL);
+    pfTexCoordPointer(PF_FLOAT, 0, NULL);
+    pfNormalPointer(PF_FLOAT, 0, NULL);
+    pfColorPointer(4, PF_UNSIGNED_BYTE, 0, NULL);
+
+    // Restore the texture set for the next vertices
+    if (RLGL.State.currentTextureId != 0) {
+      pfEnable(PF_TEXTURE_2D);
+      pfBindTexture(pfGetTexture(RLGL.State.currentTextureId));
+    } else {
+      pfBindTexture(NULL);
+      pfDisable(PF_TEXTURE_2D);
+    }
+  }
+  //------------------------------------------------------------------------------------------------------------
+
+  // Reset batch buffers
+  //------------------------------------------------------------------------------------------------------------
+  RLGL.State.vertexCounter = 0;
+
+  for (int i = 0; i < batch->drawCounter; i++) {
+    batch->draws[i].mode = RL_QUADS;
+    batch->draws[i].vertexCount = 0;
+    batch->draws[i].textureId = 0;
+  }
+
+  batch->drawCounter = 1;
+
+  // Keep recording with the current texture
+  batch->draws[0].textureId = RLGL.State.currentTextureId;
+  //------------------------------------------------------------------------------------------------------------
+
+  // Change to next buffer in the list (in case of multi-buffering)
+  batch->currentBuffer++;
+  if (batch->currentBuffer >= batch->bufferCount) batch->currentBuffer = 0;
+#endif
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   // Update batch vertex buffers
   //------------------------------------------------------------------------------------------------------------
@@ -3255,7 +3616,7 @@ rlDrawRenderBatch(rlRenderBatch *batch)
 void
 rlSetRenderBatchActive(rlRenderBatch *batch)
 {
-#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+#if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   rlDrawRenderBatch(RLGL.currentBatch);
 
   if (batch != NULL) RLGL.currentBatch = batch;
@@ -3267,7 +3628,7 @@ rlSetRenderBatchActive(rlRenderBatch *batch)
 void
 rlDrawRenderBatchActive(void)
 {
-#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+#if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   rlDrawRenderBatch(RLGL.currentBatch);    // NOTE: Stereo rendering is checked inside
 #endif
 }
@@ -3279,7 +3640,7 @@ rlCheckRenderBatchLimit(int vCount)
 {
   bool overflow = false;
 
-#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+#if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
   if ((RLGL.State.vertexCounter + vCount) >=
       (RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].elementCount*4)) {
     overflow = true;
@@ -3314,13 +3675,32 @@ rlLoadTexture(const void *data, int width, int height, int format, int mipmapCou
   if (format != RL_PIXELFORMAT_UNCOMPRESSED_GRAYSCALE && format != RL_PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA)
     ImageFormat(&temp, RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
 
-  PFtexture *v = malloc(sizeof(PFtexture));
-  *v = pfGenTexture(temp.data, temp.width, temp.height, (PFpixelformat)temp.format);
-  id = pfStoreTexture(v);
-  // we don't unload shit, because pfGenTexture doesn't copy the data
+  // NOTE: Premultiplied before generating the mipmaps, so that they don't average the color of transparent texels
+  if (RL_PREMULTIPLIED_ALPHA) rlPremultiplyAlpha(temp.data, temp.width*temp.height, temp.format);
+
+  // NOTE: pfGenTexture() doesn't copy the data, the texture registry owns temp.data from now on
+  // and frees it in rlUnloadTexture()
+  PFtexture texture = pfGenTexture(temp.data, temp.width, temp.height, (PFpixelformat)temp.format);
+
+  // NOTE: Only the first level is copied (and converted), the other ones are generated again
+  if ((mipmapCount > 1) && !pfGenTextureMipmaps(&texture))
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: Failed to generate mipmaps");
+
+  if ((RL_TEXTURE_TILED_MIN_SIZE > 0) && (temp.width >= RL_TEXTURE_TILED_MIN_SIZE) && (temp.height >= RL_TEXTURE_TILED_MIN_SIZE))
+    pfSetTextureLayout(&texture, PF_LAYOUT_TILED);    // Stays linear if out of memory
 
-  TRACELOG(RL_LOG_INFO, "TEXTURE: [ID %d, PTR %p] Texture loaded successfully (%ix%i | %s)",
-           id, v, v->width, v->height, rlGetPixelFormatName(temp.format));
+  temp.data = texture.pixels;
+
+  id = pfStoreTexture(&texture);
+
+  if (id == 0) {
+    RL_FREE(temp.data);
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: Failed to load texture");
+    return 0;
+  }
+
+  TRACELOG(RL_LOG_INFO, "TEXTURE: [ID %d] Texture loaded successfully (%ix%i | %s)",
+           id, texture.width, texture.height, rlGetPixelFormatName(temp.format));
 
   return id;
 }
@@ -3450,6 +3830,42 @@ rlLoadTextureCubemap(const void *data, int size, int format)
 void
 rlUpdateTexture(unsigned int id, int offsetX, int offsetY, int width, int height, int format, const void *data)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  rlDrawRenderBatchActive(); // recorded draws may still sample the previous pixels
+
+  PFtexture *texture = pfGetTexture(id);
+
+  if ((texture == NULL) || (texture->pixels == NULL) || (format >= RL_PIXELFORMAT_COMPRESSED_DXT1_RGB)) {
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Failed to update for current texture format (%i)", id, format);
+    return;
+  }
+
+  if ((offsetX < 0) || (offsetY < 0) || (offsetX + width > texture->width) || (offsetY + height > texture->height)) {
+    TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Failed to update, rectangle out of texture bounds", id);
+    return;
+  }
+
+  pfFlush(); // triangles still binned may sample the old pixels
+
+  // NOTE: raylib and PixelForge pixel formats share the same values (see rlLoadTexture())
+  PFtexture src = pfGenTexture((void *)data, width, height, (PFpixelformat)format);
+
+  if ((src.format == texture->format) && (texture->layout == PF_LAYOUT_LINEAR)) {
+    int bpp = rlGetPixelDataSize(1, 1, format);
+    for (int y = 0; y < height; y++) {
+      unsigned char *row = (unsigned char *)texture->pixels + ((offsetY + y)*texture->width + offsetX)*bpp;
+      memcpy(row, (const unsigned char *)data + y*width*bpp, width*bpp);
+      if (RL_PREMULTIPLIED_ALPHA) rlPremultiplyAlpha(row, width, format);
+    }
+  } else {
+    for (int y = 0; y < height; y++)
+      for (int x = 0; x < width; x++) {
+        PFcolor color = src.pixelGetter(src.pixels, y*width + x);
+        if (RL_PREMULTIPLIED_ALPHA) color = pfBlendAlpha(color, (PFcolor){ 0 });   // Over transparent black: premultiplied color
+        pfSetTexturePixel(texture, offsetX + x, offsetY + y, color);
+      }
+  }
+#else
   pfBindTexture(pfGetTexture(id));
 
   unsigned int pfInternalFormat, pfFormat, pfType;
@@ -3458,6 +3874,7 @@ rlUpdateTexture(unsigned int id, int offsetX, int offsetY, int width, int height
   if ((pfInternalFormat != 0) && (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB)) {
     pfTexSubImage2D(PF_TEXTURE_2D, 0, offsetX, offsetY, width, height, pfFormat, pfType, data);
   } else TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Failed to update for current texture format (%i)", id, format);
+#endif
 }
 
 // Get OpenGL internal formats and data type from raylib PixelFormat
@@ -3701,7 +4118,12 @@ rlGetGlTextureFormats(int format, unsigned int *pfInternalFormat, unsigned int *
 void
 rlUnloadTexture(unsigned int id)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  rlDrawRenderBatchActive(); // recorded draws may still use the texture
+  pfReleaseTexture(id); // flushes binned triangles before freeing the pixels
+#else
   pfDeleteTextures(1, &id);
+#endif
 }
 
 // Generate mipmap data for selected texture
@@ -3730,6 +4152,17 @@ rlGenTextureMipmaps(unsigned int id, int width, int height, int format, int *mip
   } else TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Failed to generate mipmaps", id);
 
   pfBindTexture(PF_TEXTURE_2D, 0);
+#elif defined(GRAPHICS_API_OPENGL_11)
+  PFtexture *texture = pfGetTexture(id);
+
+  // NOTE: The batched and binned draws may still sample the texture
+  rlDrawRenderBatchActive();
+  pfFlush();
+
+  if ((texture != NULL) && pfGenTextureMipmaps(texture)) {
+    *mipmaps = (int)texture->mipmaps;
+    TRACELOG(RL_LOG_INFO, "TEXTURE: [ID %i] Mipmaps generated, total: %i", id, *mipmaps);
+  } else TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Failed to generate mipmaps", id);
 #else
   TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] GPU mipmap generation not supported", id);
 #endif
@@ -3741,7 +4174,27 @@ rlReadTexturePixels(unsigned int id, int width, int height, int format)
 {
   void *pixels = NULL;
 
-#if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33)
+#if defined(GRAPHICS_API_OPENGL_11)
+  PFtexture *texture = pfGetTexture(id);
+
+  if ((texture != NULL) && (texture->pixels != NULL) && (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB) &&
+      (width == texture->width) && (height == texture->height)) {
+    rlDrawRenderBatchActive();
+    pfFlush(); // the texture may be the target of pending draws
+
+    pixels = RL_MALLOC(rlGetPixelDataSize(width, height, format));
+
+    if (((PFpixelformat)format == texture->format) && (texture->layout == PF_LAYOUT_LINEAR))
+      memcpy(pixels, texture->pixels, rlGetPixelDataSize(width, height, format));
+    else {
+      PFtexture dst = pfGenTexture(pixels, width, height, (PFpixelformat)format);
+      for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++) dst.pixelSetter(dst.pixels, y*width + x, pfGetTexturePixel(texture, x, y));
+    }
+  } else TRACELOG(RL_LOG_WARNING, "TEXTURE: [ID %i] Data retrieval not suported for pixel format (%i)", id, format);
+#endif
+
+#if defined(GRAPHICS_API_OPENGL_33)
   pfBindTexture(pfGetTexture(id));
 
   // NOTE: Using texture id, we can retrieve some texture info (but not on OpenGL ES 2.0)
@@ -3802,8 +4255,24 @@ rlReadTexturePixels(unsigned int id, int width, int height, int format)
 unsigned char *
 rlReadScreenPixels(int width, int height)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  unsigned char *imgData = (unsigned char *)RL_CALLOC(width*height*4, sizeof(unsigned char));
+
+  rlDrawRenderBatchActive();
+
+  // NOTE: PixelForge framebuffers are stored top to bottom, no flip needed, and the rows are
+  // converted to RGBA at once (see pfConvertPixels())
+  pfReadPixels(0, 0, width, height, PF_PIXELFORMAT_R8G8B8A8, imgData);
+
+  // Set alpha component value to 255 (no trasparent image retrieval)
+  for (int i = 3; i < width*height*4; i += 4) imgData[i] = 255;
+
+  return imgData;     // NOTE: image data should be freed
+#else
   unsigned char *screenData = (unsigned char *)RL_CALLOC(width*height*4, sizeof(unsigned char));
 
+  rlDrawRenderBatchActive();
+
   // NOTE 1: pfReadPixels returns image flipped vertically -> (0,0) is the bottom left corner of the framebuffer
   // NOTE 2: We are getting alpha channel! Be careful, it can be transparent if not cleared properly!
   _pfReadPixels(0, 0, width, height, PF_RGBA, PF_UNSIGNED_BYTE, screenData);
@@ -3824,6 +4293,7 @@ rlReadScreenPixels(int width, int height)
   RL_FREE(screenData);
 
   return imgData;     // NOTE: image data should be freed
+#endif
 }
 
 // Framebuffer management (fbo)
@@ -4091,6 +4561,11 @@ rlDisableVertexAttribute(unsigned int index)
 void
 rlDrawVertexArray(int offset, int count)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+  // NOTE: Vertices without color array use the current color, only recorded by rlColor*()
+  rlDrawRenderBatchActive();
+  pfColor4ub(RLGL.State.colorr, RLGL.State.colorg, RLGL.State.colorb, RLGL.State.colora);
+#endif
   pfDrawArrays(PF_TRIANGLES, offset, count);
 }
 
@@ -4102,6 +4577,10 @@ rlDrawVertexArrayElements(int offset, int count, const void *buffer)
   unsigned short *bufferPtr = (unsigned short *)buffer;
   if (offset > 0) bufferPtr += offset;
 
+#if defined(GRAPHICS_API_OPENGL_11)
+  rlDrawRenderBatchActive();
+  pfColor4ub(RLGL.State.colorr, RLGL.State.colorg, RLGL.State.colorb, RLGL.State.colora);
+#endif
   pfDrawElements(PF_TRIANGLES, count, PF_UNSIGNED_SHORT, (const unsigned short *)bufferPtr);
 }
 
@@ -4132,8 +4611,13 @@ rlDrawVertexArrayElementsInstanced(int offset, int count, const void *buffer, in
 void
 rlEnableStatePointer(int vertexAttribType, void *buffer)
 {
-  pfEnable(vertexAttribType);
-  if (buffer != NULL) pfEnableClientState(vertexAttribType);
+  rlDrawRenderBatchActive();
+
+  // NOTE: A missing buffer (e.g. a mesh without colors) leaves the array disabled,
+  // the current color, normal or texcoord is used instead
+  if (buffer != NULL) pfEnable(vertexAttribType);
+  else pfDisable(vertexAttribType);
+
   switch (vertexAttribType) {
   case PF_VERTEX_ARRAY:
     pfVertexPointer(3, PF_FLOAT, 0, buffer);
@@ -4142,10 +4626,10 @@ rlEnableStatePointer(int vertexAttribType, void *buffer)
     pfTexCoordPointer(PF_FLOAT, 0, buffer);
     break;
   case PF_NORMAL_ARRAY:
-    if (buffer != NULL) pfNormalPointer(PF_FLOAT, 0, buffer);
+    pfNormalPointer(PF_FLOAT, 0, buffer);
     break;
   case PF_COLOR_ARRAY:
-    if (buffer != NULL) pfColorPointer(4, PF_UNSIGNED_BYTE, 0, buffer);
+    pfColorPointer(4, PF_UNSIGNED_BYTE, 0, buffer);
     break;
   //case PF_INDEX_ARRAY: if (buffer != NULL) pfIndexPointer(PF_SHORT, 0, buffer); break; // Indexed colors
   default:
@@ -4157,6 +4641,7 @@ rlEnableStatePointer(int vertexAttribType, void *buffer)
 void
 rlDisableStatePointer(int vertexAttribType)
 {
+  rlDrawRenderBatchActive();
   pfDisable(vertexAttribType);
 }
 #endif
@@ -5406,6 +5891,29 @@ rlGetPixelDataSize(int width, int height, int format)
   return dataSize;
 }
 
+#if defined(GRAPHICS_API_OPENGL_11)
+// Multiply the color of the pixels by their alpha, rounded
+// NOTE: Only the formats with 8 bit alpha are changed, the other ones are converted by rlLoadTexture()
+// or have no alpha (grayscale)
+static void
+rlPremultiplyAlpha(void *data, int count, int format)
+{
+  unsigned char *pixels = (unsigned char *)data;
+
+  if (format == RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+    for (int i = 0; i < count; i++, pixels += 4) {
+      unsigned int a = pixels[3];
+      if (a == 255) continue;
+      pixels[0] = (pixels[0]*a + 127)/255;
+      pixels[1] = (pixels[1]*a + 127)/255;
+      pixels[2] = (pixels[2]*a + 127)/255;
+    }
+  } else if (format == RL_PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA) {
+    for (int i = 0; i < count; i++, pixels += 2) pixels[0] = (pixels[0]*pixels[1] + 127)/255;
+  }
+}
+#endif
+
 // Auxiliar math functions
 
 // Get float array of matrix data
@@ -93,7 +93,9 @@
     #define M3D_FREE RL_FREE
 
     #define M3D_IMPLEMENTATION
-    #define __attribute__
+    #if !defined(__GNUC__)
+        #define __attribute__
+    #endif
     #include "external/m3d.h"           // Model3D file format loading
 #endif
 
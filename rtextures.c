@@ -1349,7 +1349,27 @@ void ImageFormat(Image *image, int newFormat)
 
     if ((newFormat != 0) && (image->format != newFormat))
     {
-        if ((image->format < PIXELFORMAT_COMPRESSED_DXT1_RGB) && (newFormat < PIXELFORMAT_COMPRESSED_DXT1_RGB))
+        if ((image->format <= PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) && (newFormat <= PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+        {
+            // Up to 8 bit per channel: converted row-wise by PixelForge (same pixel format values),
+            // without going through normalized floats
+            void *data = RL_MALLOC(GetPixelDataSize(image->width, image->height, newFormat));
+
+            pfConvertPixels(data, (PFpixelformat)newFormat, image->data, (PFpixelformat)image->format, image->width*image->height);
+
+            RL_FREE(image->data);      // WARNING! We loose mipmaps data --> Regenerated at the end...
+            image->data = data;
+            image->format = newFormat;
+
+            if (image->mipmaps > 1)
+            {
+                image->mipmaps = 1;
+            #if defined(SUPPORT_IMAGE_MANIPULATION)
+                ImageMipmaps(image);
+            #endif
+            }
+        }
+        else if ((image->format < PIXELFORMAT_COMPRESSED_DXT1_RGB) && (newFormat < PIXELFORMAT_COMPRESSED_DXT1_RGB))
         {
             Vector4 *pixels = LoadImageDataNormalized(*image);     // Supports 8 to 32 bit per channel
 
@@ -4009,6 +4029,12 @@ Texture2D LoadTextureFromImage(Image image)
 
     PFtexture *t = pfGetTexture(texture.id);
 
+    if (t == NULL)
+    {
+        TRACELOG(LOG_WARNING, "IMAGE: Failed to load texture");
+        return (Texture2D){ 0 };
+    }
+
     texture.width = t->width;
     texture.height = t->height;
     texture.mipmaps = image.mipmaps;
@@ -4339,17 +4365,13 @@ void SetTextureWrap(Texture2D texture, int wrap)
 // Draw a texture
 void DrawTexture(Texture2D texture, int posX, int posY, Color tint)
 {
-    //DrawTextureEx(texture, (Vector2){ (float)posX, (float)posY }, 0.0f, 1.0f, tint);
-    DrawTextureV(texture, (Vector2){ (float)posX, (float)posY }, tint);
+    DrawTextureEx(texture, (Vector2){ (float)posX, (float)posY }, 0.0f, 1.0f, tint);
 }
 
 // Draw a texture with position defined as Vector2
-void DrawTextureV(Texture2D texture, Vector2 pos, Color tint)
+void DrawTextureV(Texture2D texture, Vector2 position, Color tint)
 {
-    PFtexture *t = pfGetTexture(texture.id);
-
-    pfRasterPos2i((int)pos.x, (int)pos.y);
-    pfDrawPixels(t->width, t->height, t->format, t->pixels);
+    DrawTextureEx(texture, position, 0, 1.0f, tint);
 }
 
 // Draw a texture with extended parameters
@@ -0,0 +1,139 @@
+/*******************************************************************************************
+*
+*   binning - Texture state changed between the draws of a frame
+*
+*   Built with PF_SUPPORT_BINNED_RASTER and worker threads, the triangles are only
+*   rasterized when the bins are flushed. Each quad must still be drawn with the
+*   texture state it was submitted with, not the one set after it.
+*
+********************************************************************************************/
+
+#include "pixelforge.h"
+
+#include <stdio.h>
+
+#define SCREEN_WIDTH    256
+#define SCREEN_HEIGHT   64
+
+static unsigned char screen[SCREEN_WIDTH*SCREEN_HEIGHT*4];
+static int failures = 0;
+
+// Draw a textured quad over the columns [x, x + 32), with the U coordinate going from 0 to 'u'
+static void DrawQuad(int x, float u)
+{
+    pfBegin(PF_QUADS);
+        pfColor4ub(255, 255, 255, 255);
+        pfTexCoord2f(0, 0); pfVertex2f(x, 0);
+        pfTexCoord2f(0, 1); pfVertex2f(x, SCREEN_HEIGHT);
+        pfTexCoord2f(u, 1); pfVertex2f(x + 32, SCREEN_HEIGHT);
+        pfTexCoord2f(u, 0); pfVertex2f(x + 32, 0);
+    pfEnd();
+}
+
+// Texture owning a copy of the given RGBA8 texels
+static PFtexture GenTexture(int width, int height, const unsigned char *texels)
+{
+    PFtexture texture = pfGenTextureBuffer(width, height, PF_PIXELFORMAT_R8G8B8A8);
+
+    for (int i = 0; i < width*height; i++)
+    {
+        const unsigned char *t = texels + i*4;
+        pfSetTexturePixel(&texture, i%width, i/width, (PFcolor){ t[0], t[1], t[2], t[3] });
+    }
+
+    return texture;
+}
+
+static void Expect(const char *name, int x, int r, int g, int b)
+{
+    const unsigned char *p = screen + (SCREEN_HEIGHT/2*SCREEN_WIDTH + x)*4;
+
+    if ((p[0] < r - 8) || (p[0] > r + 8) || (p[1] < g - 8) || (p[1] > g + 8) || (p[2] < b - 8) || (p[2] > b + 8))
+    {
+        printf("FAIL: %s: pixel %i is (%i, %i, %i), expected (%i, %i, %i)\n", name, x, p[0], p[1], p[2], r, g, b);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    PFcontext ctx = pfCreateContext(screen, SCREEN_WIDTH, SCREEN_HEIGHT, PF_PIXELFORMAT_R8G8B8A8);
+    pfMakeCurrent(ctx);
+
+    pfMatrixMode(PF_PROJECTION);
+    pfLoadIdentity();
+    pfOrtho(0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 1);
+    pfMatrixMode(PF_MODELVIEW);
+    pfLoadIdentity();
+
+    pfClear(PF_COLOR_BUFFER_BIT | PF_DEPTH_BUFFER_BIT);
+    pfDisable(PF_DEPTH_TEST);
+    pfEnable(PF_TEXTURE_2D);
+
+    // Texels written after a draw
+    unsigned char red[2*2*4] = {
+        255, 0, 0, 255,  255, 0, 0, 255,
+        255, 0, 0, 255,  255, 0, 0, 255
+    };
+
+    PFtexture texels = GenTexture(2, 2, red);
+    pfBindTexture(&texels);
+    DrawQuad(0, 1.0f);
+
+    for (int i = 0; i < 4; i++) pfSetTexturePixel(&texels, i%2, i/2, (PFcolor){ 0, 255, 0, 255 });
+    DrawQuad(32, 1.0f);
+
+    // Wrap mode changed after a draw, the U coordinate goes up to 2
+    unsigned char redBlue[2*1*4] = { 255, 0, 0, 255,  0, 0, 255, 255 };
+
+    PFtexture wrap = GenTexture(2, 1, redBlue);
+    pfBindTexture(&wrap);
+    pfSetTextureWrap(&wrap, PF_WRAP_REPEAT, PF_WRAP_REPEAT);
+    DrawQuad(64, 2.0f);
+
+    pfSetTextureWrap(&wrap, PF_WRAP_CLAMP_TO_EDGE, PF_WRAP_CLAMP_TO_EDGE);
+    DrawQuad(96, 2.0f);
+
+    // Filter changed after a draw, the two texels are magnified 16 times
+    unsigned char blackWhite[2*1*4] = { 0, 0, 0, 255,  255, 255, 255, 255 };
+
+    PFtexture filter = GenTexture(2, 1, blackWhite);
+    pfBindTexture(&filter);
+    pfSetTextureFilter(&filter, PF_FILTER_NEAREST, PF_FILTER_NEAREST);
+    DrawQuad(128, 1.0f);
+
+    pfSetTextureFilter(&filter, PF_FILTER_NEAREST, PF_FILTER_LINEAR);
+    DrawQuad(160, 1.0f);
+
+    // Layout changed after a draw, the pixels of the texture are moved
+    PFtexture layout = GenTexture(2, 1, redBlue);
+    pfBindTexture(&layout);
+    DrawQuad(192, 1.0f);
+
+    pfSetTextureLayout(&layout, PF_LAYOUT_TILED);
+    DrawQuad(224, 1.0f);
+
+    pfBindTexture(NULL);
+    pfFlush();
+
+    Expect("texels before pfSetTexturePixel", 16, 255, 0, 0);
+    Expect("texels after pfSetTexturePixel", 48, 0, 255, 0);
+    Expect("wrap before pfSetTextureWrap", 64 + 20, 255, 0, 0);
+    Expect("wrap after pfSetTextureWrap", 96 + 20, 0, 0, 255);
+    Expect("filter before pfSetTextureFilter", 128 + 12, 0, 0, 0);
+    Expect("filter after pfSetTextureFilter", 160 + 12, 71, 71, 71);
+    Expect("layout before pfSetTextureLayout", 192 + 8, 255, 0, 0);
+    Expect("layout before pfSetTextureLayout", 192 + 24, 0, 0, 255);
+    Expect("layout after pfSetTextureLayout", 224 + 8, 255, 0, 0);
+    Expect("layout after pfSetTextureLayout", 224 + 24, 0, 0, 255);
+
+    pfDeleteTexture(&layout);
+    pfDeleteTexture(&filter);
+    pfDeleteTexture(&wrap);
+    pfDeleteTexture(&texels);
+    pfDeleteContext(ctx);
+
+    printf("binning: %s\n", (failures > 0) ? "FAIL" : "passed");
+
+    return (failures > 0);
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************************
+*
+*   lines - Lines across and along the edges of the viewport
+*
+*   Each line is drawn alone on a 64x48 screen, then the lit pixels are counted.
+*   Lines that leave the screen are clipped to it, they must keep the pixels
+*   of their visible part.
+*
+********************************************************************************************/
+
+#include "raylib.h"
+
+#include <stdio.h>
+
+#define SCREEN_WIDTH    64
+#define SCREEN_HEIGHT   48
+
+typedef struct {
+    Vector2 start, end;
+    int minCount, maxCount;     // Expected number of lit pixels
+} LineTest;
+
+static int CountLinePixels(Vector2 start, Vector2 end)
+{
+    BeginDrawing();
+        ClearBackground(BLACK);
+        DrawLineV(start, end, WHITE);
+    EndDrawing();
+
+    const unsigned char *pixels = GetHeadlessFramebuffer();
+    int count = 0;
+
+    for (int i = 0; i < SCREEN_WIDTH*SCREEN_HEIGHT; i++) if (pixels[i*4] != 0) count++;
+
+    return count;
+}
+
+int main(void)
+{
+    const LineTest tests[] = {
+        { {   0,   0 }, {  63,  47 }, 47, 64 },     // Corner to corner
+        { {  10,   0 }, {  10,  47 }, 47, 48 },     // Along the height
+        { {   0,  10 }, {  63,  10 }, 63, 64 },     // Along the width
+        { {   0,   0 }, {  63,   0 }, 63, 64 },     // Along the top edge
+        { {   0,  47 }, {  63,  47 }, 63, 64 },     // Along the bottom edge
+        { {   0,   0 }, {   0,  47 }, 47, 48 },     // Along the left edge
+        { {  63,   0 }, {  63,  47 }, 47, 48 },     // Along the right edge
+        { { -10, -10 }, {  30,  30 }, 29, 31 },     // From above the top left corner
+        { {  30,  30 }, { -10, -10 }, 29, 31 },     // Same line, reversed
+        { {  10, -20 }, {  10,  70 }, 47, 48 },     // Across the top and bottom edges
+        { { -20,  10 }, { 100,  10 }, 63, 64 },     // Across the left and right edges
+        { {  20,  60 }, {  60,  20 }, 26, 29 },     // From below the bottom edge
+        { { -10,  60 }, {  80, -30 }, 47, 49 },     // Across all the edges
+        { { -10,  -5 }, {  80,  -5 },  0,  0 },     // Above the screen
+        { { -10,  60 }, {  80,  60 },  0,  0 },     // Below the screen
+    };
+
+    const int testCount = sizeof(tests)/sizeof(tests[0]);
+    int failures = 0;
+
+    SetTraceLogLevel(LOG_NONE);
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "lines");
+
+    for (int i = 0; i < testCount; i++)
+    {
+        int count = CountLinePixels(tests[i].start, tests[i].end);
+
+        if ((count < tests[i].minCount) || (count > tests[i].maxCount))
+        {
+            printf("FAIL: (%g, %g) -> (%g, %g): %i pixels, expected %i to %i\n",
+                tests[i].start.x, tests[i].start.y, tests[i].end.x, tests[i].end.y,
+                count, tests[i].minCount, tests[i].maxCount);
+            failures++;
+        }
+    }
+
+    CloseWindow();
+
+    printf("lines: %i/%i passed\n", testCount - failures, testCount);
+
+    return (failures > 0);
+}